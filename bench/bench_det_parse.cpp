@@ -0,0 +1,129 @@
+// det_parse + overlay sobre el corpus de bench/corpus: mensajes de 0 a 50 cajas
+// en coordenadas normalizadas (norm_*), en píxeles del uplink (px_*), en
+// xmin/ymin/xmax/ymax de otro espacio (xmin_*) y binarios det_proto (bin_*).
+// Por mensaje: ns de det_parse_json/binary, reservas del heap y bytes que se
+// dibujan (overlay por bandas vs ruta antigua drawRect + print).
+//   bench_det_parse [directorio del corpus]   (CAMARA_BENCH_S: segundos por mensaje)
+#include "det_parse.h"
+#include "det_proto.h"
+#include "overlay.h"
+#include "frame_views.h"
+#include "latency_stats.h"
+#include "uplink_window.h"
+#include "app_config.h"
+#include "host.h"
+#include "det_corpus.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#ifdef CAMARA_ARDUINOJSON_FALLBACK
+#error "bench_det_parse mide la ArduinoJson real: -DARDUINOJSON_DIR=<checkout>/src o con red al configurar"
+#endif
+
+#define BAND_ROWS 20            // como ws_draw.cpp
+
+// ============ Sustitutos de ws_draw / app_config ============
+static Deteccion gDets[WS_DRAW_MAX_DET];
+static int gCount = -1;         // -1: no se publicó nada
+
+void ws_draw_update_detecciones_at(Deteccion* detecciones, int count, int64_t) {
+    gCount = count;
+    if (count > 0) memcpy(gDets, detecciones, sizeof(Deteccion) * count);
+}
+
+void deteccion_set_label(Deteccion &d, const char* label) {
+    if (!label) label = "";
+    strncpy(d.label, label, DET_LABEL_LEN - 1);
+    d.label[DET_LABEL_LEN - 1] = '\0';
+}
+
+bool app_config_command(JsonObjectConst root) { return root.containsKey("cmd"); }
+
+static bool parse(const det_message_t &m) {
+    return m.binary ? det_parse_binary(m.data.data(), m.data.size())
+                    : det_parse_json(m.data.data(), m.data.size());
+}
+
+// ============ Medida ============
+// Overlay por bandas sobre un frame de fondo: píxeles que cambian (se envían
+// igualmente con la banda, no añaden bytes al bus)
+static uint32_t overlay_band_pixels(const Deteccion* dets, int n, uint64_t* ns) {
+    static uint16_t band[WS_DRAW_W * BAND_ROWS];
+    uint32_t px = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int y = 0; y < WS_DRAW_H; y += BAND_ROWS) {
+        int rows = std::min(BAND_ROWS, WS_DRAW_H - y);
+        memset(band, 0, sizeof(band));
+        overlay_draw_band(band, WS_DRAW_W, WS_DRAW_H, y, rows, dets, n, 0xF800);
+        for (int i = 0; i < WS_DRAW_W * rows; i++) px += band[i] != 0;
+    }
+    *ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    return px;
+}
+
+static void run(const det_message_t &m, double ms) {
+    // Comprobación: acepta el mensaje y publica min(cajas, WS_DRAW_MAX_DET)
+    gCount = -1;
+    bool ok = parse(m);
+    CHECK(ok);
+    CHECK(gCount == std::min(m.boxes, (int)WS_DRAW_MAX_DET));
+    for (int i = 0; i < gCount; i++) {
+        const Deteccion &d = gDets[i];
+        CHECK(d.x >= 0 && d.y >= 0 && d.w >= 1 && d.h >= 1 && d.x + d.w <= WS_DRAW_W && d.y + d.h <= WS_DRAW_H);
+    }
+    Deteccion dets[WS_DRAW_MAX_DET];
+    int n = std::max(gCount, 0);
+    memcpy(dets, gDets, sizeof(Deteccion) * n);
+
+    // Tiempo y reservas por mensaje
+    uint32_t reps = 0;
+    host_alloc_stats_t a0, a1;
+    host_alloc_get(&a0);
+    auto t0 = std::chrono::steady_clock::now();
+    auto deadline = t0 + std::chrono::microseconds((int64_t)(ms * 1000));
+    auto t1 = t0;
+    do {
+        for (int i = 0; i < 64; i++) parse(m);
+        reps += 64;
+        t1 = std::chrono::steady_clock::now();
+    } while (t1 < deadline);
+    host_alloc_get(&a1);
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)reps;
+    double allocs = (double)(a1.count - a0.count) / reps;
+    CHECK(a1.count == a0.count);            // sin heap por mensaje
+
+    uint64_t overlayNs = 0;
+    uint32_t bandPx = overlay_band_pixels(dets, n, &overlayNs);
+    uint32_t legacyPx = overlay_legacy_pixels(dets, n, WS_DRAW_W, WS_DRAW_H);
+
+    printf("%-8s %5u B %3d cajas -> %2d | %7.0f ns/msg %4.1f reservas/msg | overlay %6u B en banda (%5.1f us), antigua +%6u B al bus\n",
+           m.name.c_str(), (unsigned)m.data.size(), m.boxes, n, ns, allocs,
+           (unsigned)bandPx * 2, overlayNs / 1000.0, (unsigned)legacyPx * 2);
+}
+
+int main(int argc, char** argv) {
+    const char* dir = argc > 1 ? argv[1] : BENCH_CORPUS_DIR;
+    std::vector<det_message_t> corpus = det_corpus_load(dir);
+    CHECK(!corpus.empty());
+
+    latency_init();
+    uplink_window_init(UPLINK_WINDOW_DEFAULT);
+    frame_views_set_capture(480, 480);      // uplink de 480: espacio de px_*
+    double ms = host_env_seconds("CAMARA_BENCH_S", 0.02) * 1000;
+
+    printf("det_parse sobre %u mensajes de %s (%.0f ms cada uno)\n", (unsigned)corpus.size(), dir, ms);
+    for (const det_message_t &m : corpus) run(m, ms);
+
+    // JSON inválido: no publica nada
+    static const char bad[] = "{\"detections\":[{\"x\":1,";
+    gCount = -1;
+    CHECK(!det_parse_json((const uint8_t*)bad, sizeof(bad) - 1));
+    CHECK(gCount == -1);
+
+    // Formato no reconocido: limpia overlays pero no cuenta como respuesta
+    static const char scalar[] = "42";
+    CHECK(!det_parse_json((const uint8_t*)scalar, sizeof(scalar) - 1));
+    return host_test_result();
+}
@@ -0,0 +1,314 @@
+#include "app_config.h"
+#include "camera.h"
+#include "frame_pool.h"
+#include "frame_views.h"
+#include "jpeg_encoder.h"
+#include "rate_ctrl.h"
+#include "roi_uplink.h"
+#include "motion_gate.h"
+#include "uplink_window.h"
+#include "app_log.h"
+#include <Preferences.h>
+
+// ============ Estado ============
+static portMUX_TYPE cfgMux = portMUX_INITIALIZER_UNLOCKED;
+
+static app_config_t gCfg;
+static bool gCameraPending = false;
+static bool gServerPending = false;
+static bool gReboot = false;
+static bool gSavePending = false;   // "save" a la espera del cambio de cámara
+
+static char gReply[APP_CFG_REPLY_LEN];
+static bool gReplyReady = false;
+
+struct framesize_name_t { const char* name; framesize_t size; };
+static const framesize_name_t kFrameSizes[] = {
+    { "QVGA",    FRAMESIZE_QVGA },
+    { "240X240", FRAMESIZE_240X240 },
+    { "HVGA",    FRAMESIZE_HVGA },
+    { "VGA",     FRAMESIZE_VGA },
+    { "SVGA",    FRAMESIZE_SVGA },
+};
+
+static const char* framesize_name(uint8_t fs) {
+    for (const framesize_name_t &f : kFrameSizes) {
+        if (f.size == fs) return f.name;
+    }
+    return "?";
+}
+
+static bool framesize_parse(const char* name, uint8_t* out) {
+    for (const framesize_name_t &f : kFrameSizes) {
+        if (strcasecmp(f.name, name) == 0) { *out = f.size; return true; }
+    }
+    return false;
+}
+
+static void copy_str(char* dst, size_t len, const char* src) {
+    size_t n = strnlen(src, len - 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+static void copy_camera(app_config_t &dst, const app_config_t &src) {
+    dst.framesize = src.framesize;
+    dst.pixformat = src.pixformat;
+    dst.fb_count = src.fb_count;
+    dst.xclk_hz = src.xclk_hz;
+}
+
+static void set_defaults(app_config_t &c) {
+    memset(&c, 0, sizeof(c));
+    c.version = APP_CFG_VERSION;
+    copy_str(c.ssid, sizeof(c.ssid), APP_CFG_SSID);
+    copy_str(c.pass, sizeof(c.pass), APP_CFG_PASS);
+    copy_str(c.host, sizeof(c.host), APP_CFG_HOST);
+    copy_str(c.path, sizeof(c.path), APP_CFG_PATH);
+    c.port = APP_CFG_PORT;
+    c.ssl = 1;
+    c.framesize = CAMERA_FRAMESIZE;
+    c.pixformat = PIXFORMAT_RGB565;
+    c.fb_count = FRAME_POOL_SLOTS;
+    c.xclk_hz = APP_CFG_XCLK_HZ;
+    c.max_fps = 0;
+    c.jpeg = 1;
+    c.jpeg_quality = JPEG_QUALITY_DEFAULT;
+    c.uplink_shift = VIEW_UPLINK_SHIFT_DEFAULT;
+    c.roi = 0;
+    c.motion = 1;
+    c.window = UPLINK_WINDOW_DEFAULT;
+}
+
+// ============ API ============
+void app_config_load() {
+    app_config_t c;
+    Preferences prefs;
+    bool ok = prefs.begin("camara", true) &&
+              prefs.getBytesLength("cfg") == sizeof(c) &&
+              prefs.getBytes("cfg", &c, sizeof(c)) == sizeof(c) &&
+              c.version == APP_CFG_VERSION;
+    prefs.end();
+    if (!ok) set_defaults(c);
+
+    portENTER_CRITICAL(&cfgMux);
+    gCfg = c;
+    portEXIT_CRITICAL(&cfgMux);
+    LOG_I("CFG", "%s: %s %s, host %s", ok ? "NVS" : "por defecto",
+          framesize_name(c.framesize), c.pixformat == PIXFORMAT_JPEG ? "jpeg" : "rgb565", c.host);
+}
+
+bool app_config_save() {
+    app_config_t c;
+    app_config_get(&c);
+    Preferences prefs;
+    if (!prefs.begin("camara", false)) return false;
+    bool ok = prefs.putBytes("cfg", &c, sizeof(c)) == sizeof(c);
+    prefs.end();
+    return ok;
+}
+
+void app_config_get(app_config_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&cfgMux);
+    *out = gCfg;
+    portEXIT_CRITICAL(&cfgMux);
+}
+
+void app_config_apply_runtime() {
+    app_config_t c;
+    app_config_get(&c);
+    rate_ctrl_set_max_fps(c.max_fps);
+    jpeg_encoder_set_enabled(c.jpeg);
+    jpeg_encoder_set_quality(c.jpeg_quality);
+    rate_ctrl_set_uplink_shift(c.uplink_shift);     // suelo; el lazo puede reducir más
+    roi_uplink_set_enabled(c.roi);
+    motion_gate_set_enabled(c.motion);
+    uplink_window_set_size(c.window);
+}
+
+static void reply_current(const app_config_t &c) {
+    char buf[APP_CFG_REPLY_LEN];
+    snprintf(buf, sizeof(buf),
+             "{\"cfg\":{\"framesize\":\"%s\",\"pixformat\":\"%s\",\"fb_count\":%u,\"xclk\":%u,"
+             "\"fps\":%u,\"jpeg\":%u,\"quality\":%u,\"uplink_shift\":%u,\"roi\":%u,\"motion\":%u,\"window\":%u,"
+             "\"host\":\"%s\",\"port\":%u,\"ssid\":\"%s\"}}",
+             framesize_name(c.framesize), c.pixformat == PIXFORMAT_JPEG ? "jpeg" : "rgb565",
+             c.fb_count, (unsigned)c.xclk_hz, c.max_fps, c.jpeg, c.jpeg_quality,
+             c.uplink_shift, c.roi, c.motion, c.window, c.host, c.port, c.ssid);
+    app_config_reply(buf);
+}
+
+static void reply_error(const char* what) {
+    char buf[APP_CFG_REPLY_LEN];
+    snprintf(buf, sizeof(buf), "{\"cfg\":{\"ok\":false,\"error\":\"%s\"}}", what);
+    app_config_reply(buf);
+}
+
+// Lee los campos presentes sobre una copia de la actual; lo ausente no cambia
+static bool parse_config(JsonObjectConst root, app_config_t &c) {
+    const char* fs = root["framesize"] | (const char*)nullptr;
+    if (fs && !framesize_parse(fs, &c.framesize)) { reply_error("framesize"); return false; }
+
+    const char* pf = root["pixformat"] | (const char*)nullptr;
+    if (pf) {
+        if (strcasecmp(pf, "rgb565") == 0)    c.pixformat = PIXFORMAT_RGB565;
+        else if (strcasecmp(pf, "jpeg") == 0) c.pixformat = PIXFORMAT_JPEG;
+        else { reply_error("pixformat"); return false; }
+    }
+
+    int fb = root["fb_count"] | (int)c.fb_count;
+    c.fb_count = (uint8_t)(fb < 1 ? 1 : (fb > FRAME_POOL_SLOTS ? FRAME_POOL_SLOTS : fb));
+    unsigned xclk = root["xclk"] | (unsigned)c.xclk_hz;
+    if (xclk < 8000000 || xclk > 24000000) { reply_error("xclk"); return false; }
+    c.xclk_hz = xclk;
+
+    int fps = root["fps"] | (int)c.max_fps;
+    c.max_fps = (uint8_t)(fps < 0 ? 0 : (fps > 60 ? 60 : fps));
+    c.jpeg = (root["jpeg"] | (bool)c.jpeg) ? 1 : 0;
+    int q = root["quality"] | (int)c.jpeg_quality;
+    c.jpeg_quality = (uint8_t)(q < JPEG_QUALITY_MIN ? JPEG_QUALITY_MIN : (q > JPEG_QUALITY_MAX ? JPEG_QUALITY_MAX : q));
+    int us = root["uplink_shift"] | (int)c.uplink_shift;
+    c.uplink_shift = (uint8_t)(us < 0 ? 0 : (us > VIEW_MAX_SHIFT ? VIEW_MAX_SHIFT : us));
+    c.roi = (root["roi"] | (bool)c.roi) ? 1 : 0;
+    c.motion = (root["motion"] | (bool)c.motion) ? 1 : 0;
+    int win = root["window"] | (int)c.window;
+    c.window = (uint8_t)(win < 1 ? 1 : (win > UPLINK_WINDOW_MAX ? UPLINK_WINDOW_MAX : win));
+
+    const char* s;
+    if ((s = root["host"] | (const char*)nullptr)) copy_str(c.host, sizeof(c.host), s);
+    if ((s = root["path"] | (const char*)nullptr)) copy_str(c.path, sizeof(c.path), s);
+    if ((s = root["ssid"] | (const char*)nullptr)) copy_str(c.ssid, sizeof(c.ssid), s);
+    if ((s = root["pass"] | (const char*)nullptr)) copy_str(c.pass, sizeof(c.pass), s);
+    int port = root["port"] | (int)c.port;
+    if (port > 0 && port < 65536) c.port = (uint16_t)port;
+    c.ssl = (root["ssl"] | (bool)c.ssl) ? 1 : 0;
+    return true;
+}
+
+bool app_config_command(JsonObjectConst root) {
+    const char* cmd = root["cmd"] | (const char*)nullptr;
+    if (!cmd) return false;
+
+    app_config_t cur, c;
+    app_config_get(&cur);
+
+    if (strcmp(cmd, "get") == 0) {
+        reply_current(cur);
+        return true;
+    }
+    if (strcmp(cmd, "reboot") == 0) {
+        app_config_reply("{\"cfg\":{\"ok\":true,\"reboot\":true}}");
+        portENTER_CRITICAL(&cfgMux);
+        gReboot = true;
+        portEXIT_CRITICAL(&cfgMux);
+        return true;
+    }
+    if (strcmp(cmd, "config") != 0) {
+        reply_error("cmd");
+        return true;
+    }
+
+    c = cur;
+    if (!parse_config(root, c)) return true;
+
+    bool camera = c.framesize != cur.framesize || c.pixformat != cur.pixformat ||
+                  c.fb_count != cur.fb_count || c.xclk_hz != cur.xclk_hz;
+    bool server = strcmp(c.host, cur.host) != 0 || strcmp(c.path, cur.path) != 0 ||
+                  c.port != cur.port || c.ssl != cur.ssl;
+    bool wifi = strcmp(c.ssid, cur.ssid) != 0 || strcmp(c.pass, cur.pass) != 0;
+    bool save = root["save"] | false;
+
+    uint32_t t0 = micros();
+    portENTER_CRITICAL(&cfgMux);
+    gCfg = c;
+    if (camera) {
+        gCameraPending = true;
+        gSavePending = save;    // se guarda si el driver arranca (app_config_camera_applied)
+    }
+    if (server) gServerPending = true;
+    portEXIT_CRITICAL(&cfgMux);
+    app_config_apply_runtime();
+    uint32_t runtimeUs = micros() - t0;
+
+    bool saved = save && !camera && app_config_save();
+
+    char buf[APP_CFG_REPLY_LEN];
+    snprintf(buf, sizeof(buf),
+             "{\"cfg\":{\"ok\":true,\"runtime_us\":%u,\"camera\":%s,\"server\":%s,\"reboot_needed\":%s,\"saved\":%s}}",
+             (unsigned)runtimeUs, camera ? "\"pendiente\"" : "false", server ? "\"reconecta\"" : "false",
+             wifi ? "true" : "false", save && camera ? "\"pendiente\"" : (saved ? "true" : "false"));
+    app_config_reply(buf);
+    LOG_I("CFG", "cambio: runtime %u us%s%s%s", (unsigned)runtimeUs,
+          camera ? ", cámara" : "", server ? ", servidor" : "", wifi ? ", wifi (reinicio)" : "");
+    return true;
+}
+
+bool app_config_take_camera_change(app_config_t* out) {
+    portENTER_CRITICAL(&cfgMux);
+    bool pending = gCameraPending;
+    gCameraPending = false;
+    if (pending && out) *out = gCfg;
+    portEXIT_CRITICAL(&cfgMux);
+    return pending;
+}
+
+bool app_config_camera_applied(const app_config_t &running, bool ok) {
+    portENTER_CRITICAL(&cfgMux);
+    bool newer = gCameraPending;        // otro cambio ya en cola: decide ese
+    bool save = !newer && ok && gSavePending;
+    if (!newer) {
+        gSavePending = false;
+        if (!ok) copy_camera(gCfg, running);
+    }
+    portEXIT_CRITICAL(&cfgMux);
+    if (!ok && !newer) {
+        LOG_W("CFG", "cámara: vuelvo a %s %s, fb_count %u", framesize_name(running.framesize),
+              running.pixformat == PIXFORMAT_JPEG ? "jpeg" : "rgb565", running.fb_count);
+    }
+    return save && app_config_save();
+}
+
+void app_config_camera_defaults(app_config_t* c) {
+    if (!c) return;
+    app_config_t d;
+    set_defaults(d);
+    copy_camera(*c, d);
+}
+
+bool app_config_take_server_change(app_config_t* out) {
+    portENTER_CRITICAL(&cfgMux);
+    bool pending = gServerPending;
+    gServerPending = false;
+    if (pending && out) *out = gCfg;
+    portEXIT_CRITICAL(&cfgMux);
+    return pending;
+}
+
+bool app_config_reboot_pending() {
+    portENTER_CRITICAL(&cfgMux);
+    bool r = gReboot;
+    portEXIT_CRITICAL(&cfgMux);
+    return r;
+}
+
+// Un hueco: una respuesta nueva sustituye a la no enviada
+void app_config_reply(const char* json) {
+    if (!json) return;
+    portENTER_CRITICAL(&cfgMux);
+    copy_str(gReply, sizeof(gReply), json);
+    gReplyReady = true;
+    portEXIT_CRITICAL(&cfgMux);
+}
+
+bool app_config_take_reply(char* buf, size_t len) {
+    if (!buf || !len) return false;
+    portENTER_CRITICAL(&cfgMux);
+    bool ready = gReplyReady;
+    if (ready) {
+        copy_str(buf, len, gReply);
+        gReplyReady = false;
+    }
+    portEXIT_CRITICAL(&cfgMux);
+    return ready;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Configuración en ejecución, persistida en NVS (Preferences, espacio "camara").
+// Se cambia por el socket con {"cmd":"config", ...} sin reflashear:
+//   - Uplink/captura (fps, jpeg, calidad, uplink_shift, roi, motion, window): al momento
+//   - Cámara (framesize, pixformat, xclk, fb_count): la tarea de cámara reinicia el driver
+//   - Servidor (host, port, path, ssl): la tarea de red reconecta
+//   - WiFi (ssid, pass): se guarda; se aplica al reiniciar ({"cmd":"reboot"})
+// "save": true lo guarda en NVS para el siguiente arranque; con cambio de cámara, solo
+// cuando el driver arranca con ella. {"cmd":"get"} devuelve la actual.
+// Respuestas por el socket como texto {"cfg":{...}}, con tiempos de cada cambio.
+#define APP_CFG_VERSION     2
+#define APP_CFG_REPLY_LEN   320
+
+// Valores por defecto (primer arranque o NVS de otra versión)
+#define APP_CFG_SSID        "DIGIFIBRA-2hK2"
+#define APP_CFG_PASS        "fEdfD236996S"
+#define APP_CFG_HOST        "3b6bec75bba4.ngrok-free.app"
+#define APP_CFG_PORT        443
+#define APP_CFG_PATH        "/ws"
+#define APP_CFG_XCLK_HZ     20000000
+
+struct app_config_t {
+    uint16_t version;
+    // Red
+    char ssid[33];
+    char pass[65];
+    char host[64];
+    char path[32];
+    uint16_t port;
+    uint8_t ssl;
+    // Cámara (cambio = reinicio del driver)
+    uint8_t framesize;      // framesize_t
+    uint8_t pixformat;      // PIXFORMAT_RGB565 o PIXFORMAT_JPEG (JPEG del sensor: sin panel)
+    uint8_t fb_count;       // 1..FRAME_POOL_SLOTS
+    uint32_t xclk_hz;
+    // Captura / uplink (al momento)
+    uint8_t max_fps;        // tope de fps sobre rate_ctrl (0 = sin tope)
+    uint8_t jpeg;           // JPEG por software del RGB565 (jpeg_encoder)
+    uint8_t jpeg_quality;
+    uint8_t uplink_shift;   // frame_views_set_uplink_shift
+    uint8_t roi;
+    uint8_t motion;
+    uint8_t window;         // frames sin confirmar (uplink_window.h)
+};
+
+// Carga NVS (o valores por defecto). Llamar al principio de setup().
+void app_config_load();
+bool app_config_save();
+void app_config_get(app_config_t* out);
+
+// Aplica los ajustes de uplink/captura a sus módulos (tras inicializarlos)
+void app_config_apply_runtime();
+
+// Comando del servidor (tarea de red). Devuelve false si no es {"cmd":...}.
+bool app_config_command(JsonObjectConst root);
+
+// Tarea de cámara: ¿hay que reiniciar el driver? Copia la configuración nueva.
+bool app_config_take_camera_change(app_config_t* out);
+
+// Tarea de cámara: configuración con la que quedó el driver tras el cambio (o el
+// arranque). Si falló, esos campos vuelven a la actual; si funcionó y se pidió
+// "save", se guarda ahora. Devuelve true si se guardó.
+bool app_config_camera_applied(const app_config_t &running, bool ok);
+
+// Campos de cámara por defecto (los compilados) sobre *c
+void app_config_camera_defaults(app_config_t* c);
+
+// Tarea de red: ¿hay que reconectar a otro servidor?
+bool app_config_take_server_change(app_config_t* out);
+
+// ¿Reinicio pedido por el servidor? (tarea de red, tras enviar la respuesta)
+bool app_config_reboot_pending();
+
+// Respuestas pendientes para el servidor (las envía la tarea de red)
+void app_config_reply(const char* json);
+bool app_config_take_reply(char* buf, size_t len);
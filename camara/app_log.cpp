@@ -0,0 +1,90 @@
+#include "app_log.h"
+#include "task_config.h"
+#include <atomic>
+#include <stdarg.h>
+
+#define APP_LOG_DRAIN_MS 20
+
+static_assert((APP_LOG_SLOTS & (APP_LOG_SLOTS - 1)) == 0, "APP_LOG_SLOTS debe ser potencia de 2");
+
+// Cola acotada multi-productor / un consumidor sin locks (esquema de Vyukov):
+// cada slot lleva un número de secuencia que dice si está libre o listo para leer.
+// Se guarda relativo al índice del slot para que el estado inicial sea todo ceros
+// (válido sin inicializar, incluso antes de app_log_init()).
+struct log_slot_t {
+    std::atomic<uint32_t> seq;      // secuencia - índice del slot
+    uint8_t level;
+    const char* tag;
+    uint32_t ms;
+    char text[APP_LOG_MSG_LEN];
+};
+
+static log_slot_t gSlots[APP_LOG_SLOTS];
+static std::atomic<uint32_t> gHead(0);     // próxima posición a reservar (productores)
+static uint32_t gTail = 0;                 // próxima a leer (solo la tarea de drenado)
+static std::atomic<uint32_t> gDropped(0);
+static TaskHandle_t gDrainTask = nullptr;
+
+static const char kLevelChar[] = { '-', 'E', 'W', 'I', 'D', 'V' };
+
+static inline uint32_t slot_seq(uint32_t pos) {
+    uint32_t idx = pos & (APP_LOG_SLOTS - 1);
+    return gSlots[idx].seq.load(std::memory_order_acquire) + idx;
+}
+
+static inline void set_slot_seq(uint32_t pos, uint32_t seq) {
+    uint32_t idx = pos & (APP_LOG_SLOTS - 1);
+    gSlots[idx].seq.store(seq - idx, std::memory_order_release);
+}
+
+void app_log_write(uint8_t level, const char* tag, const char* fmt, ...) {
+    uint32_t pos = gHead.load(std::memory_order_relaxed);
+    log_slot_t* slot;
+    for (;;) {
+        slot = &gSlots[pos & (APP_LOG_SLOTS - 1)];
+        int32_t diff = (int32_t)(slot_seq(pos) - pos);
+        if (diff == 0) {
+            if (gHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            gDropped.fetch_add(1, std::memory_order_relaxed);   // lleno: no bloquear
+            return;
+        } else {
+            pos = gHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->tag = tag;
+    slot->ms = millis();
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(slot->text, sizeof(slot->text), fmt, ap);
+    va_end(ap);
+    set_slot_seq(pos, pos + 1);                                 // publicado
+}
+
+static void loopTask_log(void *pvParameters) {
+    for (;;) {
+        for (;;) {
+            if (slot_seq(gTail) != gTail + 1) break;
+            const log_slot_t &slot = gSlots[gTail & (APP_LOG_SLOTS - 1)];
+
+            Serial.printf("%c %6u [%s] %s\n",
+                          kLevelChar[slot.level <= APP_LOG_VERBOSE ? slot.level : 0],
+                          (unsigned)slot.ms, slot.tag ? slot.tag : "-", slot.text);
+
+            set_slot_seq(gTail, gTail + APP_LOG_SLOTS);                       // libre
+            gTail++;
+        }
+        vTaskDelay(APP_LOG_DRAIN_MS / portTICK_PERIOD_MS);
+    }
+}
+
+void app_log_init() {
+    if (gDrainTask) return;
+    task_config_create(TASK_LOG, loopTask_log, nullptr, &gDrainTask);
+}
+
+uint32_t app_log_dropped() {
+    return gDropped.load(std::memory_order_relaxed);
+}
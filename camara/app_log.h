@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+
+// Niveles de log. Lo que quede por debajo de APP_LOG_LEVEL desaparece en
+// compilación (los argumentos ni se evalúan). Producción: APP_LOG_WARN.
+#define APP_LOG_NONE    0
+#define APP_LOG_ERROR   1
+#define APP_LOG_WARN    2
+#define APP_LOG_INFO    3
+#define APP_LOG_DEBUG   4
+#define APP_LOG_VERBOSE 5
+
+#ifndef APP_LOG_LEVEL
+#define APP_LOG_LEVEL APP_LOG_INFO
+#endif
+
+#define APP_LOG_SLOTS   32          // mensajes pendientes en el ring (potencia de 2)
+#define APP_LOG_MSG_LEN 96          // se trunca lo que no quepa
+
+// Encola un mensaje ya filtrado por nivel. Nunca bloquea: si el ring está lleno
+// el mensaje se descarta y se cuenta. Seguro desde cualquier tarea (no ISR).
+void app_log_write(uint8_t level, const char* tag, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// Tarea de baja prioridad que vacía el ring hacia Serial
+void app_log_init();
+
+// Mensajes perdidos por ring lleno
+uint32_t app_log_dropped();
+
+#if APP_LOG_LEVEL >= APP_LOG_ERROR
+#define LOG_E(tag, fmt, ...) app_log_write(APP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(tag, fmt, ...) do {} while (0)
+#endif
+
+#if APP_LOG_LEVEL >= APP_LOG_WARN
+#define LOG_W(tag, fmt, ...) app_log_write(APP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(tag, fmt, ...) do {} while (0)
+#endif
+
+#if APP_LOG_LEVEL >= APP_LOG_INFO
+#define LOG_I(tag, fmt, ...) app_log_write(APP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(tag, fmt, ...) do {} while (0)
+#endif
+
+#if APP_LOG_LEVEL >= APP_LOG_DEBUG
+#define LOG_D(tag, fmt, ...) app_log_write(APP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(tag, fmt, ...) do {} while (0)
+#endif
+
+#if APP_LOG_LEVEL >= APP_LOG_VERBOSE
+#define LOG_V(tag, fmt, ...) app_log_write(APP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_V(tag, fmt, ...) do {} while (0)
+#endif
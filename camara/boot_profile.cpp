@@ -0,0 +1,44 @@
+#include "boot_profile.h"
+
+// ============ Estado ============
+static portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t gPhaseMs[BOOT_PHASES] = {};
+
+static const char* const kNames[BOOT_PHASES] = {
+    "camera", "display", "tasks", "first_frame",
+    "wifi", "socket", "first_uplink", "first_detection",
+};
+
+// ============ API ============
+void boot_mark(boot_phase_t phase) {
+    if (phase >= BOOT_PHASES) return;
+    uint32_t now = millis();
+    if (now == 0) now = 1;                 // 0 = no alcanzada
+    portENTER_CRITICAL(&bootMux);
+    if (!gPhaseMs[phase]) gPhaseMs[phase] = now;
+    portEXIT_CRITICAL(&bootMux);
+}
+
+uint32_t boot_phase_ms(boot_phase_t phase) {
+    if (phase >= BOOT_PHASES) return 0;
+    portENTER_CRITICAL(&bootMux);
+    uint32_t v = gPhaseMs[phase];
+    portEXIT_CRITICAL(&bootMux);
+    return v;
+}
+
+bool boot_profile_complete() {
+    return boot_phase_ms(BOOT_FIRST_DETECTION) || millis() >= BOOT_PROFILE_TIMEOUT_MS;
+}
+
+size_t boot_profile_format(char* buf, size_t len) {
+    if (!buf || !len) return 0;
+    size_t n = snprintf(buf, len, "{\"boot\":{");
+    for (int i = 0; i < BOOT_PHASES && n < len; i++) {
+        uint32_t ms = boot_phase_ms((boot_phase_t)i);
+        n += snprintf(buf + n, len - n, "%s\"%s\":%ld", i ? "," : "", kNames[i],
+                      ms ? (long)ms : -1L);
+    }
+    if (n < len) n += snprintf(buf + n, len - n, "}}");
+    return n < len ? n : len - 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+
+// Perfil de arranque: instante (ms desde el arranque) en que termina cada fase.
+// El arranque va en etapas concurrentes: la vista previa local empieza en cuanto
+// cámara y TFT están listos; WiFi y socket conectan en segundo plano y el uplink
+// empieza cuando hay enlace. Se registra solo la primera vez de cada fase.
+#define BOOT_PROFILE_TIMEOUT_MS 60000   // sin primera detección: se informa igualmente
+
+enum boot_phase_t {
+    BOOT_CAMERA = 0,        // camera_init
+    BOOT_DISPLAY,           // TFT listo
+    BOOT_TASKS,             // fin de setup(): tareas creadas
+    BOOT_FIRST_FRAME,       // primer frame pintado (vista previa)
+    BOOT_WIFI,              // IP obtenida
+    BOOT_SOCKET,            // WebSocket conectado
+    BOOT_FIRST_UPLINK,      // primer frame enviado
+    BOOT_FIRST_DETECTION,   // primera respuesta del servidor
+    BOOT_PHASES
+};
+
+// Marca la fase (cualquier tarea; solo cuenta la primera llamada)
+void boot_mark(boot_phase_t phase);
+
+// ms de la fase, 0 si aún no ha ocurrido
+uint32_t boot_phase_ms(boot_phase_t phase);
+
+// Completo: primera detección o BOOT_PROFILE_TIMEOUT_MS
+bool boot_profile_complete();
+
+// {"boot":{"camera":412,...}} (-1 = fase no alcanzada). Devuelve la longitud.
+size_t boot_profile_format(char* buf, size_t len);
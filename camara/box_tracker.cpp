@@ -0,0 +1,140 @@
+#include "box_tracker.h"
+#include <string.h>
+
+// ============ Helpers ============
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Tiempo transcurrido desde la última corrección, limitado al horizonte
+static float elapsed_ms(const box_track_t &k, uint32_t t_ms) {
+    int32_t dt = (int32_t)(t_ms - k.t_ms);
+    if (dt < 0) dt = 0;
+    if (dt > TRACK_MAX_PREDICT_MS) dt = TRACK_MAX_PREDICT_MS;
+    return (float)dt;
+}
+
+static float iou(float ax, float ay, float aw, float ah, const Deteccion &b) {
+    float x0 = ax > b.x ? ax : b.x;
+    float y0 = ay > b.y ? ay : b.y;
+    float x1 = (ax + aw) < (b.x + b.w) ? (ax + aw) : (b.x + b.w);
+    float y1 = (ay + ah) < (b.y + b.h) ? (ay + ah) : (b.y + b.h);
+    if (x1 <= x0 || y1 <= y0) return 0.0f;
+    float inter = (x1 - x0) * (y1 - y0);
+    return inter / (aw * ah + (float)b.w * b.h - inter);
+}
+
+static void start_track(box_tracker_t* t, const Deteccion &d, uint32_t t_ms) {
+    for (int i = 0; i < TRACK_MAX; i++) {
+        box_track_t &k = t->tracks[i];
+        if (k.live) continue;
+        memcpy(k.label, d.label, DET_LABEL_LEN);
+        k.cx = d.x + d.w * 0.5f;
+        k.cy = d.y + d.h * 0.5f;
+        k.w = (float)d.w;
+        k.h = (float)d.h;
+        k.vx = k.vy = 0.0f;
+        k.t_ms = t_ms;
+        k.hits = 1;
+        k.misses = 0;
+        k.live = true;
+        t->created++;
+        return;
+    }
+}
+
+// Corrección alfa-beta; la primera vez la velocidad sale directa de las dos medidas
+static void update_track(box_track_t &k, const Deteccion &d, uint32_t t_ms) {
+    int32_t dtRaw = (int32_t)(t_ms - k.t_ms);
+    float dt = dtRaw > 0 ? (float)dtRaw : 1.0f;
+    float dp = elapsed_ms(k, t_ms);
+    float px = k.cx + k.vx * dp;
+    float py = k.cy + k.vy * dp;
+    float rx = (d.x + d.w * 0.5f) - px;
+    float ry = (d.y + d.h * 0.5f) - py;
+
+    // Medida del mismo instante (o desordenada): solo corrige posición/tamaño
+    float beta = dtRaw <= 0 ? 0.0f : (k.hits == 1 ? 1.0f : TRACK_BETA);
+    k.cx = px + TRACK_ALPHA * rx;
+    k.cy = py + TRACK_ALPHA * ry;
+    k.vx = clampf(k.vx + beta * rx / dt, -TRACK_MAX_SPEED, TRACK_MAX_SPEED);
+    k.vy = clampf(k.vy + beta * ry / dt, -TRACK_MAX_SPEED, TRACK_MAX_SPEED);
+    k.w += TRACK_ALPHA * (d.w - k.w);
+    k.h += TRACK_ALPHA * (d.h - k.h);
+    k.t_ms = dtRaw > 0 ? t_ms : k.t_ms;
+    if (k.hits < 255) k.hits++;
+    k.misses = 0;
+}
+
+// ============ API ============
+void box_tracker_reset(box_tracker_t* t) {
+    if (t) memset(t, 0, sizeof(*t));
+}
+
+// Asociación voraz: empareja repetidamente el par (pista, detección) de mayor
+// IoU con la pista predicha al instante de la medida. Con <= 10x10 pares basta.
+void box_tracker_correct(box_tracker_t* t, const Deteccion* dets, int n, uint32_t t_ms) {
+    if (!t) return;
+    if (!dets || n < 0) n = 0;
+    if (n > TRACK_MAX) n = TRACK_MAX;
+
+    bool trackUsed[TRACK_MAX] = {};
+    bool detUsed[TRACK_MAX] = {};
+    for (;;) {
+        float best = TRACK_IOU_MIN;
+        int bi = -1, bj = -1;
+        for (int i = 0; i < TRACK_MAX; i++) {
+            const box_track_t &k = t->tracks[i];
+            if (!k.live || trackUsed[i]) continue;
+            float dt = elapsed_ms(k, t_ms);
+            float w = k.w, h = k.h;
+            float x = k.cx + k.vx * dt - w * 0.5f;
+            float y = k.cy + k.vy * dt - h * 0.5f;
+            for (int j = 0; j < n; j++) {
+                if (detUsed[j] || strcmp(k.label, dets[j].label) != 0) continue;
+                float o = iou(x, y, w, h, dets[j]);
+                if (o > best) { best = o; bi = i; bj = j; }
+            }
+        }
+        if (bi < 0) break;
+        update_track(t->tracks[bi], dets[bj], t_ms);
+        trackUsed[bi] = detUsed[bj] = true;
+        t->matched++;
+    }
+
+    for (int i = 0; i < TRACK_MAX; i++) {
+        box_track_t &k = t->tracks[i];
+        if (!k.live || trackUsed[i]) continue;
+        if (++k.misses > TRACK_MAX_MISSES) {
+            k.live = false;
+            t->dropped++;
+        }
+    }
+    for (int j = 0; j < n; j++) {
+        if (!detUsed[j]) start_track(t, dets[j], t_ms);
+    }
+}
+
+int box_tracker_predict(const box_tracker_t* t, uint32_t t_ms, Deteccion* out, int max) {
+    if (!t || !out) return 0;
+    int n = 0;
+    for (int i = 0; i < TRACK_MAX && n < max; i++) {
+        const box_track_t &k = t->tracks[i];
+        if (!k.live || k.misses) continue;      // perdida: no se pinta, pero sigue casable
+        float dt = elapsed_ms(k, t_ms);
+        float x0 = clampf(k.cx + k.vx * dt - k.w * 0.5f, 0.0f, WS_DRAW_W - 1);
+        float y0 = clampf(k.cy + k.vy * dt - k.h * 0.5f, 0.0f, WS_DRAW_H - 1);
+        float x1 = clampf(k.cx + k.vx * dt + k.w * 0.5f, x0 + 1, WS_DRAW_W);
+        float y1 = clampf(k.cy + k.vy * dt + k.h * 0.5f, y0 + 1, WS_DRAW_H);
+
+        Deteccion &d = out[n++];
+        memcpy(d.label, k.label, DET_LABEL_LEN);
+        d.x = (int)(x0 + 0.5f);
+        d.y = (int)(y0 + 0.5f);
+        d.w = (int)(x1 - x0 + 0.5f);
+        d.h = (int)(y1 - y0 + 0.5f);
+        if (d.x + d.w > WS_DRAW_W) d.w = WS_DRAW_W - d.x;
+        if (d.y + d.h > WS_DRAW_H) d.h = WS_DRAW_H - d.y;
+    }
+    return n;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "ws_draw.h"
+
+// Seguimiento de cajas en el cliente: asocia cada respuesta del servidor con las
+// pistas existentes por IoU y predice su posición con velocidad constante
+// (filtro alfa-beta) en cada frame pintado. Estado fijo, sin heap; las funciones
+// reciben el tiempo explícito para poder reproducir secuencias grabadas.
+#define TRACK_MAX            WS_DRAW_MAX_DET
+#define TRACK_IOU_MIN        0.10f  // solape mínimo para casar detección y pista
+#define TRACK_ALPHA          0.65f  // peso de la medida en posición/tamaño
+#define TRACK_BETA           0.30f  // peso de la medida en velocidad
+#define TRACK_MAX_SPEED      1.0f   // px/ms (1000 px/s): limita saltos por malas asociaciones
+#define TRACK_MAX_PREDICT_MS 500    // horizonte máximo de extrapolación
+#define TRACK_MAX_MISSES     2      // respuestas sin casar antes de borrar la pista
+
+struct box_track_t {
+    char label[DET_LABEL_LEN];
+    float cx, cy, w, h;     // centro y tamaño en la última corrección
+    float vx, vy;           // px/ms
+    uint32_t t_ms;          // instante de la última corrección
+    uint8_t hits;           // correcciones casadas
+    uint8_t misses;         // respuestas seguidas sin casar (0: visible)
+    bool live;
+};
+
+struct box_tracker_t {
+    box_track_t tracks[TRACK_MAX];
+    uint32_t matched;       // contadores para diagnóstico
+    uint32_t created;
+    uint32_t dropped;
+};
+
+void box_tracker_reset(box_tracker_t* t);
+
+// Corrige con una respuesta del servidor; t_ms es el instante de captura del
+// frame al que se refieren las detecciones (o la llegada si no se conoce).
+void box_tracker_correct(box_tracker_t* t, const Deteccion* dets, int n, uint32_t t_ms);
+
+// Cajas predichas en t_ms para las pistas casadas en la última respuesta.
+// Devuelve cuántas escribió en out (hasta max), recortadas a WS_DRAW_W x WS_DRAW_H.
+int box_tracker_predict(const box_tracker_t* t, uint32_t t_ms, Deteccion* out, int max);
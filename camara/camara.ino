@@ -5,14 +5,19 @@
 #include "camera_ui.h"
 #include "websocket_client.h"
 #include "ws_draw.h"
+#include "frame_pool.h"
+#include "jpeg_encoder.h"
+#include "app_log.h"
+#include "telemetry.h"
+#include "task_config.h"
+#include "roi_uplink.h"
+#include "pixel_kernels.h"
+#include "app_config.h"
+#include "boot_profile.h"
 
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
 
-// --- Configuración WiFi ---
-const char* ssid     = "DIGIFIBRA-2hK2";
-const char* password = "fEdfD236996S";
-
 // --- Colas y mutex ---
 QueueHandle_t captureQueue;      // (opcional) si la usa tu cámara
 QueueHandle_t detectionQueue;    // detecciones del servidor -> ws_draw
@@ -20,24 +25,29 @@ SemaphoreHandle_t captureMutex;
 
 void setup() {
     Serial.begin(115200);
+    app_log_init();  // LOG_x(): ring sin locks vaciado a Serial por una tarea de baja prioridad
+    app_config_load();  // WiFi, servidor, cámara y uplink desde NVS (app_config.h)
+    app_config_t cfg;
+    app_config_get(&cfg);
 
     // OPTIMIZADO: Mostrar memoria disponible al inicio
-    Serial.printf("\n=== DIAGNÓSTICO DE MEMORIA ===\n");
-    Serial.printf("Heap libre: %u bytes\n", ESP.getFreeHeap());
-    Serial.printf("PSRAM libre: %u bytes\n", ESP.getFreePsram());
-    Serial.printf("PSRAM total: %u bytes\n", ESP.getPsramSize());
+    LOG_I("MEM", "heap libre %u B, PSRAM libre %u B de %u B",
+          ESP.getFreeHeap(), ESP.getFreePsram(), ESP.getPsramSize());
 
     // OPTIMIZADO: Inicializar cámara PRIMERO (necesita más memoria)
-    Serial.println("\n📷 Inicializando cámara...");
     if (!camera_init()) {
-        Serial.println("❌ Error al iniciar la cámara");
-        Serial.printf("Heap libre después del fallo: %u bytes\n", ESP.getFreeHeap());
-        Serial.printf("PSRAM libre después del fallo: %u bytes\n", ESP.getFreePsram());
+        LOG_E("CAM", "error al iniciar la cámara (heap libre %u B, PSRAM libre %u B)",
+              ESP.getFreeHeap(), ESP.getFreePsram());
         while (true) delay(1000);
     }
-    Serial.println("✅ Cámara inicializada");
-    Serial.printf("Heap libre: %u bytes\n", ESP.getFreeHeap());
-    Serial.printf("PSRAM libre: %u bytes\n", ESP.getFreePsram());
+    boot_mark(BOOT_CAMERA);
+    frame_pool_init();  // leases sobre los FRAME_POOL_SLOTS buffers del driver
+    LOG_I("MEM", "tras la cámara: heap libre %u B, PSRAM libre %u B", ESP.getFreeHeap(), ESP.getFreePsram());
+
+    // WiFi en segundo plano: asocia y pide IP mientras se inicia el resto.
+    // La tarea de red espera al enlace; la vista previa no.
+    LOG_I("WIFI", "conectando en segundo plano");
+    WiFi.begin(cfg.ssid, cfg.pass);
 
     // Inicialización pantalla
     tft.begin();
@@ -47,38 +57,37 @@ void setup() {
     tft.setTextSize(2);
     tft.setCursor(20, 100);
     tft.print("Iniciando...");
-
-    // Conexión WiFi
-    Serial.print("\n📡 Conectando WiFi");
-    WiFi.begin(ssid, password);
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
-    }
-    Serial.println("\n✅ WiFi conectado");
-    Serial.println(WiFi.localIP());
-
-    tft.fillScreen(TFT_BLACK);
-    tft.setCursor(20, 120);
-    tft.print("WiFi OK");
+    boot_mark(BOOT_DISPLAY);
 
     // Inicializar colas y mutex (OPTIMIZADO: reducir tamaño)
     captureQueue   = xQueueCreate(1, sizeof(uint8_t*));     // Reducido de 2 a 1
     detectionQueue = xQueueCreate(2, sizeof(Deteccion*));   // Reducido de 4 a 2
     captureMutex   = xSemaphoreCreateMutex();
+    telemetry_register_queue("capture", captureQueue);
+    telemetry_register_queue("detect", detectionQueue);
+    task_config_apply_current(TASK_LOOP);   // setup() corre en la loop task (dibujo)
 
-    Serial.printf("Heap libre después de colas: %u bytes\n", ESP.getFreeHeap());
+    LOG_I("MEM", "tras las colas: heap libre %u B", ESP.getFreeHeap());
 
     // Inicializar WebSocket y capa de dibujo
-    websocket_init("3b6bec75bba4.ngrok-free.app", 443, "/ws", true);
+    websocket_init(cfg.host, cfg.port, cfg.path, cfg.ssl);
     ws_draw_init();
+    jpeg_encoder_init();     // uplink en JPEG (calidad adaptativa); RGB565 si no hay PSRAM
+    roi_uplink_init();       // staging de recortes ROI (modo desactivado por defecto)
+    px_kernels_init();       // tablas de luma (pixel_kernels)
+#if PX_KERNELS_BENCH
+    px_kernels_selftest(240, 240);
+#endif
+    websocket_start_task();  // dueña única de webSocket (loop + envío)
+    app_config_apply_runtime();  // fps, JPEG, uplink_shift, ROI y motion gate guardados
 
     // Crear tareas asincrónicas (tus mismas llamadas)
     create_camera_task(captureQueue, detectionQueue, captureMutex);
     start_ws_task(detectionQueue);  // compat: la función existe (stub) y guarda la cola si la quieres usar luego
+    boot_mark(BOOT_TASKS);
 }
 
 void loop() {
-    // Mantiene WS y dibuja el último frame + detecciones
+    // Dibuja el último frame + detecciones (el WS vive en la tarea de red)
     ws_draw_loop();
 }
@@ -1,10 +1,14 @@
 #include "camera.h"
+#include "frame_pool.h"
+#include "frame_views.h"
+#include "app_log.h"
+
+static app_config_t gRunning;   // última configuración que arrancó
 
 bool camera_flip_vertical_state = 0;
 bool camera_mirror_horizontal_state = 1;
 
-int camera_init(void) {
-  camera_config_t config;
+static void fill_config(camera_config_t &config, const app_config_t &cfg) {
   config.ledc_channel = LEDC_CHANNEL_0;
   config.ledc_timer = LEDC_TIMER_0;
   config.pin_d0 = Y2_GPIO_NUM;
@@ -23,18 +27,23 @@ int camera_init(void) {
   config.pin_sccb_scl = SIOC_GPIO_NUM;
   config.pin_pwdn = PWDN_GPIO_NUM;
   config.pin_reset = RESET_GPIO_NUM;
-  config.xclk_freq_hz = 20000000;  // Aumentar frecuencia para mejor rendimiento
-  config.frame_size = FRAMESIZE_240X240;
-  config.pixel_format = PIXFORMAT_RGB565;
+  config.xclk_freq_hz = cfg.xclk_hz;  // 20 MHz por defecto (app_config)
+  config.frame_size = (framesize_t)cfg.framesize;
+  config.pixel_format = (pixformat_t)cfg.pixformat;
   config.grab_mode = CAMERA_GRAB_LATEST;
   config.fb_location = CAMERA_FB_IN_PSRAM;  // Requiere PSRAM habilitado
-  config.jpeg_quality = 12;  // No se usa con RGB565, pero optimizado
-  config.fb_count = 1;  // OPTIMIZADO: Reducir de 2 a 1 buffer (-115KB)
+  config.jpeg_quality = 12;  // Solo con pixformat JPEG del sensor
+  config.fb_count = cfg.fb_count;  // 3: el sensor captura mientras display/uplink usan el anterior
+}
+
+static bool start(const app_config_t &cfg) {
+  camera_config_t config;
+  fill_config(config, cfg);
 
   esp_err_t err = esp_camera_init(&config);
   if (err != ESP_OK) {
-    Serial.printf("Camera init failed with error 0x%x\r\n", err);
-    return 0;
+    LOG_E("CAM", "esp_camera_init falló: 0x%x", err);
+    return false;
   }
 
   sensor_t * s = esp_camera_sensor_get();
@@ -43,10 +52,53 @@ int camera_init(void) {
   s->set_brightness(s, 0);
   s->set_saturation(s, 0);
 
-  Serial.println("Camera configuration complete!");
+  frame_views_set_capture(resolution[cfg.framesize].width, resolution[cfg.framesize].height);
+  frame_pool_set_capacity(cfg.fb_count);   // tantos leases como buffers tiene el driver
+  return true;
+}
+
+int camera_init(void) {
+  app_config_t cfg;
+  app_config_get(&cfg);
+  if (!start(cfg)) {
+    // La guardada no arranca (otro sensor, xclk, memoria): sin ella no habría cámara
+    // hasta borrar la NVS. Se vuelve a la compilada y se refleja en app_config.
+    LOG_W("CAM", "configuración guardada falló, uso la por defecto");
+    app_config_camera_defaults(&cfg);
+    if (!start(cfg)) return 0;
+    app_config_camera_applied(cfg, false);
+  }
+  gRunning = cfg;
+
+  LOG_I("CAM", "cámara configurada");
   return 1;
 }
 
+// El driver libera y vuelve a reservar sus fb en PSRAM; si la nueva
+// configuración falla se vuelve a la que funcionaba.
+bool camera_reconfigure(const app_config_t &cfg, camera_switch_t* t) {
+  uint32_t t0 = millis();
+  esp_camera_deinit();
+  uint32_t t1 = millis();
+  bool ok = start(cfg);
+  if (ok) gRunning = cfg;
+  else start(gRunning);
+  uint32_t t2 = millis();
+  bool saved = app_config_camera_applied(gRunning, ok);   // NVS solo si arrancó
+
+  if (t) {
+    t->deinit_ms = t1 - t0;
+    t->init_ms = t2 - t1;
+    t->ok = ok;
+    t->saved = saved;
+  }
+  return ok;
+}
+
+void camera_get_running(app_config_t* out) {
+  if (out) *out = gRunning;
+}
+
 bool camera_get_flip_vertical(void) { return camera_flip_vertical_state; }
 bool camera_get_mirror_horizontal(void) { return camera_mirror_horizontal_state; }
 
@@ -5,8 +5,29 @@
 #define CAMERA_MODEL_ESP32S3_EYE
 #include "camera_pins.h"
 #include "esp_camera.h"
+#include "app_config.h"
 
+// Captura a más resolución que el panel (frame_views.h): VGA -> vista 480x480,
+// panel 240x240 (2x) y uplink configurable. FRAMESIZE_240X240 = comportamiento original.
+// Valor por defecto: la configuración en uso viene de app_config.
+#define CAMERA_FRAMESIZE FRAMESIZE_VGA
+
+// Tiempos de un cambio de configuración en caliente (se devuelven al servidor)
+struct camera_switch_t {
+    uint32_t drain_ms;        // espera a que se devuelvan las concesiones
+    uint32_t deinit_ms;
+    uint32_t init_ms;
+    uint32_t first_frame_ms;  // init -> primer frame nuevo
+    bool ok;                  // false: se restauró la configuración anterior
+    bool saved;               // "save" pedido y guardado en NVS tras arrancar
+};
+
+// Arranca con la configuración de app_config; si falla, con la compilada por defecto
 int camera_init();//Initialize the camera drive
+// Reinicia el driver con otra configuración (sin concesiones pendientes)
+bool camera_reconfigure(const app_config_t &cfg, camera_switch_t* t);
+// Configuración con la que está funcionando el driver
+void camera_get_running(app_config_t* out);
 void camera_set_flip_vertical(bool state);//Flip Vertical
 void camera_set_mirror_horizontal(bool state);//Mirror Horizontal
 bool camera_get_flip_vertical(void);
@@ -3,8 +3,20 @@
 #include "camera.h"
 #include "display.h"
 #include "websocket_client.h"
+#include "frame_pool.h"
+#include "rate_ctrl.h"
+#include "task_config.h"
+#include "motion_gate.h"
+#include "roi_uplink.h"
+#include "app_config.h"
+#include "frame_views.h"
+#include "uplink_window.h"
+#include "app_log.h"
+
+// Espera máxima a display/uplink antes de reiniciar: con la cola de uplink vaciada
+// solo queda un envío en curso; nunca menos que lo que tarda en caducar un ack
+#define CAMERA_DRAIN_TIMEOUT_MS (UPLINK_ACK_TIMEOUT_MS + 1000)
 
-camera_fb_t *fb = nullptr;
 TaskHandle_t cameraTaskHandle = nullptr;
 static int camera_task_flag = 0;
 
@@ -15,31 +27,98 @@ static SemaphoreHandle_t captureMutexLocal;
 
 void loopTask_camera(void *pvParameters);
 
+// Cambio de cámara en curso: se completa (y se responde) con el primer frame nuevo
+static camera_switch_t gSwitch;
+static uint32_t gSwitchInitMs = 0;
+static bool gSwitchPending = false;
+
+static void reply_switch(){
+    frame_view_t v;
+    frame_views_get(&v);
+    char buf[APP_CFG_REPLY_LEN];
+    snprintf(buf, sizeof(buf),
+             "{\"cfg\":{\"camera\":%s,\"drain_ms\":%u,\"deinit_ms\":%u,\"init_ms\":%u,"
+             "\"first_frame_ms\":%u,\"view\":%u,\"saved\":%s}}",
+             gSwitch.ok ? "true" : "\"restaurada\"", (unsigned)gSwitch.drain_ms,
+             (unsigned)gSwitch.deinit_ms, (unsigned)gSwitch.init_ms,
+             (unsigned)gSwitch.first_frame_ms, (unsigned)v.side, gSwitch.saved ? "true" : "false");
+    app_config_reply(buf);
+    LOG_I("CAM", "cambio %s: drain %u, deinit %u, init %u, primer frame %u ms",
+          gSwitch.ok ? "ok" : "fallido", (unsigned)gSwitch.drain_ms, (unsigned)gSwitch.deinit_ms,
+          (unsigned)gSwitch.init_ms, (unsigned)gSwitch.first_frame_ms);
+}
+
+// Reinicia el driver cuando display y uplink han devuelto todas sus concesiones:
+// esp_camera_deinit libera los fb que aún referenciarían. El frame que espera en
+// la cola de uplink (quizá a que se abra la ventana) se suelta sin enviar.
+static void reconfigure(const app_config_t &cfg){
+    gSwitch = {};
+    uint32_t t0 = millis();
+    websocket_hold_uplink(true);
+    frame_pool_stats_t st;
+    for(;;){
+        frame_pool_get_stats(&st);
+        if(st.outstanding == 0) break;
+        if(millis() - t0 > CAMERA_DRAIN_TIMEOUT_MS){
+            app_config_t running;
+            camera_get_running(&running);
+            app_config_camera_applied(running, false);   // sin cambio: ni se guarda ni se queda en gCfg
+            app_config_reply("{\"cfg\":{\"camera\":false,\"error\":\"drain\"}}");
+            LOG_W("CAM", "cambio cancelado: %d concesiones vivas", st.outstanding);
+            websocket_hold_uplink(false);
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    gSwitch.drain_ms = millis() - t0;
+
+    camera_reconfigure(cfg, &gSwitch);
+    roi_uplink_init();   // el staging crece si la vista nueva es mayor
+    websocket_hold_uplink(false);
+    gSwitchInitMs = millis();
+    gSwitchPending = true;
+}
+
 void create_camera_task(QueueHandle_t captureQueue, QueueHandle_t detectionQueue, SemaphoreHandle_t captureMutex) {
     if(camera_task_flag == 0) {
         camera_task_flag   = 1;
         captureQueueLocal   = captureQueue;
         detectionQueueLocal = detectionQueue;
         captureMutexLocal   = captureMutex;
-        xTaskCreate(loopTask_camera, "loopTask_camera", 8192, nullptr, 1, &cameraTaskHandle);
+        task_config_create(TASK_CAMERA, loopTask_camera, nullptr, &cameraTaskHandle);
     }
 }
 
 void loopTask_camera(void *pvParameters) {
-    const int frameDelay = 66; // ~15 FPS
+    // Periodo fijado por rate_ctrl (medido desde el inicio del ciclo, sin deriva)
+    TickType_t lastWake = xTaskGetTickCount();
     while(camera_task_flag) {
-        fb = esp_camera_fb_get();
-        if(fb) {
-            // OPTIMIZADO: Usar el buffer de la cámara directamente para display
-            // El WebSocket hará su propia copia internamente si es necesario
-            ws_draw_set_frame_direct(fb->buf, fb->len);
+        app_config_t cfg;
+        if(app_config_take_camera_change(&cfg)) reconfigure(cfg);
+
+        frame_lease_t* lease = frame_pool_acquire();
+        if(lease) {
+            if(gSwitchPending){
+                gSwitch.first_frame_ms = millis() - gSwitchInitMs;
+                gSwitchPending = false;
+                reply_switch();
+            }
+
+            // El display (loop task) toma su propia referencia y dibuja en paralelo
+            ws_draw_set_frame_lease(lease);
 
-            // Enviar frame por WebSocket (la biblioteca hace copia si es necesario)
-            websocket_send_frame(fb->buf, fb->len);
+            // Uplink: solo si la escena cambió (o toca keep-alive). La tarea de red
+            // envía; aquí nunca se bloquea por la red
+            if(motion_gate_should_send(lease->fb)) websocket_enqueue_frame(lease);
 
-            esp_camera_fb_return(fb);
+            // Suelta la referencia de captura; el frame vuelve al driver con la última
+            frame_lease_release(lease);
         }
-        vTaskDelay(frameDelay / portTICK_PERIOD_MS);
+        TickType_t period = pdMS_TO_TICKS(rate_ctrl_interval_ms());
+        if(period == 0) period = 1;
+        // Si el ciclo ya se pasó del periodo, re-sincroniza en vez de encadenar capturas
+        if(xTaskGetTickCount() - lastWake >= period) lastWake = xTaskGetTickCount();
+        else vTaskDelayUntil(&lastWake, period);
     }
     vTaskDelete(cameraTaskHandle);
 }
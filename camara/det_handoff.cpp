@@ -0,0 +1,16 @@
+#include "det_handoff.h"
+
+// ============ Escritor ============
+det_set_t* det_handoff_back(det_handoff_t* h) {
+    return &h->slots[h->idx.back];
+}
+
+void det_handoff_publish(det_handoff_t* h) {
+    h->slots[h->idx.back].gen = ++h->gen;
+    tribuf_publish(&h->idx);
+}
+
+// ============ Lector ============
+const det_set_t* det_handoff_read(det_handoff_t* h) {
+    return &h->slots[tribuf_acquire(&h->idx, nullptr)];
+}
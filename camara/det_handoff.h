@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+#include "tribuf.h"
+#include "ws_draw.h"
+
+// Traspaso de detecciones sin bloqueo entre un escritor (tarea de red) y un
+// lector (loop de dibujo): triple buffer (tribuf.h) de conjuntos de tamaño fijo.
+// El lector siempre ve un conjunto completo, nunca mezcla de dos respuestas.
+struct det_set_t {
+    Deteccion dets[WS_DRAW_MAX_DET];
+    int count;
+    uint32_t gen;           // cambia con cada publicación
+    uint32_t ms;            // captura (o llegada) de la respuesta
+};
+
+struct det_handoff_t {
+    det_set_t slots[3];
+    tribuf_t idx;
+    uint32_t gen = 0;       // solo escritor
+};
+
+// Escritor: buffer a rellenar y publicación (asigna gen)
+det_set_t* det_handoff_back(det_handoff_t* h);
+void det_handoff_publish(det_handoff_t* h);
+
+// Lector: conjunto más reciente publicado (válido hasta la siguiente llamada)
+const det_set_t* det_handoff_read(det_handoff_t* h);
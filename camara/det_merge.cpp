@@ -0,0 +1,79 @@
+#include "det_merge.h"
+#include "app_log.h"
+#include <string.h>
+
+// ============ Estado ============
+// Frames enviados recientemente: seq -> mensajes enviados / respondidos y espacio
+struct merge_frame_t {
+    uint32_t seq;
+    uint8_t parts;
+    uint8_t answered;
+    uint16_t side;
+};
+static merge_frame_t gSent[DET_MERGE_FRAMES];
+
+// Unión de las respuestas del frame que se está respondiendo (0: ninguno)
+static uint32_t gOpenSeq = 0;
+static Deteccion gOpen[WS_DRAW_MAX_DET];
+static int gOpenCount = 0;
+
+// ============ Helpers ============
+static float iou(const Deteccion &a, const Deteccion &b) {
+    int x0 = a.x > b.x ? a.x : b.x;
+    int y0 = a.y > b.y ? a.y : b.y;
+    int x1 = (a.x + a.w) < (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int y1 = (a.y + a.h) < (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+    if (x1 <= x0 || y1 <= y0) return 0.0f;
+    float inter = (float)(x1 - x0) * (y1 - y0);
+    return inter / ((float)a.w * a.h + (float)b.w * b.h - inter);
+}
+
+// Ya está en la unión (un recorte y la vista de descubrimiento ven el mismo objeto):
+// se queda la primera, que viene del recorte a más resolución
+static bool duplicate(const Deteccion &d) {
+    for (int i = 0; i < gOpenCount; i++) {
+        if (strcmp(gOpen[i].label, d.label) == 0 && iou(gOpen[i], d) >= DET_MERGE_IOU) return true;
+    }
+    return false;
+}
+
+// ============ API ============
+void det_merge_init() {
+    memset(gSent, 0, sizeof(gSent));
+    gOpenSeq = 0;
+    gOpenCount = 0;
+}
+
+void det_merge_on_send(uint32_t seq, uint8_t parts, uint16_t side) {
+    merge_frame_t &f = gSent[seq % DET_MERGE_FRAMES];
+    f.seq = seq;
+    f.parts = parts;
+    f.answered = 0;
+    f.side = side;
+}
+
+uint16_t det_merge_side(uint32_t seq) {
+    const merge_frame_t &f = gSent[seq % DET_MERGE_FRAMES];
+    return seq && f.seq == seq ? f.side : 0;
+}
+
+int det_merge_add(uint32_t seq, Deteccion* dets, int n) {
+    if (!seq) return n;                     // servidor sin eco de frame_id
+    merge_frame_t &f = gSent[seq % DET_MERGE_FRAMES];
+    if (f.seq != seq || f.parts <= 1) return n;
+    if (f.answered >= f.parts) return -1;   // respuesta repetida de un frame ya publicado
+
+    if (gOpenSeq != seq) {
+        if (gOpenSeq) LOG_D("WS", "frame %u sin todas sus respuestas: se descarta", (unsigned)gOpenSeq);
+        gOpenSeq = seq;
+        gOpenCount = 0;
+    }
+    for (int i = 0; i < n && gOpenCount < WS_DRAW_MAX_DET; i++) {
+        if (!duplicate(dets[i])) gOpen[gOpenCount++] = dets[i];
+    }
+    if (++f.answered < f.parts) return -1;
+
+    memcpy(dets, gOpen, sizeof(Deteccion) * gOpenCount);
+    gOpenSeq = 0;
+    return gOpenCount;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include "ws_draw.h"
+
+// Respuestas de un frame enviado en varios mensajes. En modo ROI (roi_uplink.h)
+// los recortes y la vista de descubrimiento comparten seq y el servidor responde
+// a cada uno por separado: publicar cada respuesta sustituiría el conjunto
+// entero (parpadeo) y solo la primera confirmaría el frame. Aquí se juntan y el
+// frame se publica, confirma y mide una sola vez, con la unión de sus cajas.
+// También recuerda en qué espacio responde el servidor a cada frame (vista en
+// ROI, imagen de uplink en modo normal) para escalar sus cajas en píxeles.
+// Solo la tarea de red (envío y recepción), sin locks.
+#define DET_MERGE_FRAMES    16      // frames enviados recordados (como LAT_TRACK_FRAMES)
+#define DET_MERGE_IOU       0.5f    // misma etiqueta y más solape: la misma caja vista dos veces
+
+void det_merge_init();
+
+// Tras enviar los `parts` mensajes del frame seq (solo los que salieron), cuyas
+// respuestas vienen en píxeles de un espacio side x side (roi_msg_t::reply_side)
+void det_merge_on_send(uint32_t seq, uint8_t parts, uint16_t side);
+
+// Lado del espacio de las respuestas al frame seq; 0 si no se recuerda
+uint16_t det_merge_side(uint32_t seq);
+
+// Respuesta a un mensaje del frame seq, con sus n cajas ya en el panel en dets
+// (hueco para WS_DRAW_MAX_DET). Con el frame completo deja en dets la unión de
+// todas sus respuestas y devuelve cuántas cajas tiene; -1 si aún faltan partes
+// (o si sobra: el frame ya se publicó). seq 0 o no recordado: una sola parte.
+// Si empieza a responderse otro frame, lo que quedara a medias se descarta (el
+// servidor responde en orden: sus partes pendientes ya no llegarán).
+int det_merge_add(uint32_t seq, Deteccion* dets, int n);
@@ -0,0 +1,263 @@
+#include "det_parse.h"
+#include "det_proto.h"
+#include "ws_draw.h"
+#include "latency_stats.h"
+#include "frame_views.h"
+#include "app_config.h"
+#include "uplink_window.h"
+#include "det_merge.h"
+#include "app_log.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Documento JSON dimensionado con las macros de ArduinoJson (huecos de 16 bytes en
+// el ESP32, el doble en un PC de 64 bits): raíz con frame_id + array, hasta
+// DET_PARSE_MAX_BOXES cajas de 6 miembros (x/y/w/h o xmin/..., label, score) y las
+// cadenas copiadas (claves y etiquetas, deduplicadas). ~6 KB en la placa; con 2 KB
+// un mensaje de más de ~15 cajas daba NoMemory y se perdía entero (bench/bench_det_parse).
+#define DET_PARSE_MAX_BOXES     50
+#define DET_PARSE_STRING_BYTES  512
+#define DET_PARSE_DOC_BYTES     (JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(DET_PARSE_MAX_BOXES) + \
+                                 DET_PARSE_MAX_BOXES * JSON_OBJECT_SIZE(6) + DET_PARSE_STRING_BYTES)
+// Detección única como raíz: se copia a un array de un elemento
+#define DET_PARSE_ONE_BYTES     (JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(8) + 128)
+
+static_assert(DET_PROTO_MAX_BOXES <= WS_DRAW_MAX_DET, "las cajas binarias caben en el pool");
+
+// Pool fijo de cajas ya en el panel (solo lo usa la tarea de red): sin new[]/delete[] por mensaje
+static Deteccion gOut[WS_DRAW_MAX_DET];
+
+// ============ Helpers ============
+static void publish(Deteccion* arr, int count, int64_t captureUs) {
+  ws_draw_update_detecciones_at(arr, count, captureUs);
+}
+
+// Respuesta a frameId con sus cajas en gOut: junta las partes de un frame ROI
+// (det_merge.h) y, con el frame completo, lo confirma, mide y publica una vez.
+// false mientras falten partes: no cuenta como respuesta.
+static bool finish(uint32_t frameId, int count) {
+  count = det_merge_add(frameId, gOut, count);
+  if (count < 0) return false;
+  int64_t captureUs = latency_on_detection(frameId);
+  uplink_window_on_ack(frameId, millis());      // frameId 0: confirma el más antiguo
+  publish(count ? gOut : nullptr, count, captureUs);
+  LOG_D("WS", "detecciones actualizadas OK (%d)", count);
+  return true;
+}
+
+// Volcado hex por líneas de 16 bytes (solo en builds con APP_LOG_VERBOSE)
+static void hexdump(const uint8_t* p, size_t len) {
+#if APP_LOG_LEVEL >= APP_LOG_VERBOSE
+  const size_t maxDump = 128;
+  size_t n = len > maxDump ? maxDump : len;
+  for(size_t i=0;i<n;i+=16){
+    char line[16 * 3 + 1];
+    size_t k = 0;
+    for(size_t j=i;j<n && j<i+16;j++) k += snprintf(line + k, sizeof(line) - k, "%02X ", p[j]);
+    line[k] = '\0';
+    LOG_V("WS", "  %04u: %s", (unsigned)i, line);
+  }
+  if(len>maxDump) LOG_V("WS", "  ... (%u bytes mas)", (unsigned)(len-maxDump));
+#else
+  (void)p; (void)len;
+#endif
+}
+
+// Caja en x/y/w/h (o width/height) o en xmin/ymin/xmax/ymax; como float para
+// cubrir coordenadas normalizadas y en píxeles
+static bool parse_bbox(JsonObjectConst o, float &x, float &y, float &w, float &h) {
+  if (o.containsKey("x") && o.containsKey("y") && (o.containsKey("w")||o.containsKey("width")) && (o.containsKey("h")||o.containsKey("height"))) {
+    x = o["x"] | 0.0f;
+    y = o["y"] | 0.0f;
+    w = o.containsKey("w") ? (o["w"] | 0.0f) : (o["width"]  | 0.0f);
+    h = o.containsKey("h") ? (o["h"] | 0.0f) : (o["height"] | 0.0f);
+    return true;
+  }
+  if (o.containsKey("xmin") && o.containsKey("ymin") && o.containsKey("xmax") && o.containsKey("ymax")) {
+    float xmin = o["xmin"] | 0.0f;
+    float ymin = o["ymin"] | 0.0f;
+    float xmax = o["xmax"] | xmin;
+    float ymax = o["ymax"] | ymin;
+    x = xmin; y = ymin; w = xmax - xmin; h = ymax - ymin;
+    return true;
+  }
+  return false;
+}
+
+// Escala automática de cajas a 240x240, en gOut. `side`: lado del espacio en que
+// responde el servidor a ese frame (det_merge.h), o 0 si no se conoce.
+static int handle_detections(JsonArrayConst arr, uint16_t side) {
+  const int W = 240, H = 240;
+
+  const auto clampi = [](int v, int lo, int hi){ return v < lo ? lo : (v > hi ? hi : v); };
+
+  int n = arr.size();
+  if (n <= 0) return 0;                         // vacías: limpia overlays
+  if (n > WS_DRAW_MAX_DET) n = WS_DRAW_MAX_DET;   // ws_draw no pinta más
+  Deteccion* out = gOut;
+
+  // --- 1) Primera pasada: decidir si vienen normalizadas y, si no, estimar tamaño fuente ---
+  bool maybeNormalized = true;           // asumir 0..1 si no vemos valores > 1.2
+  float maxRight = 0.0f, maxBottom = 0.0f;
+
+  for (JsonVariantConst v : arr) {
+    float fx, fy, fw, fh;
+    if (!parse_bbox(v.as<JsonObjectConst>(), fx, fy, fw, fh)) continue;
+
+    if (fx > 1.2f || fy > 1.2f || fw > 1.2f || fh > 1.2f) maybeNormalized = false; // claro que son pixeles
+    maxRight  = maxRight  < (fx + fw) ? (fx + fw) : maxRight;
+    maxBottom = maxBottom < (fy + fh) ? (fy + fh) : maxBottom;
+  }
+
+  // Caso A: normalizadas → escala directa a 240x240
+  // Caso B: píxeles del espacio enviado (la vista en ROI, la imagen de uplink si no;
+  //         sin frame_id, la imagen de uplink actual) → escala fija
+  // Caso C: píxeles de otro espacio (p.ej. 1280x720) → calcula factor de escala por paquete
+  float sx = 1.0f, sy = 1.0f;
+  const float src = side ? side : frame_views_uplink_side();
+  if (maybeNormalized) {
+    sx = W; sy = H;
+  } else if (maxRight <= src * 1.05f && maxBottom <= src * 1.05f) {
+    sx = float(W) / src;
+    sy = float(H) / src;
+  } else {
+    // Evitar divisiones por cero y limitar factores razonables
+    if (maxRight  < 16.0f)  maxRight  = 16.0f;
+    if (maxBottom < 16.0f)  maxBottom = 16.0f;
+    sx = float(W) / maxRight;
+    sy = float(H) / maxBottom;
+    // Limita factores por seguridad (no deberían explotar)
+    if (sx < 0.05f) sx = 0.05f; if (sx > 20.0f) sx = 20.0f;
+    if (sy < 0.05f) sy = 0.05f; if (sy > 20.0f) sy = 20.0f;
+  }
+
+  // --- 2) Segunda pasada: escalar, clamp y poblar salida ---
+  int valid = 0;
+  for (int i = 0; i < n; ++i) {
+    JsonObjectConst o = arr[i];
+    float fx, fy, fw, fh;
+    if (!parse_bbox(o, fx, fy, fw, fh)) continue;
+
+    // Escala: si venían normalizadas (0..1), multiplicar por 240; si eran píxeles, multiplicar por sx/sy
+    int x = int((maybeNormalized ? fx * W : fx * sx) + 0.5f);
+    int y = int((maybeNormalized ? fy * H : fy * sy) + 0.5f);
+    int w = int((maybeNormalized ? fw * W : fw * sx) + 0.5f);
+    int h = int((maybeNormalized ? fh * H : fh * sy) + 0.5f);
+
+    // Clamp a 240x240 (después de escalar)
+    x = clampi(x, 0, W - 1);
+    y = clampi(y, 0, H - 1);
+    w = clampi(w, 1, W - x);
+    h = clampi(h, 1, H - y);
+
+    // Asigna en salida
+    out[valid].x = x; out[valid].y = y; out[valid].w = w; out[valid].h = h;
+
+    // Acepta "label" o "class"
+    if (o.containsKey("label"))        deteccion_set_label(out[valid], o["label"].as<const char*>());
+    else if (o.containsKey("class"))   deteccion_set_label(out[valid], o["class"].as<const char*>());
+    else                               deteccion_set_label(out[valid], "obj");
+
+    LOG_D("WS", "det[%d]: x=%d y=%d w=%d h=%d label=%s",
+          valid, x, y, w, h, out[valid].label);
+    valid++;
+  }
+  return valid;
+}
+
+
+// Mensaje binario (det_proto.h): escala src_w x src_h -> 240x240 en gOut, sin memoria dinámica
+static int handle_binary_detections(const det_proto_msg_t &msg) {
+  const int W = 240, H = 240;
+  const auto clampi = [](int v, int lo, int hi){ return v < lo ? lo : (v > hi ? hi : v); };
+
+  Deteccion* out = gOut;
+  int valid = 0;
+  for (int i = 0; i < msg.count; i++) {
+    const det_proto_box_t &b = msg.boxes[i];
+    int x = clampi((int)b.x * W / msg.src_w, 0, W - 1);
+    int y = clampi((int)b.y * H / msg.src_h, 0, H - 1);
+    int w = clampi(((int)b.w * W + msg.src_w / 2) / msg.src_w, 1, W - x);
+    int h = clampi(((int)b.h * H + msg.src_h / 2) / msg.src_h, 1, H - y);
+    out[valid].x = x; out[valid].y = y; out[valid].w = w; out[valid].h = h;
+    deteccion_set_label(out[valid], det_proto_class_name(b.class_id));
+    valid++;
+  }
+  return valid;
+}
+
+// ============ API ============
+// Formatos JSON aceptados: {"faces":[...]}, {"detections":[...]}, objeto único o array
+bool det_parse_json(const uint8_t* payload, size_t length) {
+  LOG_V("WS", "texto (%u bytes): %.*s", (unsigned)length, (int)length, (const char*)payload);
+
+  // Documento estático (sin heap por mensaje); solo lo usa la tarea de red
+  static StaticJsonDocument<DET_PARSE_DOC_BYTES> doc;
+  DeserializationError err = deserializeJson(doc, payload, length);
+  if (err) {
+    LOG_W("WS", "JSON error: %s", err.c_str());
+    hexdump(payload, length);
+    return false;                       // sin detecciones: no confirma nada ni toca overlays
+  }
+
+#if APP_LOG_LEVEL >= APP_LOG_VERBOSE
+  char pretty[APP_LOG_MSG_LEN];
+  serializeJson(doc, pretty, sizeof(pretty));
+  LOG_V("WS", "JSON: %s", pretty);
+#endif
+
+  if (doc.is<JsonObject>()) {
+    JsonObject root = doc.as<JsonObject>();
+
+    // comando de configuración del servidor (app_config.h)
+    if (app_config_command(root)) return false;
+
+    // confirmación adelantada de un frame (uplink_window.h), sin detecciones
+    if (root.containsKey("ack")) {
+      uplink_window_on_ack(root["ack"] | 0u, millis());
+      return false;
+    }
+
+    // eco de la cabecera de uplink (uplink_proto.h); también confirma el frame
+    uint32_t frameId = root["frame_id"] | 0u;
+    uint16_t side = det_merge_side(frameId);
+
+    // caso: raíz con array de detecciones
+    if (root.containsKey("faces") && root["faces"].is<JsonArray>()) {
+      return finish(frameId, handle_detections(root["faces"].as<JsonArrayConst>(), side));
+    }
+    if (root.containsKey("detections") && root["detections"].is<JsonArray>()) {
+      return finish(frameId, handle_detections(root["detections"].as<JsonArrayConst>(), side));
+    }
+
+    // caso: raíz es una detección única
+    if (root.containsKey("x") || root.containsKey("xmin")) {
+      static StaticJsonDocument<DET_PARSE_ONE_BYTES> tmp;
+      tmp.clear();
+      JsonArray arr = tmp.createNestedArray();
+      arr.add(root);
+      return finish(frameId, handle_detections(arr, side));
+    }
+
+    // caso: objeto vacío
+    LOG_D("WS", "objeto sin detecciones, limpio overlays");
+    return finish(frameId, 0);
+  }
+
+  if (doc.is<JsonArray>()) {
+    return finish(0, handle_detections(doc.as<JsonArrayConst>(), 0));   // sin frame_id: el más antiguo
+  }
+
+  LOG_W("WS", "formato no reconocido, limpio overlays");
+  publish(nullptr, 0, 0);
+  return false;                         // no confirma nada: no cuenta como respuesta
+}
+
+bool det_parse_binary(const uint8_t* payload, size_t length) {
+  det_proto_msg_t msg;
+  if (!det_proto_decode(payload, length, &msg)) {
+    LOG_W("WS", "binario de detecciones inválido (%u bytes)", (unsigned)length);
+    return false;
+  }
+  return finish(msg.frame_id, handle_binary_detections(msg));
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+// Parser/enrutado de detecciones del servidor, separado del socket: solo depende
+// de ArduinoJson, det_proto, det_merge, app_config, uplink_window y ws_draw_update_detecciones(), así que puede
+// compilarse contra sustitutos de Arduino/TFT para medirlo fuera de la placa.
+// Se llama desde la tarea de red.
+
+// WStype_TEXT: {"faces":[...]}, {"detections":[...]}, objeto único o array.
+// {"cmd":...} se pasa a app_config_command() y {"ack":id} a uplink_window; ambos
+// devuelven false (no traen detecciones), igual que un JSON inválido o un
+// formato no reconocido. Las detecciones también confirman su frame; las de un
+// frame ROI en varias partes (det_merge.h) solo con la última, y hasta entonces
+// devuelven false sin publicar.
+bool det_parse_json(const uint8_t* payload, size_t length);
+
+// WStype_BIN con cabecera det_proto. false si el mensaje no es válido o si es
+// una parte de un frame ROI que aún espera a las demás.
+bool det_parse_binary(const uint8_t* payload, size_t length);
@@ -0,0 +1,44 @@
+#include "det_proto.h"
+
+static const char* const kClassNames[] = { "obj", "face", "person" };
+
+static inline uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool det_proto_is_detection(const uint8_t* p, size_t len) {
+    return p && len >= DET_PROTO_HEADER_LEN &&
+           p[0] == DET_PROTO_MAGIC0 && p[1] == DET_PROTO_MAGIC1 &&
+           p[2] == DET_PROTO_VERSION;
+}
+
+bool det_proto_decode(const uint8_t* p, size_t len, det_proto_msg_t* out) {
+    if (!out || !det_proto_is_detection(p, len)) return false;
+
+    uint8_t count = p[3];
+    if (len < DET_PROTO_HEADER_LEN + (size_t)count * DET_PROTO_BOX_LEN) return false;
+
+    out->frame_id = rd32(p + 4);
+    out->src_w = rd16(p + 8);
+    out->src_h = rd16(p + 10);
+    if (!out->src_w || !out->src_h) return false;
+
+    out->count = count > DET_PROTO_MAX_BOXES ? DET_PROTO_MAX_BOXES : count;
+    const uint8_t* b = p + DET_PROTO_HEADER_LEN;
+    for (uint8_t i = 0; i < out->count; i++, b += DET_PROTO_BOX_LEN) {
+        det_proto_box_t &box = out->boxes[i];
+        box.x = rd16(b);
+        box.y = rd16(b + 2);
+        box.w = rd16(b + 4);
+        box.h = rd16(b + 6);
+        box.class_id = b[8];
+        box.score = b[9];
+    }
+    return true;
+}
+
+const char* det_proto_class_name(uint8_t id) {
+    const size_t n = sizeof(kClassNames) / sizeof(kClassNames[0]);
+    return id < n ? kClassNames[id] : kClassNames[0];
+}
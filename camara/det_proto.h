@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+
+// Mensaje binario de detecciones (servidor -> ESP32, WStype_BIN), little-endian:
+//   cabecera (12 bytes): 'D' 'T' | version u8 | count u8 | frame_id u32 | src_w u16 | src_h u16
+//   count x caja (10 bytes): x u16 | y u16 | w u16 | h u16 | class_id u8 | score u8
+// Coordenadas en píxeles del espacio src_w x src_h (el de la imagen que vio el servidor).
+// El ESP32 anuncia soporte con la cabecera HTTP "X-Det-Proto: 1" en el upgrade;
+// un servidor antiguo la ignora y sigue mandando JSON.
+#define DET_PROTO_MAGIC0     'D'
+#define DET_PROTO_MAGIC1     'T'
+#define DET_PROTO_VERSION    1
+#define DET_PROTO_HEADER_LEN 12
+#define DET_PROTO_BOX_LEN    10
+#define DET_PROTO_MAX_BOXES  10     // = WS_DRAW_MAX_DET
+
+struct det_proto_box_t {
+    uint16_t x, y, w, h;
+    uint8_t class_id;
+    uint8_t score;          // 0..255 -> 0..1
+};
+
+struct det_proto_msg_t {
+    uint32_t frame_id;
+    uint16_t src_w, src_h;
+    uint8_t count;          // cajas decodificadas (<= DET_PROTO_MAX_BOXES)
+    det_proto_box_t boxes[DET_PROTO_MAX_BOXES];
+};
+
+// ¿Empieza por la cabecera de detecciones? (magic + versión conocida)
+bool det_proto_is_detection(const uint8_t* p, size_t len);
+
+// Decodifica sin memoria dinámica. Las cajas de más de DET_PROTO_MAX_BOXES se ignoran.
+bool det_proto_decode(const uint8_t* p, size_t len, det_proto_msg_t* out);
+
+// Nombre para class_id (0 = "obj" por defecto)
+const char* det_proto_class_name(uint8_t id);
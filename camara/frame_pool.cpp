@@ -0,0 +1,109 @@
+#include "frame_pool.h"
+
+// ============ Estado ============
+static portMUX_TYPE poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+static frame_lease_t gSlots[FRAME_POOL_SLOTS];
+static int gCapacity = FRAME_POOL_SLOTS;    // fb_count del driver en marcha
+static uint32_t gSeq = 0;
+static frame_pool_stats_t gStats = {0, 0, 0, 0};
+
+static camera_fb_t* camera_source_get(void) { return esp_camera_fb_get(); }
+static void camera_source_ret(camera_fb_t* fb) { esp_camera_fb_return(fb); }
+
+static const frame_source_t cameraSource = { camera_source_get, camera_source_ret };
+static const frame_source_t* gSource = &cameraSource;
+
+// Busca un slot libre y lo reserva (refs = 1) para que nadie más lo tome
+static frame_lease_t* reserve_slot() {
+    frame_lease_t* slot = nullptr;
+    portENTER_CRITICAL(&poolMux);
+    for (int i = 0; i < gCapacity; i++) {
+        if (gSlots[i].refs == 0) {
+            slot = &gSlots[i];
+            slot->refs = 1;
+            slot->fb = nullptr;
+            break;
+        }
+    }
+    if (!slot) gStats.starved++;
+    portEXIT_CRITICAL(&poolMux);
+    return slot;
+}
+
+// ============ API ============
+void frame_pool_init(const frame_source_t* source) {
+    portENTER_CRITICAL(&poolMux);
+    gSource = source ? source : &cameraSource;
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) {
+        gSlots[i].fb = nullptr;
+        gSlots[i].seq = 0;
+        gSlots[i].refs = 0;
+    }
+    gSeq = 0;
+    gStats = {0, 0, 0, 0};
+    portEXIT_CRITICAL(&poolMux);
+}
+
+// Solo se cambia con el driver parado (sin leases vivos); uno por encima de la
+// capacidad nueva que siguiera vivo se suelta igual y ya no se reutiliza
+void frame_pool_set_capacity(int fb_count) {
+    if (fb_count < 1) fb_count = 1;
+    if (fb_count > FRAME_POOL_SLOTS) fb_count = FRAME_POOL_SLOTS;
+    portENTER_CRITICAL(&poolMux);
+    gCapacity = fb_count;
+    portEXIT_CRITICAL(&poolMux);
+}
+
+frame_lease_t* frame_pool_acquire() {
+    // Reservar slot ANTES de pedir el frame: si todos los buffers del driver
+    // están prestados, esp_camera_fb_get() se bloquearía hasta su timeout.
+    frame_lease_t* slot = reserve_slot();
+    if (!slot) return nullptr;
+
+    camera_fb_t* fb = gSource->get();   // fuera del lock: puede bloquear
+
+    portENTER_CRITICAL(&poolMux);
+    if (fb) {
+        slot->fb = fb;
+        slot->seq = ++gSeq;
+        gStats.acquired++;
+        gStats.outstanding++;
+    } else {
+        slot->refs = 0;
+    }
+    portEXIT_CRITICAL(&poolMux);
+
+    return fb ? slot : nullptr;
+}
+
+void frame_lease_retain(frame_lease_t* lease) {
+    if (!lease) return;
+    portENTER_CRITICAL(&poolMux);
+    lease->refs++;
+    portEXIT_CRITICAL(&poolMux);
+}
+
+void frame_lease_release(frame_lease_t* lease) {
+    if (!lease) return;
+    camera_fb_t* done = nullptr;
+
+    portENTER_CRITICAL(&poolMux);
+    if (lease->refs > 0 && --lease->refs == 0) {
+        done = lease->fb;
+        lease->fb = nullptr;
+        gStats.returned++;
+        gStats.outstanding--;
+    }
+    portEXIT_CRITICAL(&poolMux);
+
+    // Devolver al driver fuera de la sección crítica
+    if (done) gSource->ret(done);
+}
+
+void frame_pool_get_stats(frame_pool_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&poolMux);
+    *out = gStats;
+    portEXIT_CRITICAL(&poolMux);
+}
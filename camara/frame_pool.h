@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+
+// Número de buffers que se piden al driver (config.fb_count). Con 3 el sensor
+// llena uno mientras otro se envía y otro se dibuja / espera en la cola de uplink.
+#define FRAME_POOL_SLOTS 3
+
+// Lease con contador de referencias sobre un camera_fb_t del driver.
+// El frame vuelve al driver (esp_camera_fb_return) cuando se libera la última referencia.
+struct frame_lease_t {
+    camera_fb_t* fb;
+    uint32_t seq;       // número de frame (monótono)
+    int refs;           // protegido por el mux interno del pool
+};
+
+// Origen de frames. Por defecto esp_camera_fb_get/esp_camera_fb_return;
+// se puede sustituir por otro backend (p.ej. un mock) en frame_pool_init().
+struct frame_source_t {
+    camera_fb_t* (*get)(void);
+    void (*ret)(camera_fb_t* fb);
+};
+
+struct frame_pool_stats_t {
+    uint32_t acquired;     // frames obtenidos del driver
+    uint32_t returned;     // frames devueltos al driver
+    uint32_t starved;      // acquire() sin slot libre (consumidores lentos)
+    int outstanding;       // leases vivos ahora mismo (fijo en la capacidad = fuga)
+};
+
+// Inicializa el pool (source = nullptr -> driver de cámara)
+void frame_pool_init(const frame_source_t* source = nullptr);
+
+// Leases simultáneos como mucho: el fb_count con el que arrancó el driver
+// (1..FRAME_POOL_SLOTS). Con más que buffers tiene el driver, acquire() llegaría a
+// esp_camera_fb_get() sin buffer libre y se bloquearía hasta su timeout.
+void frame_pool_set_capacity(int fb_count);
+
+// Obtiene un frame nuevo con refs = 1. Devuelve nullptr si no hay slot libre
+// (todas las leases siguen en uso) o si el driver no entrega frame.
+frame_lease_t* frame_pool_acquire();
+
+// Añade una referencia (una por consumidor que vaya a usar el frame)
+void frame_lease_retain(frame_lease_t* lease);
+
+// Suelta una referencia; con la última el frame vuelve al driver
+void frame_lease_release(frame_lease_t* lease);
+
+void frame_pool_get_stats(frame_pool_stats_t* out);
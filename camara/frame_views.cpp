@@ -0,0 +1,52 @@
+#include "frame_views.h"
+#include "ws_draw.h"
+
+// ============ Estado ============
+static portMUX_TYPE viewMux = portMUX_INITIALIZER_UNLOCKED;
+
+static frame_view_t gView = { 0, 0, WS_DRAW_W, 0 };
+static uint8_t gUplinkShift = VIEW_UPLINK_SHIFT_DEFAULT;
+
+// ============ API ============
+void frame_view_of(int fw, int fh, frame_view_t* v) {
+    if (!v) return;
+    int minSide = fw < fh ? fw : fh;
+    uint8_t shift = 0;
+    while (shift < VIEW_MAX_SHIFT && (WS_DRAW_W << (shift + 1)) <= minSide) shift++;
+
+    int side = WS_DRAW_W << shift;
+    if (side > minSide) side = minSide;         // frame menor que el panel
+    v->side = (uint16_t)side;
+    v->x = (uint16_t)(((fw - side) / 2) & ~1);  // par: filas alineadas a 4 bytes
+    v->y = (uint16_t)((fh - side) / 2);
+    v->display_shift = shift;
+}
+
+void frame_views_set_capture(int fw, int fh) {
+    frame_view_t v;
+    frame_view_of(fw, fh, &v);
+    portENTER_CRITICAL(&viewMux);
+    gView = v;
+    portEXIT_CRITICAL(&viewMux);
+}
+
+void frame_views_get(frame_view_t* v) {
+    if (!v) return;
+    portENTER_CRITICAL(&viewMux);
+    *v = gView;
+    portEXIT_CRITICAL(&viewMux);
+}
+
+void frame_views_set_uplink_shift(uint8_t shift) {
+    gUplinkShift = shift > VIEW_MAX_SHIFT ? VIEW_MAX_SHIFT : shift;
+}
+
+uint8_t frame_views_uplink_shift() {
+    return gUplinkShift;
+}
+
+uint16_t frame_views_uplink_side() {
+    frame_view_t v;
+    frame_views_get(&v);
+    return v.side >> gUplinkShift;
+}
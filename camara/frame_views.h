@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+
+// Geometría entre el frame del sensor, el panel y el uplink. El sensor captura
+// a más resolución que el panel; de él se toma la "vista": el mayor cuadrado
+// centrado de lado WS_DRAW_W * 2^display_shift (1x, 2x o 4x) que cabe en el frame.
+//   - Panel: la vista reducida 2^display_shift -> exactamente WS_DRAW_W x WS_DRAW_H
+//   - Uplink: la vista reducida 2^uplink_shift (configurable)
+// Los tres espacios comparten campo de visión: las cajas se mapean solo escalando.
+#define VIEW_MAX_SHIFT            2     // hasta 4x (960x960 de vista)
+#define VIEW_UPLINK_SHIFT_DEFAULT 0     // uplink a la resolución completa de la vista
+
+struct frame_view_t {
+    uint16_t x, y;          // esquina de la vista en el frame
+    uint16_t side;          // lado de la vista en píxeles del sensor
+    uint8_t display_shift;  // vista -> panel
+};
+
+// Vista para un frame fw x fh (función pura; frames menores que el panel: shift 0)
+void frame_view_of(int fw, int fh, frame_view_t* v);
+
+// Resolución de captura actual (camera_init la fija) y su vista
+void frame_views_set_capture(int fw, int fh);
+void frame_views_get(frame_view_t* v);
+
+// Reducción vista -> uplink (0..VIEW_MAX_SHIFT)
+void frame_views_set_uplink_shift(uint8_t shift);
+uint8_t frame_views_uplink_shift();
+
+// Lado en píxeles de la imagen de uplink (espacio por defecto de las cajas del servidor)
+uint16_t frame_views_uplink_side();
@@ -0,0 +1,119 @@
+#include "jpeg_encoder.h"
+#include "img_converters.h"
+#include <esp_heap_caps.h>
+#include "app_log.h"
+
+// ============ Estado ============
+static portMUX_TYPE encMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t* gOut = nullptr;     // JPEG_HEADROOM_MAX + JPEG_OUT_MAX bytes en PSRAM
+static bool gEnabled = true;
+static int gQuality = JPEG_QUALITY_DEFAULT;
+static uint32_t gTarget = JPEG_TARGET_BYTES_DEFAULT;
+static jpeg_encoder_stats_t gStats = {};
+
+struct out_cursor_t {
+    uint8_t* buf;
+    size_t len;
+    bool overflow;
+};
+
+// El codificador procesa el RGB565 por franjas de MCU (8/16 líneas) y va
+// entregando la salida por aquí: no hace falta un segundo buffer de 115KB.
+static size_t jpg_out(void* arg, size_t index, const void* data, size_t len) {
+    out_cursor_t* c = (out_cursor_t*)arg;
+    if (index + len > JPEG_OUT_MAX) {
+        c->overflow = true;
+        return 0;                   // aborta la codificación
+    }
+    memcpy(c->buf + index, data, len);
+    c->len = index + len;
+    return len;
+}
+
+// Ajuste de calidad hacia gTarget: baja rápido si nos pasamos, sube despacio
+static int adapt_quality(int q, uint32_t bytes, uint32_t target) {
+    if (bytes > target + target / 8)      q -= (bytes > target * 2) ? 10 : 3;
+    else if (bytes < target - target / 4) q += 1;
+    if (q < JPEG_QUALITY_MIN) q = JPEG_QUALITY_MIN;
+    if (q > JPEG_QUALITY_MAX) q = JPEG_QUALITY_MAX;
+    return q;
+}
+
+// ============ API ============
+bool jpeg_encoder_init() {
+    if (gOut) return true;
+    gOut = (uint8_t*)heap_caps_malloc(JPEG_HEADROOM_MAX + JPEG_OUT_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!gOut) {
+        LOG_E("JPEG", "sin PSRAM para buffer de salida, uplink en RGB565");
+        gEnabled = false;
+        return false;
+    }
+    return true;
+}
+
+void jpeg_encoder_set_enabled(bool enabled) { gEnabled = enabled && gOut; }
+bool jpeg_encoder_enabled() { return gEnabled; }
+
+void jpeg_encoder_set_quality(int quality) {
+    if (quality < JPEG_QUALITY_MIN) quality = JPEG_QUALITY_MIN;
+    if (quality > JPEG_QUALITY_MAX) quality = JPEG_QUALITY_MAX;
+    portENTER_CRITICAL(&encMux);
+    gQuality = quality;
+    portEXIT_CRITICAL(&encMux);
+}
+
+void jpeg_encoder_set_target_bytes(uint32_t bytes) {
+    if (bytes < 1024) bytes = 1024;
+    if (bytes > JPEG_OUT_MAX) bytes = JPEG_OUT_MAX;
+    portENTER_CRITICAL(&encMux);
+    gTarget = bytes;
+    portEXIT_CRITICAL(&encMux);
+}
+
+bool jpeg_encoder_encode(const camera_fb_t* fb, size_t headroom, uint8_t** out, size_t* outLen) {
+    if (!fb || !out || !outLen || !gOut || headroom > JPEG_HEADROOM_MAX) return false;
+
+    portENTER_CRITICAL(&encMux);
+    int q = gQuality;
+    uint32_t target = gTarget;
+    portEXIT_CRITICAL(&encMux);
+
+    out_cursor_t cur = { gOut + headroom, 0, false };
+    uint32_t t0 = micros();
+    bool ok = fmt2jpg_cb(fb->buf, fb->len, fb->width, fb->height, fb->format,
+                         (uint8_t)q, jpg_out, &cur);
+    uint32_t dt = micros() - t0;
+
+    // Si no cabe, forzar la bajada de calidad como si fuera el doble del objetivo
+    uint32_t bytes = cur.overflow ? target * 2 + 1 : cur.len;
+    int nq = adapt_quality(q, bytes, target);
+
+    portENTER_CRITICAL(&encMux);
+    if (gQuality == q) gQuality = nq;   // respeta un set_quality() concurrente
+    gStats.last_encode_us = dt;
+    if (dt > gStats.max_encode_us) gStats.max_encode_us = dt;
+    if (ok && !cur.overflow) {
+        gStats.encoded++;
+        gStats.last_bytes = cur.len;
+        gStats.total_bytes += cur.len;
+        gStats.total_raw_bytes += fb->len;
+    } else {
+        gStats.overflow++;
+    }
+    portEXIT_CRITICAL(&encMux);
+
+    if (!ok || cur.overflow) return false;
+    *out = gOut;
+    *outLen = headroom + cur.len;
+    return true;
+}
+
+void jpeg_encoder_get_stats(jpeg_encoder_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&encMux);
+    *out = gStats;
+    out->quality = gQuality;
+    out->target_bytes = gTarget;
+    portEXIT_CRITICAL(&encMux);
+}
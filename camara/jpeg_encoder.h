@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+
+// Tamaño máximo de un JPEG de uplink (buffer de salida único, en PSRAM)
+#define JPEG_OUT_MAX        (48 * 1024)
+#define JPEG_HEADROOM_MAX   32      // bytes reservados delante para la cabecera de uplink
+
+// Rango y valores iniciales de calidad (escala 1..100 de img_converters)
+#define JPEG_QUALITY_MIN    10
+#define JPEG_QUALITY_MAX    90
+#define JPEG_QUALITY_DEFAULT 60
+#define JPEG_TARGET_BYTES_DEFAULT (12 * 1024)
+
+struct jpeg_encoder_stats_t {
+    uint32_t encoded;        // frames codificados
+    uint32_t overflow;       // superaron JPEG_OUT_MAX (frame descartado)
+    uint32_t last_bytes;
+    uint32_t last_encode_us;
+    uint32_t max_encode_us;
+    uint64_t total_bytes;    // media = total_bytes / encoded
+    uint64_t total_raw_bytes;// ratio = total_raw_bytes / total_bytes
+    int quality;             // calidad actual (ajustada en cada frame)
+    uint32_t target_bytes;
+};
+
+// Reserva el buffer de salida (una vez, en setup)
+bool jpeg_encoder_init();
+
+// Activa/desactiva la etapa (desactivada: se envía RGB565 crudo)
+void jpeg_encoder_set_enabled(bool enabled);
+bool jpeg_encoder_enabled();
+
+// Calidad fija inicial y objetivo de bytes/frame para el ajuste automático
+void jpeg_encoder_set_quality(int quality);
+void jpeg_encoder_set_target_bytes(uint32_t bytes);
+
+// Codifica fb a JPEG en el buffer interno dejando `headroom` bytes libres delante
+// (para la cabecera del mensaje). out/outLen cubren headroom + JPEG.
+// Devuelve false si falla o no cabe. Válido hasta la siguiente llamada (solo tarea de red).
+bool jpeg_encoder_encode(const camera_fb_t* fb, size_t headroom, uint8_t** out, size_t* outLen);
+
+void jpeg_encoder_get_stats(jpeg_encoder_stats_t* out);
@@ -0,0 +1,121 @@
+#include "latency_stats.h"
+#include <esp_timer.h>
+
+// ============ Estado ============
+static portMUX_TYPE latMux = portMUX_INITIALIZER_UNLOCKED;
+
+static latency_hist_t gHist[LAT_STAGES];
+
+// Frames enviados recientemente: seq -> captura / fin de envío
+struct sent_frame_t {
+    uint32_t seq;
+    int64_t capture_us;
+    int64_t sent_us;
+};
+static sent_frame_t gSent[LAT_TRACK_FRAMES];
+
+// Captura del frame cuyas detecciones esperan a ser pintadas (0 = ninguna)
+static int64_t gPendingOverlayCapture = 0;
+
+static const char* const kStageKeys[LAT_STAGES] = { "cap_send", "send_det", "cap_overlay" };
+
+static void record(latency_stage_t stage, int64_t dt_us) {
+    if (dt_us < 0) dt_us = 0;
+    uint32_t ms = (uint32_t)(dt_us / 1000);
+    int b = 0;
+    while (b < LAT_BUCKETS - 1 && ms >= (1u << b)) b++;
+
+    latency_hist_t &h = gHist[stage];
+    h.count++;
+    h.sum_ms += ms;
+    if (ms > h.max_ms) h.max_ms = ms;
+    h.buckets[b]++;
+}
+
+// ============ API ============
+void latency_init() {
+    portENTER_CRITICAL(&latMux);
+    memset(gHist, 0, sizeof(gHist));
+    memset(gSent, 0, sizeof(gSent));
+    gPendingOverlayCapture = 0;
+    portEXIT_CRITICAL(&latMux);
+}
+
+void latency_on_send(uint32_t seq, int64_t capture_us) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&latMux);
+    record(LAT_CAPTURE_TO_SEND, now - capture_us);
+    sent_frame_t &s = gSent[seq % LAT_TRACK_FRAMES];
+    s.seq = seq;
+    s.capture_us = capture_us;
+    s.sent_us = now;
+    portEXIT_CRITICAL(&latMux);
+}
+
+int64_t latency_on_detection(uint32_t seq) {
+    if (!seq) return 0;                     // servidor sin eco de frame_id
+    int64_t now = esp_timer_get_time();
+    int64_t capture = 0;
+    portENTER_CRITICAL(&latMux);
+    sent_frame_t &s = gSent[seq % LAT_TRACK_FRAMES];
+    if (s.seq == seq) {
+        record(LAT_SEND_TO_DETECTION, now - s.sent_us);
+        gPendingOverlayCapture = s.capture_us;
+        capture = s.capture_us;
+        s.seq = 0;                          // una respuesta por frame
+    }
+    portEXIT_CRITICAL(&latMux);
+    return capture;
+}
+
+void latency_on_overlay_drawn() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&latMux);
+    if (gPendingOverlayCapture) {
+        record(LAT_CAPTURE_TO_OVERLAY, now - gPendingOverlayCapture);
+        gPendingOverlayCapture = 0;
+    }
+    portEXIT_CRITICAL(&latMux);
+}
+
+void latency_get(latency_stage_t stage, latency_hist_t* out) {
+    if (!out || stage >= LAT_STAGES) return;
+    portENTER_CRITICAL(&latMux);
+    *out = gHist[stage];
+    portEXIT_CRITICAL(&latMux);
+}
+
+uint32_t latency_percentile_ms(const latency_hist_t &h, uint8_t pct) {
+    if (!h.count) return 0;
+    uint64_t target = ((uint64_t)h.count * pct + 99) / 100;
+    uint64_t acc = 0;
+    for (int b = 0; b < LAT_BUCKETS; b++) {
+        acc += h.buckets[b];
+        if (acc >= target) {
+            uint32_t upper = 1u << b;
+            return upper < h.max_ms ? upper : h.max_ms;
+        }
+    }
+    return h.max_ms;
+}
+
+size_t latency_format_summary(char* buf, size_t len) {
+    if (!buf || !len) return 0;
+    latency_hist_t h[LAT_STAGES];
+    portENTER_CRITICAL(&latMux);
+    memcpy(h, gHist, sizeof(h));
+    portEXIT_CRITICAL(&latMux);
+
+    size_t n = snprintf(buf, len, "{\"lat\":{");
+    for (int s = 0; s < LAT_STAGES && n < len; s++) {
+        n += snprintf(buf + n, len - n, "%s\"%s\":[%u,%u,%u,%u,%u]",
+                      s ? "," : "", kStageKeys[s],
+                      (unsigned)h[s].count,
+                      (unsigned)latency_percentile_ms(h[s], 50),
+                      (unsigned)latency_percentile_ms(h[s], 90),
+                      (unsigned)latency_percentile_ms(h[s], 99),
+                      (unsigned)h[s].max_ms);
+    }
+    if (n < len) n += snprintf(buf + n, len - n, "}}");
+    return n < len ? n : len - 1;
+}
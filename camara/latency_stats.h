@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+
+// Histogramas de latencia extremo a extremo por etapa (cubos log2 en ms:
+// [0,1) [1,2) [2,4) ... [1024,2048) [2048,inf))
+#define LAT_BUCKETS      13
+#define LAT_TRACK_FRAMES 16         // frames enviados recordados para casar respuestas
+#define LAT_REPORT_MS    10000      // periodo del resumen (Serial + socket)
+
+enum latency_stage_t {
+    LAT_CAPTURE_TO_SEND = 0,        // captura -> fin de sendBIN
+    LAT_SEND_TO_DETECTION,          // fin de sendBIN -> llegan sus detecciones
+    LAT_CAPTURE_TO_OVERLAY,         // captura -> primer frame pintado con sus cajas
+    LAT_STAGES
+};
+
+struct latency_hist_t {
+    uint32_t count;
+    uint32_t max_ms;
+    uint64_t sum_ms;
+    uint32_t buckets[LAT_BUCKETS];
+};
+
+void latency_init();
+
+// Tarea de red
+void latency_on_send(uint32_t seq, int64_t capture_us);
+// Devuelve la captura (esp_timer, us) del frame respondido, o 0 si no se conoce
+int64_t latency_on_detection(uint32_t seq);
+
+// Loop de dibujo: tras pintar un frame con overlays
+void latency_on_overlay_drawn();
+
+void latency_get(latency_stage_t stage, latency_hist_t* out);
+
+// Percentil aproximado (límite superior del cubo) en ms
+uint32_t latency_percentile_ms(const latency_hist_t &h, uint8_t pct);
+
+// Resumen compacto en JSON: {"lat":{"cap_send":[n,p50,p90,p99,max],...}}
+size_t latency_format_summary(char* buf, size_t len);
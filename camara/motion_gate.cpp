@@ -0,0 +1,166 @@
+#include "motion_gate.h"
+#include "pixel_kernels.h"
+#include "app_log.h"
+
+// ============ Estado ============
+static portMUX_TYPE motionMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t gThumb[2][MOTION_THUMB_MAX];   // [actual, anterior] alternando
+static int gCur = 0;
+static int gThumbLen = 0;                     // 0 = sin referencia todavía
+static int gThumbBlock = 0;
+static uint32_t gLastSentMs = 0;
+
+static bool gEnabled = true;
+static uint8_t gCellDelta = MOTION_CELL_DELTA;
+static uint16_t gAreaPermille = MOTION_AREA_PERMILLE;
+static uint32_t gKeepaliveMs = MOTION_KEEPALIVE_MS;
+static motion_gate_stats_t gStats = {};
+
+// ============ Kernels ============
+int motion_block_for(int w, int h) {
+    for (int block = MOTION_BLOCK; block <= MOTION_BLOCK_MAX; block <<= 1) {
+        const int tw = w / block, th = h / block;
+        if (tw <= MOTION_THUMB_W_MAX && tw * th <= MOTION_THUMB_MAX) return block;
+    }
+    return 0;
+}
+
+void motion_thumb_ref(const uint8_t* rgb565, int w, int h, int block, uint8_t* thumb) {
+    const int tw = w / block, th = h / block;
+    for (int by = 0; by < th; by++) {
+        for (int bx = 0; bx < tw; bx++) {
+            uint32_t sr = 0, sg = 0, sb = 0;
+            for (int y = 0; y < block; y++) {
+                const uint8_t* p = rgb565 + ((by * block + y) * w + bx * block) * 2;
+                for (int x = 0; x < block; x++, p += 2) {
+                    uint16_t px = (uint16_t)((p[0] << 8) | p[1]);   // big-endian
+                    sr += px >> 11;
+                    sg += (px >> 5) & 0x3F;
+                    sb += px & 0x1F;
+                }
+            }
+            thumb[by * tw + bx] = px_luma_sum(sr, sg, sb, block * block);
+        }
+    }
+}
+
+// Dos píxeles por carga de 32 bits (bytes a0 a1 b0 b1 en little-endian) y
+// acumulación de canales por columna de bloques, fila a fila (acceso secuencial a PSRAM).
+void motion_thumb(const uint8_t* rgb565, int w, int h, int block, uint8_t* thumb) {
+    const int tw = w / block, th = h / block;
+    if (tw > MOTION_THUMB_W_MAX || (w & 1) || (block & 1) || ((uintptr_t)rgb565 & 3)) {
+        motion_thumb_ref(rgb565, w, h, block, thumb);
+        return;
+    }
+
+    static uint32_t sr[MOTION_THUMB_W_MAX], sg[MOTION_THUMB_W_MAX], sb[MOTION_THUMB_W_MAX];
+    for (int by = 0; by < th; by++) {
+        memset(sr, 0, tw * sizeof(uint32_t));
+        memset(sg, 0, tw * sizeof(uint32_t));
+        memset(sb, 0, tw * sizeof(uint32_t));
+        for (int y = 0; y < block; y++) {
+            const uint32_t* row = (const uint32_t*)(rgb565 + (by * block + y) * w * 2);
+            for (int bx = 0; bx < tw; bx++) {
+                uint32_t r = 0, g = 0, b = 0;
+                for (int k = 0; k < block / 2; k++) {
+                    uint32_t v = *row++;
+                    r += ((v >> 3) & 0x1F) + ((v >> 19) & 0x1F);
+                    g += (((v & 0x07) << 3) | ((v >> 13) & 0x07)) + (((v >> 13) & 0x38) | (v >> 29));
+                    b += ((v >> 8) & 0x1F) + ((v >> 24) & 0x1F);
+                }
+                sr[bx] += r; sg[bx] += g; sb[bx] += b;
+            }
+        }
+        for (int bx = 0; bx < tw; bx++) {
+            thumb[by * tw + bx] = px_luma_sum(sr[bx], sg[bx], sb[bx], block * block);
+        }
+    }
+}
+
+// ============ API ============
+void motion_gate_set_enabled(bool enabled) {
+    portENTER_CRITICAL(&motionMux);
+    gEnabled = enabled;
+    portEXIT_CRITICAL(&motionMux);
+}
+
+void motion_gate_set_params(uint8_t cellDelta, uint16_t areaPermille, uint32_t keepaliveMs) {
+    portENTER_CRITICAL(&motionMux);
+    gCellDelta = cellDelta;
+    gAreaPermille = areaPermille;
+    gKeepaliveMs = keepaliveMs;
+    portEXIT_CRITICAL(&motionMux);
+}
+
+bool motion_gate_should_send(const camera_fb_t* fb) {
+    if (!fb) return false;
+
+    portENTER_CRITICAL(&motionMux);
+    bool enabled = gEnabled;
+    uint8_t cellDelta = gCellDelta;
+    uint16_t areaPermille = gAreaPermille;
+    uint32_t keepaliveMs = gKeepaliveMs;
+    portEXIT_CRITICAL(&motionMux);
+
+    if (!enabled) return true;
+    const int block = fb->format == PIXFORMAT_RGB565 ? motion_block_for(fb->width, fb->height) : 0;
+    const int cells = block ? (fb->width / block) * (fb->height / block) : 0;
+    if (cells <= 0) {
+        // No se puede evaluar: se envía, se cuenta y se avisa una vez
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            LOG_W("MOTION", "frame %dx%d formato %d sin miniatura: se envía siempre",
+                  (int)fb->width, (int)fb->height, (int)fb->format);
+        }
+        portENTER_CRITICAL(&motionMux);
+        gStats.frames++;
+        gStats.sent++;
+        gStats.passthrough++;
+        portEXIT_CRITICAL(&motionMux);
+        return true;
+    }
+
+    uint32_t t0 = micros();
+    uint8_t* cur = gThumb[gCur];
+    const uint8_t* prev = gThumb[gCur ^ 1];
+    motion_thumb(fb->buf, fb->width, fb->height, block, cur);
+
+    int changed = cells;                      // sin referencia (o cambió el bloque): cuenta como movimiento
+    if (gThumbLen == cells && gThumbBlock == block) {
+        changed = 0;
+        for (int i = 0; i < cells; i++) {
+            int d = (int)cur[i] - (int)prev[i];
+            if (d > cellDelta || -d > cellDelta) changed++;
+        }
+    }
+    gThumbLen = cells;
+    gThumbBlock = block;
+    gCur ^= 1;
+
+    uint16_t permille = (uint16_t)(changed * 1000 / cells);
+    uint32_t now = millis();
+    bool motion = permille >= areaPermille;
+    bool keepalive = !motion && (now - gLastSentMs >= keepaliveMs);
+    bool send = motion || keepalive;
+    if (send) gLastSentMs = now;
+
+    portENTER_CRITICAL(&motionMux);
+    gStats.frames++;
+    if (send) gStats.sent++; else gStats.skipped++;
+    if (keepalive) gStats.keepalives++;
+    gStats.last_permille = permille;
+    gStats.block = (uint8_t)block;
+    gStats.last_us = micros() - t0;
+    portEXIT_CRITICAL(&motionMux);
+
+    return send;
+}
+
+void motion_gate_get_stats(motion_gate_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&motionMux);
+    *out = gStats;
+    portEXIT_CRITICAL(&motionMux);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+
+// Miniatura de luma por bloques de block x block píxeles: MOTION_BLOCK hasta
+// 640x480; en frames mayores el bloque se duplica hasta que la miniatura cabe
+// (UXGA: 32 px, 50x37 celdas), así que todo tamaño de captura se evalúa
+#define MOTION_BLOCK          8
+#define MOTION_BLOCK_MAX      64
+#define MOTION_THUMB_W_MAX    80
+#define MOTION_THUMB_MAX      (MOTION_THUMB_W_MAX * 60)
+
+// Valores por defecto (ajustables en ejecución)
+#define MOTION_CELL_DELTA     12            // cambio de luma (0..255) para contar una celda
+#define MOTION_AREA_PERMILLE  5             // celdas cambiadas (por mil) para considerar movimiento
+#define MOTION_KEEPALIVE_MS   2000          // envía al menos un frame cada 2 s aunque esté quieto
+
+struct motion_gate_stats_t {
+    uint32_t frames;            // frames evaluados
+    uint32_t sent;              // con movimiento o keep-alive
+    uint32_t skipped;           // estáticos, no enviados
+    uint32_t keepalives;
+    uint32_t passthrough;       // enviados sin evaluar (no RGB565 o sin bloque válido)
+    uint16_t last_permille;     // celdas cambiadas en el último frame
+    uint8_t block;              // lado del bloque del último frame evaluado
+    uint32_t last_us;           // coste de miniatura + comparación
+};
+
+void motion_gate_set_enabled(bool enabled);
+void motion_gate_set_params(uint8_t cellDelta, uint16_t areaPermille, uint32_t keepaliveMs);
+
+// Decide si el frame se sube al servidor (actualiza la miniatura de referencia).
+// Formatos distintos de RGB565 siempre se envían.
+bool motion_gate_should_send(const camera_fb_t* fb);
+
+void motion_gate_get_stats(motion_gate_stats_t* out);
+
+// Lado de bloque para un frame w x h (0 si ni MOTION_BLOCK_MAX cabe)
+int motion_block_for(int w, int h);
+
+// Kernels: miniatura (w/block x h/block) desde RGB565 big-endian; block par.
+// motion_thumb_ref es la referencia escalar; motion_thumb debe dar el mismo resultado bit a bit.
+void motion_thumb_ref(const uint8_t* rgb565, int w, int h, int block, uint8_t* thumb);
+void motion_thumb(const uint8_t* rgb565, int w, int h, int block, uint8_t* thumb);
@@ -0,0 +1,74 @@
+#include "overlay.h"
+#include "font5x7.h"
+
+// Misma geometría que drawDetections(): clamp al frame y etiqueta 10 px encima
+static bool box_geometry(const Deteccion &d, int width, int height,
+                         int &x, int &y, int &w, int &h, int &ty) {
+    x = d.x; y = d.y; w = d.w; h = d.h;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x + w > width)  w = width - x;
+    if (y + h > height) h = height - y;
+    ty = (y > 10 ? y - 10 : y);
+    return w > 0 && h > 0;
+}
+
+static const uint8_t* glyph(char ch) {
+    uint8_t c = (uint8_t)ch;
+    if (c < FONT5X7_FIRST || c > FONT5X7_LAST) c = '?';
+    return font5x7[c - FONT5X7_FIRST];
+}
+
+void overlay_draw_band(uint16_t* band, int width, int height, int bandY, int rows,
+                       const Deteccion* dets, int n, uint16_t color) {
+    if (!band || !dets || n <= 0) return;
+    const int y0 = bandY, y1 = bandY + rows;          // [y0, y1)
+    const uint16_t c = (uint16_t)((color >> 8) | (color << 8));  // orden del panel
+
+    for (int i = 0; i < n; i++) {
+        int x, y, w, h, ty;
+        if (!box_geometry(dets[i], width, height, x, y, w, h, ty)) continue;
+
+        // Rectángulo: filas completas arriba/abajo, columnas sueltas en medio
+        const int top = y, bottom = y + h - 1, left = x, right = x + w - 1;
+        const int rs = top > y0 ? top : y0;
+        const int re = bottom < y1 - 1 ? bottom : y1 - 1;
+        for (int r = rs; r <= re; r++) {
+            uint16_t* row = band + (r - y0) * width;
+            if (r == top || r == bottom) {
+                for (int px = left; px <= right; px++) row[px] = c;
+            } else {
+                row[left] = c;
+                row[right] = c;
+            }
+        }
+
+        // Etiqueta (fondo transparente, como tft.print con setTextColor(fg))
+        if (ty + FONT5X7_CELL_H <= y0 || ty >= y1) continue;
+        const char* label = dets[i].label;
+        for (int tx = x; *label && tx < width; label++, tx += FONT5X7_CELL_W) {
+            const uint8_t* g = glyph(*label);
+            for (int col = 0; col < 5 && tx + col < width; col++) {
+                uint8_t bits = g[col];
+                for (int bit = 0; bits; bit++, bits >>= 1) {
+                    int r = ty + bit;
+                    if ((bits & 1) && r >= y0 && r < y1) band[(r - y0) * width + tx + col] = c;
+                }
+            }
+        }
+    }
+}
+
+uint32_t overlay_legacy_pixels(const Deteccion* dets, int n, int width, int height) {
+    uint32_t px = 0;
+    for (int i = 0; dets && i < n; i++) {
+        int x, y, w, h, ty;
+        if (!box_geometry(dets[i], width, height, x, y, w, h, ty)) continue;
+        px += 2 * w + 2 * h;                            // 4 líneas de drawRect
+        for (const char* p = dets[i].label; *p; p++) {
+            const uint8_t* g = glyph(*p);
+            for (int col = 0; col < 5; col++) px += __builtin_popcount(g[col]);
+        }
+    }
+    return px;
+}
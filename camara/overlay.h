@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+#include "ws_draw.h"
+
+// Compone cajas y etiquetas de detección sobre una banda RGB565 (orden de bytes
+// del panel, igual que el frame de la cámara) antes de mandarla al bus.
+// bandY/rows: posición de la banda dentro del frame width x height.
+void overlay_draw_band(uint16_t* band, int width, int height, int bandY, int rows,
+                       const Deteccion* dets, int n, uint16_t color);
+
+// Píxeles que la ruta antigua (drawRect + print encima del frame) volvería a
+// enviar por el bus para estas detecciones
+uint32_t overlay_legacy_pixels(const Deteccion* dets, int n, int width, int height);
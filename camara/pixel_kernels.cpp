@@ -0,0 +1,199 @@
+#include "pixel_kernels.h"
+#include "app_log.h"
+#include <esp_heap_caps.h>
+
+// ============ Helpers ============
+// Campos de un píxel (valor de 16 bits) separados con huecos para sumar varios
+// píxeles en una palabra: g en bits 21..26, r en 11..15, b en 0..4. Caben 16
+// sumandos sin desbordar un campo en el siguiente.
+#define PX_SPREAD_MASK 0x07E0F81Fu
+
+static inline uint32_t spread(uint32_t px) {
+    return (px | (px << 16)) & PX_SPREAD_MASK;
+}
+
+static inline uint16_t unspread(uint32_t s) {
+    return (uint16_t)((s & 0xF81F) | ((s >> 16) & 0x07E0));
+}
+
+// Palabra de 2 píxeles big-endian leída en little-endian -> 2 valores de 16 bits
+static inline uint32_t swap_pair(uint32_t v) {
+    return ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+}
+
+static inline uint16_t load_be(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void store_be(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline bool aligned4(const void* p) {
+    return ((uintptr_t)p & 3) == 0;
+}
+
+// Luma*256 repartida por bytes: byte alto = rrrrrggg, byte bajo = gggbbbbb
+static uint16_t gLumaHi[256], gLumaLo[256];
+static bool gLumaReady = false;
+
+// ============ Inicialización ============
+void px_kernels_init() {
+    for (int v = 0; v < 256; v++) {
+        uint32_t r = v >> 3, gHi = (v & 7) << 3;
+        uint32_t gLo = v >> 5, b = v & 0x1F;
+        gLumaHi[v] = (uint16_t)(77 * (r << 3) + 150 * (gHi << 2));
+        gLumaLo[v] = (uint16_t)(150 * (gLo << 2) + 29 * (b << 3));
+    }
+    gLumaReady = true;
+}
+
+// ============ Byte-swap ============
+void px_swap16_ref(const uint8_t* src, uint8_t* dst, size_t npix) {
+    for (size_t i = 0; i < npix; i++) {
+        uint8_t a = src[2 * i], b = src[2 * i + 1];
+        dst[2 * i] = b;
+        dst[2 * i + 1] = a;
+    }
+}
+
+void px_swap16(const uint8_t* src, uint8_t* dst, size_t npix) {
+    if (!aligned4(src) || !aligned4(dst)) {
+        px_swap16_ref(src, dst, npix);
+        return;
+    }
+    const uint32_t* s = (const uint32_t*)src;
+    uint32_t* d = (uint32_t*)dst;
+    size_t pairs = npix / 2;
+    size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {           // 8 píxeles por vuelta
+        uint32_t a = s[i], b = s[i + 1], c = s[i + 2], e = s[i + 3];
+        d[i] = swap_pair(a);
+        d[i + 1] = swap_pair(b);
+        d[i + 2] = swap_pair(c);
+        d[i + 3] = swap_pair(e);
+    }
+    for (; i < pairs; i++) d[i] = swap_pair(s[i]);
+    if (npix & 1) px_swap16_ref(src + pairs * 4, dst + pairs * 4, 1);
+}
+
+// ============ Reducción 2x / 4x ============
+void px_downscale_ref(const uint8_t* src, int srcStride, int outW, int outH, int factor, uint8_t* dst) {
+    const uint32_t n = (uint32_t)(factor * factor);
+    for (int oy = 0; oy < outH; oy++) {
+        for (int ox = 0; ox < outW; ox++) {
+            uint32_t sr = 0, sg = 0, sb = 0;
+            for (int y = 0; y < factor; y++) {
+                const uint8_t* p = src + ((oy * factor + y) * srcStride + ox * factor) * 2;
+                for (int x = 0; x < factor; x++, p += 2) {
+                    uint16_t px = load_be(p);
+                    sr += px >> 11;
+                    sg += (px >> 5) & 0x3F;
+                    sb += px & 0x1F;
+                }
+            }
+            uint16_t out = (uint16_t)(((sr / n) << 11) | ((sg / n) << 5) | (sb / n));
+            store_be(dst + (oy * outW + ox) * 2, out);
+        }
+    }
+}
+
+// Suma de campos separados (spread) y un único desplazamiento por la potencia de
+// dos: el resto de cada campo cae en el hueco bajo él y lo quita la máscara.
+void px_downscale(const uint8_t* src, int srcStride, int outW, int outH, int factor, uint8_t* dst) {
+    if ((factor != 2 && factor != 4) || !aligned4(src) || (srcStride & 1)) {
+        px_downscale_ref(src, srcStride, outW, outH, factor, dst);
+        return;
+    }
+    const int shift = factor == 2 ? 2 : 4;
+    const int words = factor / 2;               // palabras de 32 bits por fila y salida
+    const int strideWords = srcStride / 2;
+
+    uint8_t* d = dst;
+    for (int oy = 0; oy < outH; oy++) {
+        const uint32_t* rows = (const uint32_t*)src + oy * factor * strideWords;
+        for (int ox = 0; ox < outW; ox++) {
+            uint32_t acc = 0;
+            const uint32_t* r = rows + ox * words;
+            for (int y = 0; y < factor; y++, r += strideWords) {
+                for (int k = 0; k < words; k++) {
+                    uint32_t s = swap_pair(r[k]);
+                    acc += spread(s & 0xFFFF) + spread(s >> 16);
+                }
+            }
+            store_be(d, unspread((acc >> shift) & PX_SPREAD_MASK));
+            d += 2;
+        }
+    }
+}
+
+// ============ Luma ============
+void px_luma_ref(const uint8_t* src, uint8_t* dst, size_t npix) {
+    for (size_t i = 0; i < npix; i++) {
+        uint16_t px = load_be(src + 2 * i);
+        dst[i] = px_luma_sum(px >> 11, (px >> 5) & 0x3F, px & 0x1F, 1);
+    }
+}
+
+// Dos consultas de tabla por píxel (luma lineal en los dos bytes) en lugar de
+// separar canales y multiplicar; máximo 255*256 + 255 < 65536, sin saturación.
+void px_luma(const uint8_t* src, uint8_t* dst, size_t npix) {
+    if (!gLumaReady || !aligned4(src)) {
+        px_luma_ref(src, dst, npix);
+        return;
+    }
+    const uint32_t* s = (const uint32_t*)src;
+    size_t pairs = npix / 2;
+    for (size_t i = 0; i < pairs; i++) {
+        uint32_t v = s[i];
+        dst[2 * i]     = (uint8_t)((gLumaHi[v & 0xFF] + gLumaLo[(v >> 8) & 0xFF]) >> 8);
+        dst[2 * i + 1] = (uint8_t)((gLumaHi[(v >> 16) & 0xFF] + gLumaLo[v >> 24]) >> 8);
+    }
+    if (npix & 1) px_luma_ref(src + pairs * 4, dst + pairs * 2, 1);
+}
+
+// ============ Autocomprobación / banco ============
+bool px_kernels_selftest(int w, int h) {
+    const size_t npix = (size_t)w * h;
+    uint8_t* src = (uint8_t*)heap_caps_malloc(npix * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    uint8_t* a = (uint8_t*)heap_caps_malloc(npix * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    uint8_t* b = (uint8_t*)heap_caps_malloc(npix * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!src || !a || !b) {
+        if (src) heap_caps_free(src);
+        if (a) heap_caps_free(a);
+        if (b) heap_caps_free(b);
+        LOG_W("PX", "selftest: sin memoria");
+        return false;
+    }
+    if (!gLumaReady) px_kernels_init();
+
+    uint32_t x = 0x12345678;                    // xorshift: cubre todos los valores de canal
+    for (size_t i = 0; i < npix * 2; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        src[i] = (uint8_t)x;
+    }
+
+    bool ok = true;
+    uint32_t c0, ref, fast;
+#define PX_BENCH(name, nout, refCall, fastCall, outLen)                           \
+    c0 = ESP.getCycleCount(); refCall;  ref = ESP.getCycleCount() - c0;          \
+    c0 = ESP.getCycleCount(); fastCall; fast = ESP.getCycleCount() - c0;         \
+    if (memcmp(a, b, outLen) != 0) { ok = false; LOG_E("PX", "%s difiere", name); } \
+    LOG_I("PX", "%s: ref %u.%02u ciclos/px, rápida %u.%02u ciclos/px", name,    \
+          (unsigned)(ref / (nout)), (unsigned)(ref * 100 / (nout) % 100),        \
+          (unsigned)(fast / (nout)), (unsigned)(fast * 100 / (nout) % 100))
+
+    PX_BENCH("swap16", npix, px_swap16_ref(src, a, npix), px_swap16(src, b, npix), npix * 2);
+    PX_BENCH("luma", npix, px_luma_ref(src, a, npix), px_luma(src, b, npix), npix);
+    PX_BENCH("down2x", npix, px_downscale_ref(src, w, w / 2, h / 2, 2, a),
+             px_downscale(src, w, w / 2, h / 2, 2, b), (size_t)(w / 2) * (h / 2) * 2);
+    PX_BENCH("down4x", npix, px_downscale_ref(src, w, w / 4, h / 4, 4, a),
+             px_downscale(src, w, w / 4, h / 4, 4, b), (size_t)(w / 4) * (h / 4) * 2);
+#undef PX_BENCH
+
+    heap_caps_free(src);
+    heap_caps_free(a);
+    heap_caps_free(b);
+    return ok;
+}
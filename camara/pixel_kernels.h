@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+
+// Kernels de píxel sobre RGB565 en el orden de bytes de la cámara (big-endian:
+// byte alto primero). Cada uno tiene una versión escalar de referencia (_ref) y
+// una rápida (palabras de 32 bits / tablas) que coincide bit a bit con ella; la
+// rápida cae a la referencia si el buffer no está alineado a 4 bytes.
+#define PX_KERNELS_BENCH 0      // 1: autocomprobación + ciclos/píxel al arrancar (Serial)
+
+// Luma BT.601 (0..255) de la media de npix píxeles a partir de las sumas de
+// canales RGB565 (la luma es lineal: media de lumas = luma de la media)
+static inline uint8_t px_luma_sum(uint32_t sr5, uint32_t sg6, uint32_t sb5, uint32_t npix) {
+    uint32_t y = 77 * (sr5 << 3) + 150 * (sg6 << 2) + 29 * (sb5 << 3);
+    y /= npix * 256;
+    return y > 255 ? 255 : (uint8_t)y;
+}
+
+// Tablas de px_luma (1 KB en SRAM). Llamar una vez antes de usar px_luma.
+void px_kernels_init();
+
+// Intercambio de bytes de cada píxel (big <-> little endian). dst puede ser src.
+void px_swap16_ref(const uint8_t* src, uint8_t* dst, size_t npix);
+void px_swap16(const uint8_t* src, uint8_t* dst, size_t npix);
+
+// Reducción factor x factor (2 o 4) con media por canal (trunca). src apunta a la
+// esquina de la región; srcStride en píxeles; dst es out_w x out_h contiguo.
+void px_downscale_ref(const uint8_t* src, int srcStride, int outW, int outH, int factor, uint8_t* dst);
+void px_downscale(const uint8_t* src, int srcStride, int outW, int outH, int factor, uint8_t* dst);
+
+// RGB565 -> luma de 8 bits por píxel
+void px_luma_ref(const uint8_t* src, uint8_t* dst, size_t npix);
+void px_luma(const uint8_t* src, uint8_t* dst, size_t npix);
+
+// Compara rápida vs referencia sobre un frame w x h de prueba y saca ciclos/píxel
+// por Serial. Devuelve false si alguna versión rápida difiere.
+bool px_kernels_selftest(int w, int h);
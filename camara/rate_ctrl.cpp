@@ -0,0 +1,257 @@
+#include "rate_ctrl.h"
+#include "jpeg_encoder.h"
+#include "frame_views.h"
+#include "uplink_window.h"
+
+// ============ Estado ============
+static portMUX_TYPE rcMux = portMUX_INITIALIZER_UNLOCKED;
+
+static rate_ctrl_state_t gState = {};
+
+// Acumuladores del periodo actual
+static uint64_t gSendSum = 0;
+static uint32_t gSendCount = 0;
+static uint32_t gDetSum = 0;
+static uint32_t gDetCount = 0;
+static uint32_t gDrops = 0;
+static uint32_t gInflight = 0;
+
+// Instantes de envío de los frames sin respuesta, del más antiguo al más nuevo.
+// El servidor responde en orden: cada detección cierra el más antiguo (det_ms por frame).
+#define RC_SENT_MAX        8
+#define RC_SENT_TIMEOUT_MS 3000     // sin respuesta: no cuenta (como UPLINK_ACK_TIMEOUT_MS)
+static uint32_t gSentMs[RC_SENT_MAX];
+static uint8_t gSentHead = 0;
+static uint32_t gPingMs = 0;
+static uint32_t gLastUpdateMs = 0;
+static uint32_t gFloorMs = 0;      // tope de fps (app_config)
+static uint8_t gShiftFloor = VIEW_UPLINK_SHIFT_DEFAULT;
+
+static uint32_t ewma(uint32_t prev, uint32_t sample) {
+    return prev ? (prev * 3 + sample) / 4 : sample;
+}
+
+static uint32_t clampu(uint32_t v, uint32_t lo, uint32_t hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// ============ Ley de control ============
+// Cola por retardo: det_ms muy por encima de su mínimo reciente
+static bool det_queued(uint32_t detMs, rate_ctrl_state_t* st) {
+    if (!detMs) return false;
+    uint32_t base = st->det_base_ms ? st->det_base_ms + RC_DET_BASE_DRIFT_MS : detMs;
+    if (detMs < base) base = detMs;
+    st->det_base_ms = base;
+    uint32_t margin = base / 2 > RC_DET_QUEUE_MS ? base / 2 : RC_DET_QUEUE_MS;
+    return detMs > base + margin;
+}
+
+// Reduce la vista si con bytes/frame mínimos sendBIN sigue ocupando medio periodo o
+// más; la amplía tras un rato con bytes/frame al máximo, el enlace medio libre y sin
+// cola (el objetivo se divide entre 4, como los píxeles). La cola sola (servidor
+// lento) no cambia la resolución.
+static void step_shift(bool linkBusy, bool queued, uint32_t &bytes, rate_ctrl_state_t* st) {
+    if (!st->up_hold) st->up_hold = RC_SHIFT_UP_HOLD;
+    if (st->uplink_shift < st->shift_floor) st->uplink_shift = st->shift_floor;
+
+    if (linkBusy && bytes <= RC_BYTES_MIN && st->uplink_shift < VIEW_MAX_SHIFT) {
+        if (++st->shift_hold < RC_SHIFT_DOWN_HOLD) return;
+        st->uplink_shift++;
+        if (st->last_up && st->updates - st->last_up < 2u * st->up_hold) {
+            st->up_hold = st->up_hold * 2 > RC_SHIFT_UP_HOLD_MAX ? RC_SHIFT_UP_HOLD_MAX : st->up_hold * 2;
+        }
+    } else if (!linkBusy && !queued && bytes >= RC_BYTES_MAX && st->uplink_shift > st->shift_floor) {
+        if (++st->shift_hold < st->up_hold) return;
+        st->uplink_shift--;
+        st->last_up = st->updates;
+        bytes /= 4;
+    } else {
+        st->shift_hold = 0;
+        return;
+    }
+    st->shift_hold = 0;
+    st->shift_changes++;
+    st->send_us = 0;            // la media de sendBIN era de la otra resolución
+}
+
+// - Backlog (ventana de uplink llena o descartes): frena multiplicativo (x1.25)
+//   y baja bytes/frame un 20%.
+// - Enlace saturado (sendBIN ocupa >80% del periodo): periodo = envío / 0.8.
+// - Detecciones con retardo de cola (det_ms > base + margen) sin enlace saturado: el cuello
+//   es el servidor; frena suave (x1.125) sin tocar bytes/frame.
+// - Si no: acelera (-2 ms - 1/32 del periodo: sube fps casi linealmente) y, si sendBIN ocupa menos de medio periodo, sube
+//   bytes/frame (+512): con un enlace justo se prefieren más frames a más calidad.
+// - Resolución de uplink: step_shift().
+void rate_ctrl_step(const rate_ctrl_input_t* in, rate_ctrl_state_t* st) {
+    if (in->send_us) st->send_us = ewma(st->send_us, in->send_us);   // 0: sin envíos en el periodo
+    if (in->det_ms) st->det_ms = ewma(st->det_ms, in->det_ms);
+    st->inflight = in->inflight;
+    st->updates++;
+
+    uint32_t interval = st->interval_ms;
+    uint32_t bytes = st->target_bytes;
+    uint32_t sendMs = st->send_us / 1000;
+    bool queued = det_queued(in->det_ms, st);
+
+    bool windowFull = in->window && in->inflight >= in->window;
+    if (windowFull || in->drops > 0) {
+        interval = interval + interval / 4 + 1;
+        bytes = bytes - bytes / 5;
+        st->backoffs++;
+    } else if (sendMs * 10 > interval * 8) {
+        interval = sendMs * 10 / 8 + 1;
+        bytes = bytes - bytes / 10;
+        st->backoffs++;
+    } else if (queued) {
+        interval = interval + interval / 8 + 1;
+        st->backoffs++;
+        st->queued++;
+    } else {
+        interval -= interval > 2 ? 2 + interval / 32 : 0;
+        if (sendMs * 2 < interval) bytes += 512;    // calidad solo con el enlace medio libre
+        st->probes++;
+    }
+
+    bytes = clampu(bytes, RC_BYTES_MIN, RC_BYTES_MAX);
+    step_shift(sendMs * 2 >= interval, queued, bytes, st);
+    st->interval_ms = clampu(interval, RC_INTERVAL_MIN_MS, RC_INTERVAL_MAX_MS);
+    st->target_bytes = clampu(bytes, RC_BYTES_MIN, RC_BYTES_MAX);
+}
+
+// ============ API ============
+void rate_ctrl_init() {
+    portENTER_CRITICAL(&rcMux);
+    gState = {};
+    gState.interval_ms = RC_INTERVAL_INIT_MS;
+    gState.target_bytes = JPEG_TARGET_BYTES_DEFAULT;
+    gState.uplink_shift = gShiftFloor;
+    gState.shift_floor = gShiftFloor;
+    gSendSum = 0; gSendCount = 0; gDetSum = 0; gDetCount = 0;
+    gDrops = 0; gInflight = 0; gSentHead = 0; gPingMs = 0;
+    gLastUpdateMs = millis();
+    portEXIT_CRITICAL(&rcMux);
+    jpeg_encoder_set_target_bytes(gState.target_bytes);
+    frame_views_set_uplink_shift(gShiftFloor);
+}
+
+void rate_ctrl_on_send(uint32_t send_us) {
+    portENTER_CRITICAL(&rcMux);
+    gSendSum += send_us;
+    gSendCount++;
+    if (gInflight == RC_SENT_MAX) {     // el más antiguo ya no se mide
+        gSentHead = (gSentHead + 1) % RC_SENT_MAX;
+        gInflight--;
+    }
+    gSentMs[(gSentHead + gInflight) % RC_SENT_MAX] = millis();
+    gInflight++;
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_on_drop() {
+    portENTER_CRITICAL(&rcMux);
+    gDrops++;
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_on_detections() {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&rcMux);
+    while (gInflight) {
+        uint32_t age = now - gSentMs[gSentHead];
+        gSentHead = (gSentHead + 1) % RC_SENT_MAX;
+        gInflight--;
+        if (age < RC_SENT_TIMEOUT_MS) {
+            gDetSum += age;
+            gDetCount++;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_on_ping_sent() {
+    portENTER_CRITICAL(&rcMux);
+    gPingMs = millis();
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_on_pong() {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&rcMux);
+    if (gPingMs) {
+        gState.rtt_ms = now - gPingMs;
+        gPingMs = 0;               // solo el primer pong tras nuestro ping
+    }
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_on_disconnect() {
+    portENTER_CRITICAL(&rcMux);
+    gInflight = 0;                 // las respuestas pendientes ya no llegarán
+    gSentHead = 0;
+    gPingMs = 0;
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_update() {
+    uint32_t now = millis();
+    if (now - gLastUpdateMs < RC_UPDATE_MS) return;
+
+    uplink_window_stats_t w;
+    uplink_window_get_stats(&w);
+
+    rate_ctrl_input_t in;
+    in.window   = w.size;
+    portENTER_CRITICAL(&rcMux);
+    gLastUpdateMs = now;
+    in.send_us  = gSendCount ? (uint32_t)(gSendSum / gSendCount) : 0;
+    in.det_ms   = gDetCount ? gDetSum / gDetCount : 0;
+    in.inflight = gInflight;
+    in.drops    = gDrops;
+    gSendSum = 0; gSendCount = 0; gDetSum = 0; gDetCount = 0; gDrops = 0;
+    uint8_t shift = gState.uplink_shift;
+    rate_ctrl_step(&in, &gState);
+    uint32_t bytes = gState.target_bytes;
+    bool reshift = gState.uplink_shift != shift;
+    shift = gState.uplink_shift;
+    portEXIT_CRITICAL(&rcMux);
+
+    jpeg_encoder_set_target_bytes(bytes);
+    if (reshift) frame_views_set_uplink_shift(shift);
+}
+
+void rate_ctrl_set_max_fps(uint32_t fps) {
+    portENTER_CRITICAL(&rcMux);
+    gFloorMs = fps ? 1000 / fps : 0;
+    portEXIT_CRITICAL(&rcMux);
+}
+
+void rate_ctrl_set_uplink_shift(uint8_t shift) {
+    if (shift > VIEW_MAX_SHIFT) shift = VIEW_MAX_SHIFT;
+    portENTER_CRITICAL(&rcMux);
+    if (shift != gShiftFloor || gState.uplink_shift < shift) {
+        gState.uplink_shift = shift;    // pedido explícito: se parte de él
+        gState.shift_hold = 0;
+    }
+    gShiftFloor = shift;
+    gState.shift_floor = shift;
+    shift = gState.uplink_shift;
+    portEXIT_CRITICAL(&rcMux);
+    frame_views_set_uplink_shift(shift);
+}
+
+// El lazo sigue midiendo sin tope; el suelo solo limita lo que usa la cámara
+uint32_t rate_ctrl_interval_ms() {
+    portENTER_CRITICAL(&rcMux);
+    uint32_t v = gState.interval_ms;
+    if (v < gFloorMs) v = gFloorMs;
+    portEXIT_CRITICAL(&rcMux);
+    return v;
+}
+
+void rate_ctrl_get_state(rate_ctrl_state_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&rcMux);
+    *out = gState;
+    portEXIT_CRITICAL(&rcMux);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+
+// Límites del periodo de captura y del objetivo de bytes/frame del uplink
+#define RC_INTERVAL_MIN_MS   40     // ~25 FPS
+#define RC_INTERVAL_MAX_MS   1000
+#define RC_INTERVAL_INIT_MS  66     // ~15 FPS (el antiguo frameDelay)
+#define RC_BYTES_MIN         (4 * 1024)
+#define RC_BYTES_MAX         (32 * 1024)
+#define RC_UPDATE_MS         250    // periodo del lazo de control
+
+// Retardo de las detecciones: det_ms por encima de su mínimo reciente (base) es cola
+// en el servidor o en el enlace aunque no haya descartes
+#define RC_DET_QUEUE_MS      100    // margen mínimo sobre la base (también base / 2)
+#define RC_DET_BASE_DRIFT_MS 1      // la base sube 1 ms por periodo: olvida mínimos viejos
+
+// Resolución de uplink (frame_views uplink_shift): con bytes/frame ya en el mínimo y
+// congestión se reduce la vista a la mitad; con bytes en el máximo y sin congestión se
+// vuelve a ampliar. Un afinado que hay que deshacer enseguida duplica su espera.
+#define RC_SHIFT_DOWN_HOLD   4      // periodos seguidos (1 s) antes de reducir
+#define RC_SHIFT_UP_HOLD     40     // periodos seguidos (10 s) antes de ampliar
+#define RC_SHIFT_UP_HOLD_MAX 1200   // hasta 5 min si el enlace no la sostiene
+
+// Medidas agregadas de un periodo de control (entrada de la ley de control)
+struct rate_ctrl_input_t {
+    uint32_t send_us;       // duración media de sendBIN (0: sin envíos)
+    uint32_t det_ms;        // envío -> detecciones del mismo frame (media; 0: sin respuestas)
+    uint32_t inflight;      // frames enviados aún sin respuesta del servidor
+    uint32_t window;        // tamaño de la ventana de uplink: inflight >= window frena (0 = sin ventana)
+    uint32_t drops;         // descartes de la cola de uplink en el periodo
+};
+
+// Estado del controlador (se expone tal cual como contadores)
+struct rate_ctrl_state_t {
+    uint32_t interval_ms;   // periodo de captura actual
+    uint32_t target_bytes;  // objetivo de JPEG por frame
+    uint32_t send_us;       // última entrada vista (EWMA)
+    uint32_t det_ms;        // EWMA envío -> detección
+    uint32_t det_base_ms;   // mínimo reciente de det_ms (sin cola)
+    uint32_t rtt_ms;        // RTT ping/pong del WebSocket
+    uint32_t inflight;
+    uint32_t backoffs;      // veces que el lazo frenó
+    uint32_t probes;        // veces que el lazo aceleró
+    uint32_t queued;        // periodos frenados por retardo de detección
+    uint32_t updates;
+    uint8_t uplink_shift;   // reducción vista -> uplink elegida por el lazo
+    uint8_t shift_floor;    // la de app_config: el lazo no afina más allá
+    uint16_t shift_hold;    // periodos seguidos en el límite de bytes/frame
+    uint16_t up_hold;       // espera actual para ampliar (RC_SHIFT_UP_HOLD..MAX)
+    uint32_t last_up;       // `updates` del último afinado
+    uint32_t shift_changes;
+};
+
+// Ley de control pura (sin hardware): ajusta interval_ms/target_bytes con AIMD
+// y uplink_shift con histéresis
+void rate_ctrl_step(const rate_ctrl_input_t* in, rate_ctrl_state_t* st);
+
+void rate_ctrl_init();
+
+// Medidas (tarea de red)
+void rate_ctrl_on_send(uint32_t send_us);
+void rate_ctrl_on_drop();
+void rate_ctrl_on_detections();
+void rate_ctrl_on_ping_sent();
+void rate_ctrl_on_pong();
+void rate_ctrl_on_disconnect();
+
+// Aplica la ley cada RC_UPDATE_MS (tarea de red)
+void rate_ctrl_update();
+
+// Tope de fps fijado por configuración (0 = sin tope): suelo del periodo
+void rate_ctrl_set_max_fps(uint32_t fps);
+
+// uplink_shift de configuración: el lazo arranca en él (si cambia) y solo reduce desde ahí
+void rate_ctrl_set_uplink_shift(uint8_t shift);
+
+// Periodo de captura a usar (tarea de cámara)
+uint32_t rate_ctrl_interval_ms();
+
+void rate_ctrl_get_state(rate_ctrl_state_t* out);
@@ -0,0 +1,177 @@
+#include "roi_uplink.h"
+#include "ws_draw.h"
+#include "pixel_kernels.h"
+#include "frame_views.h"
+#include <esp_heap_caps.h>
+
+// ============ Estado ============
+static uint8_t* gStage = nullptr;
+static size_t gStageLen = 0;
+static bool gEnabled = false;               // el servidor debe entender UPLINK_FLAG_ROI
+static uint32_t gLastFullMs = 0;
+
+static int align_down(int v) { return v - v % ROI_ALIGN; }
+static int align_up(int v)   { return align_down(v + ROI_ALIGN - 1); }
+
+// Caja del panel (WS_DRAW_W x WS_DRAW_H) -> región con margen en coordenadas de la vista
+static bool box_to_region(const Deteccion &d, int side, uplink_roi_t &r) {
+    int mx = d.w * ROI_MARGIN_PCT / 100, my = d.h * ROI_MARGIN_PCT / 100;
+    int x0 = (d.x - mx) * side / WS_DRAW_W;
+    int y0 = (d.y - my) * side / WS_DRAW_H;
+    int x1 = (d.x + d.w + mx) * side / WS_DRAW_W;
+    int y1 = (d.y + d.h + my) * side / WS_DRAW_H;
+
+    x0 = align_down(x0 < 0 ? 0 : x0);
+    y0 = align_down(y0 < 0 ? 0 : y0);
+    x1 = align_up(x1);
+    y1 = align_up(y1);
+    if (x1 > side) x1 = side;
+    if (y1 > side) y1 = side;
+    if (x1 - x0 < ROI_ALIGN || y1 - y0 < ROI_ALIGN) return false;
+
+    r.x = x0; r.y = y0; r.w = x1 - x0; r.h = y1 - y0;
+    return true;
+}
+
+// Reducción mínima para que la región quepa en el límite de recorte
+static uint8_t fit_shift(int w, int h) {
+    uint8_t s = 0;
+    while (s < 3 && (size_t)(w >> s) * (h >> s) * 2 > ROI_CROP_MAX_BYTES) s++;
+    return s;
+}
+
+static roi_msg_t region_msg(bool roi, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t shift) {
+    roi_msg_t m;
+    m.roi = roi;
+    m.shift = shift;
+    m.rect = { x, y, w, h, (uint16_t)(w >> shift), (uint16_t)(h >> shift), 0, 1, 0 };
+    m.reply_side = m.rect.out_w;    // sin bloque ROI: píxeles de la imagen enviada
+    return m;
+}
+
+// ============ API ============
+// Cabe la vista completa sin reducir (modo normal con frame_views_uplink_shift = 0)
+bool roi_uplink_init() {
+    frame_view_t v;
+    frame_views_get(&v);
+    size_t need = (size_t)v.side * v.side * 2;
+    if (need < ROI_CROP_MAX_BYTES) need = ROI_CROP_MAX_BYTES;
+    if (gStage && gStageLen >= need) return true;
+
+    // Vista mayor tras un cambio de framesize (sin concesiones vivas: nadie usa el staging)
+    if (gStage) heap_caps_free(gStage);
+    gStage = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    gStageLen = gStage ? need : 0;
+    return gStage != nullptr;
+}
+
+void roi_uplink_set_enabled(bool enabled) { gEnabled = enabled && gStage; }
+bool roi_uplink_enabled() { return gEnabled; }
+
+int roi_uplink_plan(const camera_fb_t* fb, roi_msg_t* out, int max) {
+    if (!fb || !out || max <= 0) return 0;
+
+    frame_view_t v;
+    frame_view_of(fb->width, fb->height, &v);
+    const roi_msg_t plain = region_msg(false, 0, 0, v.side, v.side, frame_views_uplink_shift());
+
+    Deteccion dets[WS_DRAW_MAX_DET];
+    int n = gEnabled && fb->format == PIXFORMAT_RGB565 ? ws_draw_get_detecciones(dets) : 0;
+    if (n <= 0) {
+        out[0] = plain;
+        return 1;
+    }
+
+    // Las cajas más grandes primero (hasta ROI_MAX_CROPS)
+    for (int i = 1; i < n; i++) {
+        for (int j = i; j > 0 && dets[j].w * dets[j].h > dets[j - 1].w * dets[j - 1].h; j--) {
+            Deteccion t = dets[j]; dets[j] = dets[j - 1]; dets[j - 1] = t;
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < n && count < ROI_MAX_CROPS && count < max; i++) {
+        uplink_roi_t r;
+        if (!box_to_region(dets[i], v.side, r)) continue;
+        out[count++] = region_msg(true, r.x, r.y, r.w, r.h, fit_shift(r.w, r.h));
+    }
+
+    if (count == 0) {                       // cajas demasiado pequeñas: imagen normal
+        out[0] = plain;
+        return 1;
+    }
+
+    uint32_t now = millis();
+    if (count < max && now - gLastFullMs >= ROI_FULL_PERIOD_MS) {
+        uint8_t shift = fit_shift(v.side, v.side);
+        if (shift == 0) shift = 1;          // descubrimiento: siempre a baja resolución
+        out[count++] = region_msg(true, 0, 0, v.side, v.side, shift);
+        gLastFullMs = now;
+    }
+    for (int i = 0; i < count; i++) {       // mismo seq: el servidor sabe cuántas respuestas esperan
+        out[i].rect.part = (uint8_t)i;
+        out[i].rect.parts = (uint8_t)count;
+        out[i].rect.side = v.side;
+        out[i].reply_side = v.side;         // respuestas en coordenadas de la vista
+    }
+    return count;
+}
+
+bool roi_uplink_extract(const camera_fb_t* fb, const roi_msg_t &m, camera_fb_t* view, uint16_t* stride) {
+    if (!fb || !view || !stride) return false;
+    frame_view_t v;
+    frame_view_of(fb->width, fb->height, &v);
+    const int step = 1 << m.shift;
+    const int ow = m.rect.out_w, oh = m.rect.out_h;
+
+    // JPEG del sensor: se envía el propio fb
+    if (fb->format != PIXFORMAT_RGB565) {
+        *view = *fb;
+        *stride = fb->width;
+        return true;
+    }
+
+    const uint8_t* region = fb->buf + ((size_t)(v.y + m.rect.y) * fb->width + v.x + m.rect.x) * 2;
+    // Sin reducción: filas de la región dentro del fb (la vista a shift 0 o un recorte), sin copia
+    if (step == 1) {
+        *view = *fb;
+        view->buf = (uint8_t*)region;
+        view->len = (size_t)ow * oh * 2;
+        view->width = ow;
+        view->height = oh;
+        *stride = fb->width;
+        return true;
+    }
+    if (!gStage || (size_t)ow * oh * 2 > gStageLen) return false;
+
+    if (step == 2 || step == 4) {
+        px_downscale(region, fb->width, ow, oh, step, gStage);   // media por caja
+    } else {
+        // Reducciones mayores: submuestreo (solo para descubrir objetos)
+        const uint16_t* src = (const uint16_t*)region;
+        uint16_t* dst = (uint16_t*)gStage;
+        for (int y = 0; y < oh; y++) {
+            const uint16_t* row = src + y * step * fb->width;
+            for (int x = 0; x < ow; x++) dst[y * ow + x] = row[x * step];
+        }
+    }
+
+    *view = *fb;
+    view->buf = gStage;
+    view->len = ow * oh * 2;
+    view->width = ow;
+    view->height = oh;
+    *stride = ow;
+    return true;
+}
+
+bool roi_uplink_pack(camera_fb_t* view, uint16_t stride) {
+    if (!view) return false;
+    if (stride == view->width) return true;
+    if (!gStage || view->len > gStageLen) return false;
+    for (size_t y = 0; y < view->height; y++) {
+        memcpy(gStage + y * view->width * 2, view->buf + y * stride * 2, view->width * 2);
+    }
+    view->buf = gStage;
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+#include "uplink_proto.h"
+
+// Modo de uplink por regiones de interés: con detecciones recientes se envían
+// recortes a resolución completa alrededor de cada caja y, cada
+// ROI_FULL_PERIOD_MS, la vista completa reducida para descubrir objetos nuevos.
+// Sin detecciones se envía la imagen normal de uplink (vista a frame_views_uplink_shift).
+// Todas las regiones van en coordenadas de la vista (frame_views.h).
+#define ROI_MAX_CROPS       3
+#define ROI_MAX_MSGS        (ROI_MAX_CROPS + 1)
+#define ROI_MARGIN_PCT      25      // margen alrededor de cada caja
+#define ROI_ALIGN           16      // recortes alineados a MCU de JPEG
+#define ROI_FULL_PERIOD_MS  1000
+#define ROI_CROP_MAX_BYTES  (160 * 160 * 2)   // recorte mayor que esto se reduce
+
+// Un mensaje planificado para un frame
+struct roi_msg_t {
+    bool roi;               // false: vista completa sin bloque ROI (modo normal)
+    uplink_roi_t rect;      // región (coordenadas de la vista), tamaño de salida y parte
+    uint8_t shift;          // reducción 2^shift
+    uint16_t reply_side;    // espacio de las respuestas: la vista (ROI) o la imagen enviada
+};
+
+// Reserva el buffer de staging (PSRAM; tras camera_init para conocer la vista).
+// Tras camera_reconfigure solo se vuelve a reservar si la vista creció.
+bool roi_uplink_init();
+
+void roi_uplink_set_enabled(bool enabled);
+bool roi_uplink_enabled();
+
+// Decide qué mensajes generar para este frame a partir de las últimas detecciones.
+// Todos comparten el seq del frame; rect.part/parts los numera.
+int roi_uplink_plan(const camera_fb_t* fb, roi_msg_t* out, int max);
+
+// Imagen de un mensaje. Sin reducción (shift 0) la vista apunta a las filas de la
+// región dentro del propio fb, sin copia, y *stride es el paso entre filas en
+// píxeles (fb->width); reducida, va al staging con stride == width. La vista
+// vale mientras el lease siga retenido o hasta la siguiente llamada (solo tarea de red).
+bool roi_uplink_extract(const camera_fb_t* fb, const roi_msg_t &m, camera_fb_t* view, uint16_t* stride);
+
+// Compacta en el staging una vista con stride != width, para quien necesita
+// filas contiguas (fmt2jpg_cb). No hace nada si ya son contiguas.
+bool roi_uplink_pack(camera_fb_t* view, uint16_t stride);
@@ -0,0 +1,100 @@
+#include "task_config.h"
+#include "telemetry.h"
+#include "app_log.h"
+
+// ============ Tabla ============
+// Prioridades: la cámara casi siempre está bloqueada en esp_camera_fb_get y debe
+// repartir el frame en cuanto llega (por encima del dibujo); la red, por encima
+// del log pero por debajo de lwIP (18) y WiFi (23) en su mismo núcleo.
+static const app_task_cfg_t kTasks[TASK_COUNT] = {
+    { "loopTask_camera", "camera", 8192, 3, APP_CPU_NUM },
+    { "loopTask",        "loop",   8192, 2, APP_CPU_NUM },   // pila y núcleo: los fija el core
+    { "loopTask_net",    "net",    8192, 5, PRO_CPU_NUM },
+    { "loopTask_log",    "log",    4096, 1, PRO_CPU_NUM },
+};
+
+// ============ API ============
+const app_task_cfg_t* task_config_get(app_task_id_t id) {
+    return id < TASK_COUNT ? &kTasks[id] : nullptr;
+}
+
+bool task_config_create(app_task_id_t id, TaskFunction_t fn, void* arg, TaskHandle_t* out) {
+    const app_task_cfg_t* c = task_config_get(id);
+    if (!c || !fn) return false;
+    TaskHandle_t h = nullptr;
+    if (xTaskCreatePinnedToCore(fn, c->name, c->stack, arg, c->priority, &h, c->core) != pdPASS) {
+        LOG_E("TASK", "no se pudo crear %s", c->name);
+        return false;
+    }
+    if (out) *out = h;
+    telemetry_register_task(c->short_name, h);
+    return true;
+}
+
+void task_config_apply_current(app_task_id_t id) {
+    const app_task_cfg_t* c = task_config_get(id);
+    if (!c) return;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    vTaskPrioritySet(self, c->priority);
+    if (c->core != tskNO_AFFINITY && xPortGetCoreID() != c->core) {
+        LOG_W("TASK", "%s corre en el núcleo %d (tabla: %d)", c->name, (int)xPortGetCoreID(), (int)c->core);
+    }
+    telemetry_register_task(c->short_name, self);
+}
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+// Contadores del informe anterior para sacar el % del periodo (no desde el arranque)
+struct task_sample_t { TaskHandle_t handle; uint32_t runtime; };
+static task_sample_t gPrev[TASK_STATS_MAX];
+static int gPrevCount = 0;
+static uint32_t gPrevTotal = 0;
+
+static uint32_t prev_runtime(TaskHandle_t h) {
+    for (int i = 0; i < gPrevCount; i++) {
+        if (gPrev[i].handle == h) return gPrev[i].runtime;
+    }
+    return 0;
+}
+#endif
+
+// % de un núcleo: el contador total es tiempo de pared, cada tarea corre en uno
+void task_stats_report() {
+    static uint32_t lastReport = 0;
+    if (millis() - lastReport < TASK_STATS_REPORT_MS) return;
+    lastReport = millis();
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    static TaskStatus_t st[TASK_STATS_MAX];
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(st, TASK_STATS_MAX, &total);
+    if (n == 0) {
+        LOG_W("TASK", "más de %d tareas: sube TASK_STATS_MAX", TASK_STATS_MAX);
+        return;
+    }
+
+    uint32_t dt = total - gPrevTotal;
+    if (gPrevTotal && dt) {
+        for (UBaseType_t i = 0; i < n; i++) {
+            uint32_t run = st[i].ulRunTimeCounter - prev_runtime(st[i].xHandle);
+            uint32_t permille = (uint32_t)((uint64_t)run * 1000 / dt);
+            if (permille == 0) continue;
+            BaseType_t core = xTaskGetAffinity(st[i].xHandle);
+            LOG_I("TASK", "%-16s core %c prio %2u cpu %3u.%u%% pila %u B",
+                  st[i].pcTaskName, core == tskNO_AFFINITY ? '*' : (char)('0' + core),
+                  (unsigned)st[i].uxCurrentPriority,
+                  (unsigned)(permille / 10), (unsigned)(permille % 10),
+                  (unsigned)st[i].usStackHighWaterMark);
+        }
+    }
+
+    gPrevCount = (int)n;
+    for (UBaseType_t i = 0; i < n; i++) gPrev[i] = { st[i].xHandle, st[i].ulRunTimeCounter };
+    gPrevTotal = total;
+#else
+    static bool warned = false;
+    if (!warned) {
+        warned = true;
+        LOG_W("TASK", "sin run-time stats: activa CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS");
+    }
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/task.h>
+
+// Topología de tareas: núcleo, prioridad y pila de cada tarea en una sola tabla
+// (task_config.cpp). En el S3 el stack WiFi/lwIP vive en el núcleo 0
+// (PRO_CPU_NUM, prioridades 18-23) y el loop de Arduino en el 1 (APP_CPU_NUM).
+//   - Captura y dibujo: núcleo 1, lejos de las interrupciones/tareas de WiFi
+//   - Red (codificación JPEG + envío) y log: núcleo 0, junto al stack WiFi y por
+//     debajo de él, para no retrasar ACKs ni el heartbeat
+enum app_task_id_t {
+    TASK_CAMERA = 0,    // loopTask_camera: captura + reparto de leases
+    TASK_LOOP,          // loop() de Arduino: dibujo en el panel
+    TASK_NET,           // loopTask_net: codificación + WebSocket
+    TASK_LOG,           // loopTask_log: vaciado del log a Serial
+    TASK_COUNT
+};
+
+struct app_task_cfg_t {
+    const char* name;       // nombre FreeRTOS
+    const char* short_name; // telemetría / informe (<= 8 caracteres)
+    uint32_t stack;         // bytes
+    UBaseType_t priority;
+    BaseType_t core;        // PRO_CPU_NUM, APP_CPU_NUM o tskNO_AFFINITY
+};
+
+#define TASK_STATS_REPORT_MS 10000  // periodo del informe de CPU por tarea
+#define TASK_STATS_MAX       24     // tareas del sistema consideradas en el informe
+
+const app_task_cfg_t* task_config_get(app_task_id_t id);
+
+// Crea la tarea según la tabla y la registra en la telemetría
+bool task_config_create(app_task_id_t id, TaskFunction_t fn, void* arg, TaskHandle_t* out);
+
+// Para tareas que ya existen (la loop task de Arduino): aplica prioridad y registra.
+// El núcleo lo fija el core (CONFIG_ARDUINO_RUNNING_CORE); solo se comprueba.
+void task_config_apply_current(app_task_id_t id);
+
+// Informe de CPU por tarea (FreeRTOS run-time stats) cada TASK_STATS_REPORT_MS.
+// Requiere CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS y USE_TRACE_FACILITY en sdkconfig;
+// sin ellas avisa una vez y no hace nada.
+void task_stats_report();
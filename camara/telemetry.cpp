@@ -0,0 +1,109 @@
+#include "telemetry.h"
+#include "frame_pool.h"
+#include "websocket_client.h"
+#include "ws_draw.h"
+#include <esp_heap_caps.h>
+
+// ============ Estado ============
+struct tracked_task_t { const char* name; TaskHandle_t handle; };
+struct tracked_queue_t { const char* name; QueueHandle_t handle; };
+
+static portMUX_TYPE telMux = portMUX_INITIALIZER_UNLOCKED;
+static tracked_task_t gTasks[TELEMETRY_MAX_TASKS];
+static tracked_queue_t gQueues[TELEMETRY_MAX_QUEUES];
+static int gTaskCount = 0;
+static int gQueueCount = 0;
+static uint32_t gLastSent = 0;
+
+static uint8_t* wr32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint8_t* wr_name(uint8_t* p, const char* name) {
+    memset(p, 0, TELEMETRY_NAME_LEN);
+    if (name) strncpy((char*)p, name, TELEMETRY_NAME_LEN);
+    return p + TELEMETRY_NAME_LEN;
+}
+
+// ============ API ============
+void telemetry_register_task(const char* name, TaskHandle_t task) {
+    if (!task) return;
+    portENTER_CRITICAL(&telMux);
+    if (gTaskCount < TELEMETRY_MAX_TASKS) gTasks[gTaskCount++] = { name, task };
+    portEXIT_CRITICAL(&telMux);
+}
+
+void telemetry_register_queue(const char* name, QueueHandle_t queue) {
+    if (!queue) return;
+    portENTER_CRITICAL(&telMux);
+    if (gQueueCount < TELEMETRY_MAX_QUEUES) gQueues[gQueueCount++] = { name, queue };
+    portEXIT_CRITICAL(&telMux);
+}
+
+bool telemetry_due() {
+    uint32_t now = millis();
+    if (gLastSent && now - gLastSent < TELEMETRY_PERIOD_MS) return false;
+    gLastSent = now;
+    return true;
+}
+
+size_t telemetry_build(uint8_t* buf, size_t len) {
+    if (!buf || len < TELEMETRY_MAX_LEN) return 0;
+
+    tracked_task_t tasks[TELEMETRY_MAX_TASKS];
+    tracked_queue_t queues[TELEMETRY_MAX_QUEUES];
+    portENTER_CRITICAL(&telMux);
+    int nt = gTaskCount, nq = gQueueCount;
+    memcpy(tasks, gTasks, sizeof(tasks));
+    memcpy(queues, gQueues, sizeof(queues));
+    portEXIT_CRITICAL(&telMux);
+
+    frame_pool_stats_t pool;
+    ws_uplink_stats_t up;
+    ws_draw_timing_t drawBlocking, drawDma;
+    ws_reconnect_stats_t reconn;
+    frame_pool_get_stats(&pool);
+    websocket_get_uplink_stats(&up);
+    websocket_get_reconnect_stats(&reconn);
+    ws_draw_get_timing(&drawBlocking, &drawDma);
+
+    uint8_t* p = buf;
+    *p++ = TELEMETRY_MAGIC0;
+    *p++ = TELEMETRY_MAGIC1;
+    *p++ = TELEMETRY_VERSION;
+    *p++ = (uint8_t)nt;
+    *p++ = (uint8_t)nq;
+    *p++ = 0;
+    p = wr32(p, millis());
+
+    p = wr32(p, heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    p = wr32(p, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    p = wr32(p, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    p = wr32(p, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    p = wr32(p, heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    p = wr32(p, heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+
+    p = wr32(p, pool.acquired);
+    p = wr32(p, up.sent);
+    p = wr32(p, drawBlocking.frames + drawDma.frames);
+    p = wr32(p, up.dropped + pool.starved);
+
+    p = wr32(p, reconn.count);
+    p = wr32(p, reconn.last_ms);
+    p = wr32(p, reconn.ack_last_ms);
+    p = wr32(p, reconn.ack_max_ms);
+
+    for (int i = 0; i < nt; i++) {
+        p = wr_name(p, tasks[i].name);
+        p = wr32(p, uxTaskGetStackHighWaterMark(tasks[i].handle));   // bytes en ESP-IDF
+    }
+    for (int i = 0; i < nq; i++) {
+        UBaseType_t depth = uxQueueMessagesWaiting(queues[i].handle);
+        UBaseType_t cap = depth + uxQueueSpacesAvailable(queues[i].handle);
+        p = wr_name(p, queues[i].name);
+        *p++ = (uint8_t)(depth > 255 ? 255 : depth);
+        *p++ = (uint8_t)(cap > 255 ? 255 : cap);
+    }
+    return p - buf;
+}
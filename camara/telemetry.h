@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/queue.h>
+
+// Instantánea de salud (ESP32 -> servidor, WStype_BIN), little-endian:
+//   'T' 'M' | version u8 | n_tasks u8 | n_queues u8 | reservado u8
+//   uptime_ms u32
+//   heap_free u32 | heap_min u32 | heap_largest u32
+//   psram_free u32 | psram_min u32 | psram_largest u32
+//   frames: captured u32 | sent u32 | drawn u32 | dropped u32
+//   reconexión: count u32 | last_ms u32 (caída -> socket) | ack_last_ms u32 (caída -> primer ack) | ack_max_ms u32
+//   n_tasks x  { name char[8] | stack_free_min u32 (bytes) }
+//   n_queues x { name char[8] | depth u8 | capacity u8 }
+#define TELEMETRY_MAGIC0     'T'
+#define TELEMETRY_MAGIC1     'M'
+#define TELEMETRY_VERSION    2
+#define TELEMETRY_PERIOD_MS  5000   // como mucho un mensaje cada 5 s
+#define TELEMETRY_MAX_TASKS  6
+#define TELEMETRY_MAX_QUEUES 4
+#define TELEMETRY_NAME_LEN   8
+#define TELEMETRY_MAX_LEN    (66 + TELEMETRY_MAX_TASKS * 12 + TELEMETRY_MAX_QUEUES * 10)
+
+// Registro de tareas/colas a vigilar (nombre truncado a 8 caracteres)
+void telemetry_register_task(const char* name, TaskHandle_t task);
+void telemetry_register_queue(const char* name, QueueHandle_t queue);
+
+// ¿Toca enviar? (respeta TELEMETRY_PERIOD_MS)
+bool telemetry_due();
+
+// Construye el mensaje en buf. Devuelve su longitud (0 si no cabe).
+size_t telemetry_build(uint8_t* buf, size_t len);
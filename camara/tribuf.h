@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Índices de un triple buffer de un escritor y un lector. El escritor tiene
+// siempre un hueco propio (back), el lector otro (front) y el del medio guarda
+// la última publicación. Los intercambios son un único exchange atómico: nadie
+// espera ni desactiva interrupciones, y el lector nunca ve un hueco a medias.
+#define TRIBUF_DIRTY 0x04           // bit en `middle`: publicación aún no leída
+
+struct tribuf_t {
+    uint8_t back = 1;                       // solo escritor
+    std::atomic<uint8_t> middle{2};         // índice | TRIBUF_DIRTY
+    uint8_t front = 0;                      // solo lector
+};
+
+// Escritor: publica `back` y devuelve el nuevo hueco a rellenar.
+// acq_rel: lo escrito es visible antes que el índice (release) y el hueco
+// recibido ya no lo lee nadie (acquire).
+static inline uint8_t tribuf_publish(tribuf_t* t) {
+    uint8_t prev = t->middle.exchange(t->back | TRIBUF_DIRTY, std::memory_order_acq_rel);
+    t->back = prev & ~TRIBUF_DIRTY;
+    return t->back;
+}
+
+// Lector: toma la publicación más reciente si la hay. Devuelve el hueco a leer;
+// *fresh indica si cambió desde la llamada anterior.
+static inline uint8_t tribuf_acquire(tribuf_t* t, bool* fresh) {
+    bool dirty = t->middle.load(std::memory_order_relaxed) & TRIBUF_DIRTY;
+    if (dirty) {
+        uint8_t prev = t->middle.exchange(t->front, std::memory_order_acq_rel);
+        t->front = prev & ~TRIBUF_DIRTY;
+    }
+    if (fresh) *fresh = dirty;
+    return t->front;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+
+// Cabecera de cada mensaje de uplink (ESP32 -> servidor, WStype_BIN), little-endian:
+//   'F' 'R' | version u8 | flags u8 | seq u32 | capture_us u64
+// seguida del frame (JPEG o RGB565 crudo según flags). El servidor devuelve seq
+// como frame_id en sus detecciones (det_proto o "frame_id" en JSON).
+#define UPLINK_MAGIC0      'F'
+#define UPLINK_MAGIC1      'R'
+#define UPLINK_VERSION     2      // v2: parte/partes en el bloque ROI
+#define UPLINK_HEADER_LEN  16
+
+#define UPLINK_FLAG_JPEG   0x01     // payload JPEG (si no, RGB565 big-endian)
+#define UPLINK_FLAG_ROI    0x02     // tras la cabecera va un bloque ROI (abajo)
+
+// Bloque ROI (16 bytes, little-endian) tras la cabecera cuando UPLINK_FLAG_ROI:
+//   x u16 | y u16 | w u16 | h u16   región en coordenadas de la vista (frame_views.h)
+//   out_w u16 | out_h u16           tamaño en píxeles del payload (< w,h si va reducido)
+//   part u8 | parts u8              mensaje part (0..parts-1) de los parts del frame
+//   side u16                        lado de la vista: espacio de las respuestas
+// Todos los mensajes de un frame comparten seq; el servidor responde a cada uno y
+// el ESP32 junta las respuestas antes de publicar y confirmar el frame (det_merge.h).
+// El servidor mapea (px, py) del payload a la vista con x + px * w / out_w, y + py * h / out_h
+// y responde las detecciones en coordenadas de la vista (src = side x side).
+// Sin el bloque, el payload es la vista completa (reducida según frame_views_uplink_shift)
+// y las respuestas van en píxeles del propio payload.
+#define UPLINK_ROI_LEN     16
+
+struct uplink_roi_t {
+    uint16_t x, y, w, h;
+    uint16_t out_w, out_h;
+    uint8_t part, parts;
+    uint16_t side;
+};
+
+struct uplink_header_t {
+    uint8_t flags;
+    uint32_t seq;           // frame_lease_t::seq
+    uint64_t capture_us;    // fb->timestamp (mismo reloj que esp_timer_get_time)
+};
+
+static inline void uplink_roi_write(uint8_t* dst, const uplink_roi_t &r) {
+    const uint16_t v[6] = { r.x, r.y, r.w, r.h, r.out_w, r.out_h };
+    for (int i = 0; i < 6; i++) {
+        dst[2 * i] = (uint8_t)v[i];
+        dst[2 * i + 1] = (uint8_t)(v[i] >> 8);
+    }
+    dst[12] = r.part;
+    dst[13] = r.parts;
+    dst[14] = (uint8_t)r.side;
+    dst[15] = (uint8_t)(r.side >> 8);
+}
+
+static inline void uplink_header_write(uint8_t* dst, const uplink_header_t &h) {
+    dst[0] = UPLINK_MAGIC0;
+    dst[1] = UPLINK_MAGIC1;
+    dst[2] = UPLINK_VERSION;
+    dst[3] = h.flags;
+    for (int i = 0; i < 4; i++) dst[4 + i] = (uint8_t)(h.seq >> (8 * i));
+    for (int i = 0; i < 8; i++) dst[8 + i] = (uint8_t)(h.capture_us >> (8 * i));
+}
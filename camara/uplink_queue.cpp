@@ -0,0 +1,91 @@
+#include "uplink_queue.h"
+#include "uplink_window.h"
+#include "rate_ctrl.h"
+#include <atomic>
+
+// ============ Estado ============
+static portMUX_TYPE qMux = portMUX_INITIALIZER_UNLOCKED;
+
+static QueueHandle_t gQueue = nullptr;      // frame_lease_t*
+static std::atomic<bool> gWindowFull{false};  // lo escribe la red, lo lee la cámara
+static std::atomic<bool> gHeld{false};        // cambio de cámara en curso
+static uplink_queue_stats_t gStats = {0, 0, 0};
+
+// ============ API ============
+bool uplink_queue_init() {
+    if (!gQueue) gQueue = xQueueCreate(UPLINK_QUEUE_LEN, sizeof(frame_lease_t*));
+    return gQueue != nullptr;
+}
+
+QueueHandle_t uplink_queue_handle() {
+    return gQueue;
+}
+
+void uplink_queue_push(frame_lease_t* lease) {
+    if (!lease || !gQueue || gHeld.load()) return;
+    frame_lease_retain(lease);
+
+    // Drop-oldest: si la cola está llena, saca el más antiguo y reintenta
+    uint32_t replaced = 0, dropped = 0;
+    while (xQueueSend(gQueue, &lease, 0) != pdTRUE) {
+        frame_lease_t* oldest = nullptr;
+        if (xQueueReceive(gQueue, &oldest, 0) == pdTRUE && oldest) {
+            frame_lease_release(oldest);
+            if (gWindowFull.load(std::memory_order_relaxed)) replaced++;
+            else dropped++;
+        }
+    }
+
+    portENTER_CRITICAL(&qMux);
+    gStats.queued++;
+    gStats.replaced += replaced;
+    gStats.dropped += dropped;
+    portEXIT_CRITICAL(&qMux);
+    for (uint32_t i = 0; i < dropped; i++) rate_ctrl_on_drop();
+}
+
+frame_lease_t* uplink_queue_pop(uint32_t now_ms, TickType_t wait) {
+    if (!gQueue) return nullptr;
+    if (gHeld.load()) {
+        vTaskDelay(wait);
+        return nullptr;
+    }
+    if (!uplink_window_open(now_ms)) {
+        gWindowFull.store(true, std::memory_order_relaxed);
+        vTaskDelay(wait);
+        return nullptr;
+    }
+    // Se marca abierta después de vaciar la cola: una sustitución mientras tanto
+    // aún es espera de la ventana, no un descarte
+    frame_lease_t* lease = nullptr;
+    bool got = xQueueReceive(gQueue, &lease, wait) == pdTRUE;
+    gWindowFull.store(false, std::memory_order_relaxed);
+    return got ? lease : nullptr;
+}
+
+void uplink_queue_flush(TickType_t wait) {
+    if (!gQueue) return;
+    gWindowFull.store(false, std::memory_order_relaxed);
+    frame_lease_t* stale = nullptr;
+    if (xQueueReceive(gQueue, &stale, wait) == pdTRUE && stale) frame_lease_release(stale);
+}
+
+void uplink_queue_hold(bool hold) {
+    gHeld.store(hold);
+    if (!hold || !gQueue) return;
+    frame_lease_t* stale = nullptr;
+    while (xQueueReceive(gQueue, &stale, 0) == pdTRUE) {
+        if (stale) frame_lease_release(stale);
+    }
+}
+
+uint32_t uplink_queue_waiting() {
+    return gQueue ? (uint32_t)uxQueueMessagesWaiting(gQueue) : 0;
+}
+
+void uplink_queue_get_stats(uplink_queue_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&qMux);
+    *out = gStats;
+    portEXIT_CRITICAL(&qMux);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/queue.h>
+#include "frame_pool.h"
+
+// Cola de frames de la tarea de cámara a la de red: UPLINK_QUEUE_LEN huecos,
+// drop-oldest (se queda el más nuevo). Con la ventana de uplink_window.h llena la
+// red deja de sacar frames y el más nuevo sustituye al que espera: es el control
+// de flujo funcionando, se cuenta aparte (replaced) y no frena rate_ctrl. Solo
+// un frame desplazado con la ventana abierta (la red no da abasto) es un
+// descarte (dropped) y llama a rate_ctrl_on_drop().
+#define UPLINK_QUEUE_LEN 1
+
+struct uplink_queue_stats_t {
+    uint32_t queued;
+    uint32_t replaced;      // sustituidos esperando a que se abra la ventana
+    uint32_t dropped;       // sustituidos con la ventana abierta
+};
+
+bool uplink_queue_init();
+QueueHandle_t uplink_queue_handle();    // para telemetry_register_queue
+
+// Cámara: encola con su propia referencia. Nunca bloquea.
+void uplink_queue_push(frame_lease_t* lease);
+
+// Red: siguiente frame si la ventana está abierta (lo espera hasta `wait`). Con
+// la ventana llena no saca nada y duerme `wait`. nullptr si no hay frame.
+frame_lease_t* uplink_queue_pop(uint32_t now_ms, TickType_t wait);
+
+// Red, sin enlace: suelta lo que llegue a la cola (espera hasta `wait`)
+void uplink_queue_flush(TickType_t wait);
+
+// Cambio de cámara: con hold suelta lo que haya en cola, no encola y la red no
+// saca nada (solo queda la concesión de un envío ya empezado) hasta hold false
+void uplink_queue_hold(bool hold);
+
+uint32_t uplink_queue_waiting();
+void uplink_queue_get_stats(uplink_queue_stats_t* out);
@@ -0,0 +1,97 @@
+#include "uplink_window.h"
+
+// ============ Estado ============
+static portMUX_TYPE winMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Frames sin confirmar, del más antiguo al más nuevo
+static uint32_t gSeq[UPLINK_WINDOW_MAX];
+static uint32_t gSentMs[UPLINK_WINDOW_MAX];
+static uplink_window_stats_t gStats = {};
+
+static uint8_t clamp_size(uint8_t size) {
+    return size < 1 ? 1 : (size > UPLINK_WINDOW_MAX ? UPLINK_WINDOW_MAX : size);
+}
+
+// Quita las n primeras entradas (bajo winMux)
+static void pop_front(int n) {
+    int left = gStats.in_flight - n;
+    for (int i = 0; i < left; i++) {
+        gSeq[i] = gSeq[i + n];
+        gSentMs[i] = gSentMs[i + n];
+    }
+    gStats.in_flight = (uint8_t)left;
+}
+
+// ============ API ============
+void uplink_window_init(uint8_t size) {
+    portENTER_CRITICAL(&winMux);
+    gStats = {};
+    gStats.size = clamp_size(size);
+    portEXIT_CRITICAL(&winMux);
+}
+
+void uplink_window_set_size(uint8_t size) {
+    portENTER_CRITICAL(&winMux);
+    gStats.size = clamp_size(size);     // si baja, se vacía con las siguientes confirmaciones
+    portEXIT_CRITICAL(&winMux);
+}
+
+bool uplink_window_open(uint32_t now_ms) {
+    portENTER_CRITICAL(&winMux);
+    int expired = 0;
+    while (expired < gStats.in_flight && now_ms - gSentMs[expired] >= UPLINK_ACK_TIMEOUT_MS) expired++;
+    if (expired) {
+        pop_front(expired);
+        gStats.timeouts += expired;
+    }
+    bool open = gStats.in_flight < gStats.size;
+    portEXIT_CRITICAL(&winMux);
+    return open;
+}
+
+void uplink_window_on_send(uint32_t seq, uint32_t now_ms) {
+    portENTER_CRITICAL(&winMux);
+    if (gStats.in_flight == UPLINK_WINDOW_MAX) {   // solo si alguien envía con la ventana llena
+        pop_front(1);
+        gStats.lost++;
+    }
+    gSeq[gStats.in_flight] = seq;
+    gSentMs[gStats.in_flight] = now_ms;
+    gStats.in_flight++;
+    if (gStats.in_flight >= gStats.size) gStats.stalls++;
+    portEXIT_CRITICAL(&winMux);
+}
+
+void uplink_window_on_ack(uint32_t seq, uint32_t now_ms) {
+    portENTER_CRITICAL(&winMux);
+    int idx = -1;
+    if (seq == 0) idx = gStats.in_flight ? 0 : -1;
+    else {
+        for (int i = 0; i < gStats.in_flight; i++) {
+            if (gSeq[i] == seq) { idx = i; break; }
+        }
+    }
+    // Confirmación repetida o de un frame ya caducado: no libera nada
+    if (idx >= 0) {
+        uint32_t age = now_ms - gSentMs[idx];
+        gStats.last_ack_ms = age;
+        if (age > gStats.max_ack_ms) gStats.max_ack_ms = age;
+        gStats.acks++;
+        gStats.lost += idx;
+        pop_front(idx + 1);
+    }
+    portEXIT_CRITICAL(&winMux);
+}
+
+void uplink_window_on_disconnect() {
+    portENTER_CRITICAL(&winMux);
+    gStats.in_flight = 0;               // las confirmaciones pendientes ya no llegarán
+    portEXIT_CRITICAL(&winMux);
+}
+
+void uplink_window_get_stats(uplink_window_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&winMux);
+    *out = gStats;
+    portEXIT_CRITICAL(&winMux);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+
+// Control de flujo por ventana: como mucho `size` frames enviados sin confirmar.
+// El servidor confirma cada frame por su frame_id (cabecera de uplink), con la
+// propia respuesta de detecciones o con un {"ack":id} previo a la inferencia.
+// Una confirmación libera ese frame y los anteriores (el servidor responde en
+// orden; los que quedaron atrás se cuentan como perdidos). Con la ventana llena
+// la tarea de red deja de sacar frames de la cola drop-oldest: al abrirse se
+// envía el más nuevo, nunca una acumulación de frames viejos en el TCP.
+// Servidor sin eco de frame_id: cada respuesta confirma el más antiguo.
+#define UPLINK_WINDOW_DEFAULT   2
+#define UPLINK_WINDOW_MAX       8
+#define UPLINK_ACK_TIMEOUT_MS   3000    // sin confirmación: se da por perdido
+
+struct uplink_window_stats_t {
+    uint8_t size;
+    uint8_t in_flight;
+    uint32_t acks;
+    uint32_t lost;          // saltados por una confirmación posterior
+    uint32_t timeouts;
+    uint32_t stalls;        // veces que la ventana se llenó
+    uint32_t last_ack_ms;   // envío -> confirmación del último
+    uint32_t max_ack_ms;
+};
+
+void uplink_window_init(uint8_t size);
+void uplink_window_set_size(uint8_t size);      // 1..UPLINK_WINDOW_MAX
+
+// ¿Se puede enviar otro frame? Caduca antes los que superan el timeout.
+bool uplink_window_open(uint32_t now_ms);
+
+void uplink_window_on_send(uint32_t seq, uint32_t now_ms);
+void uplink_window_on_ack(uint32_t seq, uint32_t now_ms);   // seq 0: el más antiguo
+void uplink_window_on_disconnect();
+
+void uplink_window_get_stats(uplink_window_stats_t* out);
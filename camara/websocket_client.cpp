@@ -1,219 +1,519 @@
 #include "websocket_client.h"
 #include "ws_draw.h"
+#include "jpeg_encoder.h"
+#include "rate_ctrl.h"
+#include "det_proto.h"
+#include "det_parse.h"
+#include "det_merge.h"
+#include "uplink_proto.h"
+#include "latency_stats.h"
+#include <esp_heap_caps.h>
+#include "app_log.h"
+#include "telemetry.h"
+#include "task_config.h"
+#include "roi_uplink.h"
+#include "app_config.h"
+#include "boot_profile.h"
+#include "uplink_window.h"
+#include "uplink_queue.h"
 #include <Arduino.h>
-#include <ArduinoJson.h>
+#include <WiFi.h>
 
 WebSocketsClient webSocket;  // Definición única
 
-// ============ Helpers ============
-static void hexdump(const uint8_t* p, size_t len) {
-  const size_t maxDump = 128;
-  size_t n = len > maxDump ? maxDump : len;
-  for(size_t i=0;i<n;i++){
-    if((i%16)==0) Serial.printf("\n  %04u: ", (unsigned)i);
-    Serial.printf("%02X ", p[i]);
-  }
-  if(len>maxDump) Serial.printf("\n  ... (%u bytes mas)", (unsigned)(len-maxDump));
-  Serial.println();
+// ============ Tarea de red ============
+static TaskHandle_t gNetTaskHandle = nullptr;
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+static ws_uplink_stats_t gUplinkStats = {0, 0, 0, 0, 0, 0, 0};
+static ws_rx_stats_t gRxStats = {0, 0, 0, 0};
+static volatile bool gLinkUp = false;          // socket conectado (lo lee la tarea de cámara)
+
+#define WS_RTT_PING_MS 2000   // ping propio para medir RTT (rate_ctrl)
+
+// Servidor configurado; la tarea de red conecta cuando hay WiFi (websocket_init solo lo guarda)
+static char gHost[64];
+static char gPath[32];
+static uint16_t gPort = 0;
+static bool gSSL = false;
+static bool gNeedBegin = false;
+
+// Reconexión: dirección resuelta (modo TCP plano) y tiempos
+static IPAddress gServerIp;
+static bool gServerIpValid = false;
+static uint32_t gDownSinceMs = 0;      // 0 = conectado o nunca conectado
+static uint32_t gAckWaitSinceMs = 0;   // caída aún sin confirmación tras reconectar (0 = ninguna)
+static uint32_t gAckWaitAcks = 0;      // uplink_window acks al reconectar
+static bool gFastRetry = false;
+static portMUX_TYPE reconnMux = portMUX_INITIALIZER_UNLOCKED;
+static ws_reconnect_stats_t gReconn = {};
+
+// Cabecera + RGB565 contiguos para el modo crudo (se reserva una vez en PSRAM)
+static uint8_t* gRawStage = nullptr;
+static size_t gRawStageLen = 0;
+
+static void add_rx_time(bool binary, uint32_t dt) {
+  portENTER_CRITICAL(&statsMux);
+  if (binary) { gRxStats.bin_msgs++;  gRxStats.bin_us += dt; }
+  else        { gRxStats.json_msgs++; gRxStats.json_us += dt; }
+  portEXIT_CRITICAL(&statsMux);
+}
+
+// ============ Reconexión ============
+// La librería crea un cliente TLS nuevo en cada intento y no expone tickets de
+// sesión: con SSL cada reconexión es un handshake completo (la caché DNS de lwIP
+// evita la resolución mientras dure el TTL). En TCP plano se conecta a la IP
+// guardada, sin DNS; tras WS_RECONNECT_FAST_MS sin éxito se vuelve a resolver.
+static void webSocketEvent(WStype_t type, uint8_t * payload, size_t length);
+
+static void on_link_down() {
+  if (!gDownSinceMs) gDownSinceMs = millis();
+  webSocket.setReconnectInterval(WS_RECONNECT_FAST_INTERVAL_MS);
+  gFastRetry = true;
+}
+
+static void on_link_up() {
+  uint32_t now = millis();
+  webSocket.setReconnectInterval(WS_RECONNECT_INTERVAL_MS);
+  gFastRetry = false;
+  if (!gDownSinceMs) return;             // primera conexión: la mide boot_profile
+  uint32_t dt = now - gDownSinceMs;
+  if (!gAckWaitSinceMs) gAckWaitSinceMs = gDownSinceMs;
+  gDownSinceMs = 0;
+  uplink_window_stats_t w;
+  uplink_window_get_stats(&w);
+  gAckWaitAcks = w.acks;
+
+  portENTER_CRITICAL(&reconnMux);
+  gReconn.count++;
+  gReconn.last_ms = dt;
+  if (dt > gReconn.max_ms) gReconn.max_ms = dt;
+  gReconn.total_ms += dt;
+  portEXIT_CRITICAL(&reconnMux);
+  LOG_I("WS", "reconectado en %u ms (%s%s)", (unsigned)dt, gSSL ? "TLS" : "TCP",
+        !gSSL && gServerIpValid ? ", IP en caché" : "");
+}
+
+// Tras det_parse: la primera confirmación después de reconectar cierra la medida
+static void on_rx_after_reconnect() {
+  if (!gAckWaitSinceMs) return;
+  uplink_window_stats_t w;
+  uplink_window_get_stats(&w);
+  if (w.acks == gAckWaitAcks) return;
+  uint32_t dt = millis() - gAckWaitSinceMs;
+  gAckWaitSinceMs = 0;
+
+  portENTER_CRITICAL(&reconnMux);
+  gReconn.acked++;
+  gReconn.ack_last_ms = dt;
+  if (dt > gReconn.ack_max_ms) gReconn.ack_max_ms = dt;
+  gReconn.ack_total_ms += dt;
+  portEXIT_CRITICAL(&reconnMux);
+  LOG_I("WS", "primer ack %u ms tras la caída", (unsigned)dt);
 }
 
-static bool parse_bbox(JsonObjectConst o, int &x, int &y, int &w, int &h) {
-  if (o.containsKey("x") && o.containsKey("y") && (o.containsKey("w")||o.containsKey("width")) && (o.containsKey("h")||o.containsKey("height"))) {
-    float xf = o["x"] | 0.0f;
-    float yf = o["y"] | 0.0f;
-    float wf = o.containsKey("w") ? (o["w"] | 0.0f) : (o["width"]  | 0.0f);
-    float hf = o.containsKey("h") ? (o["h"] | 0.0f) : (o["height"] | 0.0f);
-    x = xf; y = yf; w = wf; h = hf;
-    return true;
+// (Re)configura la librería con el servidor guardado. Solo tarea de red, con WiFi.
+static void begin_server() {
+  gNeedBegin = false;
+  if (gSSL) {
+    webSocket.beginSSL(gHost, gPort, gPath);   // SNI y Host necesitan el nombre
+  } else {
+    if (!gServerIpValid) {
+      uint32_t t0 = millis();
+      gServerIpValid = WiFi.hostByName(gHost, gServerIp) == 1;
+      portENTER_CRITICAL(&reconnMux);
+      gReconn.dns_ms = millis() - t0;
+      portEXIT_CRITICAL(&reconnMux);
+    }
+    if (gServerIpValid) webSocket.begin(gServerIp.toString().c_str(), gPort, gPath);
+    else                webSocket.begin(gHost, gPort, gPath);
   }
-  if (o.containsKey("xmin") && o.containsKey("ymin") && o.containsKey("xmax") && o.containsKey("ymax")) {
-    float xmin = o["xmin"] | 0.0f;
-    float ymin = o["ymin"] | 0.0f;
-    float xmax = o["xmax"] | xmin;
-    float ymax = o["ymax"] | ymin;
-    x = xmin; y = ymin; w = xmax - xmin; h = ymax - ymin;
-    return true;
+  webSocket.setExtraHeaders("X-Det-Proto: 1");   // acepta detecciones binarias (det_proto.h)
+  webSocket.onEvent(webSocketEvent);
+  webSocket.setReconnectInterval(WS_RECONNECT_FAST_INTERVAL_MS);
+  webSocket.enableHeartbeat(WS_HEARTBEAT_MS, WS_HEARTBEAT_TIMEOUT_MS, 2);
+}
+
+// Reintento rápido acotado: sin éxito en WS_RECONNECT_FAST_MS vuelve al intervalo
+// normal y, en TCP plano, olvida la IP (el servidor pudo cambiar de dirección)
+static void reconnect_policy() {
+  if (!gFastRetry || !gDownSinceMs || millis() - gDownSinceMs < WS_RECONNECT_FAST_MS) return;
+  gFastRetry = false;
+  webSocket.setReconnectInterval(WS_RECONNECT_INTERVAL_MS);
+  if (!gSSL && gServerIpValid) {
+    LOG_W("WS", "sin respuesta en %s, se vuelve a resolver %s", gServerIp.toString().c_str(), gHost);
+    gServerIpValid = false;
+    gNeedBegin = true;
   }
-  return false;
 }
 
-// Escala automática de cajas desde el espacio fuente (desconocido) a 240x240.
-static void handle_detections(JsonArrayConst arr) {
-  const int W = 240, H = 240;
+// ============ Evento principal ============
+static void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
+  switch(type) {
+    case WStype_DISCONNECTED:
+      LOG_I("WS", "desconectado");
+      gLinkUp = false;
+      rate_ctrl_on_disconnect();
+      uplink_window_on_disconnect();
+      on_link_down();
+      break;
+    case WStype_CONNECTED:
+      LOG_I("WS", "conectado");
+      boot_mark(BOOT_SOCKET);
+      gLinkUp = true;
+      on_link_up();
+      break;
+    case WStype_PONG:
+      rate_ctrl_on_pong();
+      break;
+    case WStype_TEXT: {
+      uint32_t t0 = micros();
+      bool dets = det_parse_json(payload, length);   // false: comando, ack o JSON inválido
+      add_rx_time(false, micros() - t0);
+      on_rx_after_reconnect();
+      if (dets) {
+        boot_mark(BOOT_FIRST_DETECTION);
+        rate_ctrl_on_detections();
+      }
+      break;
+    }
+    case WStype_BIN: {
+      if (!det_proto_is_detection(payload, length)) break;
+      uint32_t t0 = micros();
+      bool dets = det_parse_binary(payload, length);  // false: versión o longitud inválidas
+      add_rx_time(true, micros() - t0);
+      on_rx_after_reconnect();
+      if (dets) {
+        boot_mark(BOOT_FIRST_DETECTION);
+        rate_ctrl_on_detections();
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
 
-  const auto clampi = [](int v, int lo, int hi){ return v < lo ? lo : (v > hi ? hi : v); };
+// ============ Implementaciones ============
+void websocket_init(const char* host, uint16_t port, const char* path, bool useSSL) {
+  strncpy(gHost, host, sizeof(gHost) - 1);
+  gHost[sizeof(gHost) - 1] = '\0';
+  strncpy(gPath, path, sizeof(gPath) - 1);
+  gPath[sizeof(gPath) - 1] = '\0';
+  gPort = port;
+  gSSL = useSSL;
+  gServerIpValid = false;
+  gNeedBegin = true;     // la tarea de red llama a begin_server() cuando hay WiFi
+
+  LOG_I("WS", "init host=%s port=%u path=%s ssl=%d",
+        host, port, path, useSSL ? 1 : 0);
+}
 
-  const int n = arr.size();
-  if (n <= 0) {
-    ws_draw_update_detecciones(nullptr, 0);
-    Serial.println("[WS] detecciones vacías: limpio overlays");
-    return;
-  }
+void websocket_loop() {
+  webSocket.loop();
+}
 
-  // Reserva con new[] (NO malloc) porque Deteccion tiene String
-  Deteccion* out = new (std::nothrow) Deteccion[n];
-  if (!out) { Serial.println("[WS] ERROR: sin memoria para detecciones"); return; }
+void websocket_send_frame(const uint8_t* data, size_t len) {
+  if (!data || !len) return;
+  if (!webSocket.isConnected()) return;
+  webSocket.sendBIN(data, len);
+}
 
-  // --- 1) Primera pasada: decidir si vienen normalizadas y, si no, estimar tamaño fuente ---
-  bool maybeNormalized = true;           // asumir 0..1 si no vemos valores > 1.2
-  float maxRight = 0.0f, maxBottom = 0.0f;
+static void count_dropped() {
+  portENTER_CRITICAL(&statsMux);
+  gUplinkStats.dropped++;
+  portEXIT_CRITICAL(&statsMux);
+  rate_ctrl_on_drop();
+}
 
-  for (JsonVariantConst v : arr) {
-    JsonObjectConst o = v.as<JsonObjectConst>();
-    if (!o.containsKey("x") || !o.containsKey("y") || !o.containsKey("w") || !o.containsKey("h")) continue;
+static bool send_buffer(const uint8_t* data, size_t len) {
+  uint32_t t0 = micros();
+  bool ok = webSocket.sendBIN(data, len);
+  uint32_t dt = micros() - t0;
+
+  portENTER_CRITICAL(&statsMux);
+  if (ok) gUplinkStats.sent++;
+  else    gUplinkStats.failed++;
+  gUplinkStats.last_send_us = dt;
+  if (dt > gUplinkStats.max_send_us) gUplinkStats.max_send_us = dt;
+  gUplinkStats.total_send_us += dt;
+  portEXIT_CRITICAL(&statsMux);
+
+  if (ok) rate_ctrl_on_send(dt);
+  return ok;
+}
 
-    // Leer como float para cubrir ambos casos (pixeles o normalizado)
-    float fx = o["x"], fy = o["y"], fw = o["w"], fh = o["h"];
+static int64_t capture_us(const camera_fb_t* fb) {
+  return (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+}
 
-    if (fx > 1.2f || fy > 1.2f || fw > 1.2f || fh > 1.2f) maybeNormalized = false; // claro que son pixeles
-    maxRight  = maxRight  < (fx + fw) ? (fx + fw) : maxRight;
-    maxBottom = maxBottom < (fy + fh) ? (fy + fh) : maxBottom;
+// RGB565 crudo (o JPEG del sensor): copia a un buffer de staging para anteponer la
+// cabecera. Con stride != width copia fila a fila desde el fb (una sola copia).
+static uint8_t* raw_stage(const camera_fb_t* fb, uint16_t stride, size_t headroom) {
+  size_t need = headroom + fb->len;
+  if (need > gRawStageLen) {
+    if (gRawStage) heap_caps_free(gRawStage);
+    gRawStage = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    gRawStageLen = gRawStage ? need : 0;
+    if (!gRawStage) return nullptr;
+  }
+  if (fb->format != PIXFORMAT_RGB565 || stride == fb->width) {
+    memcpy(gRawStage + headroom, fb->buf, fb->len);
+  } else {
+    for (size_t y = 0; y < fb->height; y++) {
+      memcpy(gRawStage + headroom + y * fb->width * 2, fb->buf + y * stride * 2, fb->width * 2);
+    }
   }
+  return gRawStage;
+}
 
-  // Caso A: normalizadas → escala directa a 240x240
-  // Caso B: píxeles (p.ej. 1280x720) → calcula factor de escala por paquete
-  float sx = 1.0f, sy = 1.0f;
-  if (maybeNormalized) {
-    sx = W; sy = H;
+// Un mensaje de uplink: cabecera [+ bloque ROI] + JPEG/RGB565 de `img`, listo para enviar
+static uint8_t* build_image(const camera_fb_t* img, uint16_t stride, uplink_header_t hdr, const roi_msg_t &m, size_t* outLen) {
+  const size_t headroom = UPLINK_HEADER_LEN + (m.roi ? UPLINK_ROI_LEN : 0);
+  uint8_t* msg = nullptr;
+  if (img->format == PIXFORMAT_JPEG) {
+    hdr.flags = UPLINK_FLAG_JPEG;           // JPEG del sensor: se envía tal cual
+    msg = raw_stage(img, stride, headroom);
+    *outLen = headroom + img->len;
+  } else if (jpeg_encoder_enabled()) {
+    // fmt2jpg_cb lee filas contiguas: una vista dentro del fb se compacta antes
+    hdr.flags = UPLINK_FLAG_JPEG;
+    camera_fb_t packed = *img;
+    if (!roi_uplink_pack(&packed, stride)) return nullptr;
+    if (!jpeg_encoder_encode(&packed, headroom, &msg, outLen)) return nullptr;
   } else {
-    // Evitar divisiones por cero y limitar factores razonables
-    if (maxRight  < 16.0f)  maxRight  = 16.0f;
-    if (maxBottom < 16.0f)  maxBottom = 16.0f;
-    sx = float(W) / maxRight;
-    sy = float(H) / maxBottom;
-    // Limita factores por seguridad (no deberían explotar)
-    if (sx < 0.05f) sx = 0.05f; if (sx > 20.0f) sx = 20.0f;
-    if (sy < 0.05f) sy = 0.05f; if (sy > 20.0f) sy = 20.0f;
+    hdr.flags = 0;
+    msg = raw_stage(img, stride, headroom);
+    *outLen = headroom + img->len;
   }
+  if (!msg) return nullptr;
 
-  // --- 2) Segunda pasada: escalar, clamp y poblar salida ---
-  int valid = 0;
-  for (int i = 0; i < n; ++i) {
-    JsonObjectConst o = arr[i];
-    if (!o.containsKey("x") || !o.containsKey("y") || !o.containsKey("w") || !o.containsKey("h")) continue;
+  if (m.roi) {
+    hdr.flags |= UPLINK_FLAG_ROI;
+    uplink_roi_write(msg + UPLINK_HEADER_LEN, m.rect);
+  }
+  uplink_header_write(msg, hdr);
+  return msg;
+}
 
-    float fx = o["x"], fy = o["y"], fw = o["w"], fh = o["h"];
+// Envía un frame (JPEG si la etapa está activa) y suelta el lease lo antes posible.
+// Modo normal: un único mensaje con la vista (frame_views.h). Modo ROI: recortes + baja resolución.
+static void send_lease(frame_lease_t* lease) {
+  if (!webSocket.isConnected()) {
+    frame_lease_release(lease);
+    count_dropped();
+    return;
+  }
 
-    // Escala: si venían normalizadas (0..1), multiplicar por 240; si eran píxeles, multiplicar por sx/sy
-    int x = int((maybeNormalized ? fx * W : fx * sx) + 0.5f);
-    int y = int((maybeNormalized ? fy * H : fy * sy) + 0.5f);
-    int w = int((maybeNormalized ? fw * W : fw * sx) + 0.5f);
-    int h = int((maybeNormalized ? fh * H : fh * sy) + 0.5f);
+  uplink_header_t hdr;
+  hdr.flags = 0;
+  hdr.seq = lease->seq;
+  hdr.capture_us = capture_us(lease->fb);
+
+  roi_msg_t plan[ROI_MAX_MSGS];
+  int n = roi_uplink_plan(lease->fb, plan, ROI_MAX_MSGS);
+  uint8_t sent = 0;
+  for (int i = 0; i < n; i++) {
+    camera_fb_t view;
+    uint16_t stride = 0;
+    bool ok = roi_uplink_extract(lease->fb, plan[i], &view, &stride);
+    size_t msgLen = 0;
+    uint8_t* msg = ok ? build_image(&view, stride, hdr, plan[i], &msgLen) : nullptr;
+    if (i == n - 1) {
+      frame_lease_release(lease);   // el RGB565 ya no hace falta: vuelve al driver antes del envío
+      lease = nullptr;
+    }
+    if (msg && send_buffer(msg, msgLen)) sent++;
+  }
+  if (lease) frame_lease_release(lease);
 
-    // Clamp a 240x240 (después de escalar)
-    x = clampi(x, 0, W - 1);
-    y = clampi(y, 0, H - 1);
-    w = clampi(w, 1, W - x);
-    h = clampi(h, 1, H - y);
+  if (sent) {
+    boot_mark(BOOT_FIRST_UPLINK);
+    det_merge_on_send(hdr.seq, sent, plan[0].reply_side);   // una respuesta por mensaje, en este espacio
+    uplink_window_on_send(hdr.seq, millis());
+    latency_on_send(hdr.seq, hdr.capture_us);
+  } else {
+    count_dropped();
+  }
+}
 
-    // Asigna en salida
-    out[valid].x = x; out[valid].y = y; out[valid].w = w; out[valid].h = h;
+// Resumen periódico de latencias por Serial y por el socket (texto JSON)
+static void report_latency() {
+  static uint32_t lastReport = 0;
+  if (millis() - lastReport < LAT_REPORT_MS) return;
+  lastReport = millis();
+
+  char buf[192];
+  size_t n = latency_format_summary(buf, sizeof(buf));
+  LOG_I("LAT", "%s", buf);
+  if (webSocket.isConnected()) webSocket.sendTXT(buf, n);
+
+  uplink_window_stats_t w;
+  uplink_window_get_stats(&w);
+  uplink_queue_stats_t q;
+  uplink_queue_get_stats(&q);
+  LOG_I("WIN", "ventana %u/%u, acks %u, perdidos %u, timeouts %u, llena %u (sustituidos %u, descartes %u), ack %u ms (max %u)",
+        w.in_flight, w.size, (unsigned)w.acks, (unsigned)w.lost, (unsigned)w.timeouts,
+        (unsigned)w.stalls, (unsigned)q.replaced, (unsigned)q.dropped, (unsigned)w.last_ack_ms, (unsigned)w.max_ack_ms);
+
+  rate_ctrl_state_t rc;
+  rate_ctrl_get_state(&rc);
+  LOG_I("RC", "periodo %u ms, %u B/fr, shift %u (suelo %u), det %u ms (base %u), frenadas %u (cola %u), resolución %u",
+        (unsigned)rc.interval_ms, (unsigned)rc.target_bytes, rc.uplink_shift, rc.shift_floor,
+        (unsigned)rc.det_ms, (unsigned)rc.det_base_ms, (unsigned)rc.backoffs, (unsigned)rc.queued,
+        (unsigned)rc.shift_changes);
+
+  ws_reconnect_stats_t r;
+  websocket_get_reconnect_stats(&r);
+  if (r.count) {
+    LOG_I("WS", "reconexiones %u: última %u ms, media %u, max %u (dns %u ms); primer ack %u/%u: última %u ms, media %u, max %u",
+          (unsigned)r.count, (unsigned)r.last_ms, (unsigned)(r.total_ms / r.count), (unsigned)r.max_ms,
+          (unsigned)r.dns_ms, (unsigned)r.acked, (unsigned)r.count, (unsigned)r.ack_last_ms,
+          (unsigned)(r.acked ? r.ack_total_ms / r.acked : 0), (unsigned)r.ack_max_ms);
+  }
+}
 
-    // Acepta "label" o "class"
-    if (o.containsKey("label"))        out[valid].label = o["label"].as<const char*>();
-    else if (o.containsKey("class"))   out[valid].label = o["class"].as<const char*>();
-    else                               out[valid].label = "obj";
+// Perfil de arranque, una vez: por Serial y, con socket, al servidor
+static void report_boot() {
+  static bool logged = false, sent = false;
+  if (sent || !boot_profile_complete()) return;
 
-    Serial.printf("[WS] det[%d]: x=%d y=%d w=%d h=%d label=%s\n",
-                  valid, x, y, w, h, out[valid].label.c_str());
-    valid++;
+  char buf[192];
+  size_t n = boot_profile_format(buf, sizeof(buf));
+  if (!logged) {
+    LOG_I("BOOT", "%s", buf);
+    logged = true;
+  }
+  if (webSocket.isConnected()) {
+    webSocket.sendTXT(buf, n);
+    sent = true;
   }
-
-  // Publica y limpia
-  ws_draw_update_detecciones(valid ? out : nullptr, valid);
-  delete[] out;
-  Serial.println("[WS] detecciones actualizadas OK");
 }
 
+// WiFi conecta en segundo plano (setup no espera): sin IP no se toca el socket
+static bool wifi_ready() {
+  static bool up = false;
+  bool now = WiFi.status() == WL_CONNECTED;
+  if (now != up) {
+    up = now;
+    if (up) {
+      boot_mark(BOOT_WIFI);
+      LOG_I("WIFI", "conectado, IP %s", WiFi.localIP().toString().c_str());
+    } else {
+      LOG_W("WIFI", "enlace perdido");
+    }
+  }
+  return now;
+}
 
-// ============ Evento principal ============
-static void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
-  switch(type) {
-    case WStype_DISCONNECTED:
-      Serial.println("[WS] desconectado");
-      break;
-    case WStype_CONNECTED:
-      Serial.println("[WS] conectado");
-      break;
-    case WStype_TEXT: {
-      Serial.printf("[WS] texto (%u bytes):\n", (unsigned)length);
-      Serial.write(payload, length);
-      Serial.println();
-
-      // OPTIMIZADO: Reducir buffer JSON de 4096 a 2048 bytes (suficiente para detecciones)
-      DynamicJsonDocument doc(2048);
-      DeserializationError err = deserializeJson(doc, payload, length);
-      if (err) {
-        Serial.printf("[WS] JSON error: %s\n", err.c_str());
-        hexdump(payload, length);
-        break;
-      }
+// Efectos de red de los comandos de configuración (app_config.h)
+static void handle_config() {
+  app_config_t cfg;
+  if (app_config_take_server_change(&cfg)) {
+    LOG_I("WS", "nuevo servidor %s:%u%s", cfg.host, cfg.port, cfg.path);
+    webSocket.disconnect();
+    rate_ctrl_on_disconnect();
+    websocket_init(cfg.host, cfg.port, cfg.path, cfg.ssl);
+  }
 
-      Serial.println("[WS] JSON pretty:");
-      serializeJsonPretty(doc, Serial);
-      Serial.println();
-
-      if (doc.is<JsonObject>()) {
-        JsonObject root = doc.as<JsonObject>();
-
-        // caso: raíz con array de detecciones
-        if (root.containsKey("faces") && root["faces"].is<JsonArray>()) {
-          handle_detections(root["faces"].as<JsonArrayConst>());
-          break;
-        }
-        if (root.containsKey("detections") && root["detections"].is<JsonArray>()) {
-          handle_detections(root["detections"].as<JsonArrayConst>());
-          break;
-        }
-
-        // caso: raíz es una detección única
-        if (root.containsKey("x") || root.containsKey("xmin")) {
-          DynamicJsonDocument tmp(256);
-          JsonArray arr = tmp.createNestedArray();
-          arr.add(root);
-          handle_detections(arr);
-          break;
-        }
-
-        // caso: objeto vacío
-        Serial.println("[WS] objeto sin detecciones, limpio overlays");
-        ws_draw_update_detecciones(nullptr, 0);
-        break;
-      }
+  if (!webSocket.isConnected()) return;
+  char reply[APP_CFG_REPLY_LEN];
+  if (app_config_take_reply(reply, sizeof(reply))) {
+    webSocket.sendTXT(reply);
+    // El reinicio espera a que la respuesta haya salido
+    if (app_config_reboot_pending()) {
+      webSocket.loop();
+      delay(100);
+      ESP.restart();
+    }
+  }
+}
 
-      if (doc.is<JsonArray>()) {
-        handle_detections(doc.as<JsonArrayConst>());
-        break;
+static void loopTask_net(void *pvParameters) {
+  uint32_t lastPing = 0;
+  for (;;) {
+    if (!wifi_ready()) {
+      // Sin enlace: suelta lo que quedara en cola y espera (también hace de pausa)
+      if (gLinkUp) {
+        rate_ctrl_on_disconnect();
+        uplink_window_on_disconnect();
+        on_link_down();
       }
+      gLinkUp = false;
+      uplink_queue_flush(pdMS_TO_TICKS(50));
+      continue;
+    }
+    if (gNeedBegin) begin_server();
+    webSocket.loop();
+    reconnect_policy();
 
-      Serial.println("[WS] formato no reconocido, limpio overlays");
-      ws_draw_update_detecciones(nullptr, 0);
-      break;
+    if (webSocket.isConnected() && millis() - lastPing >= WS_RTT_PING_MS) {
+      lastPing = millis();
+      if (webSocket.sendPing()) rate_ctrl_on_ping_sent();
+    }
+    rate_ctrl_update();
+    report_latency();
+    report_boot();
+    task_stats_report();
+    handle_config();
+
+    // Espera corta: mantiene webSocket.loop() (heartbeat/RX) con latencia baja.
+    // Ventana llena: el frame se queda en la cola drop-oldest (la cámara lo
+    // sustituye por el más nuevo) hasta que llegue una confirmación.
+    frame_lease_t* lease = uplink_queue_pop(millis(), pdMS_TO_TICKS(5));
+    if (lease) send_lease(lease);
+
+    // Telemetría solo con la cola de frames vacía: nunca compite con un frame
+    if (webSocket.isConnected() && uplink_queue_waiting() == 0 && telemetry_due()) {
+      uint8_t tm[TELEMETRY_MAX_LEN];
+      size_t n = telemetry_build(tm, sizeof(tm));
+      if (n) webSocket.sendBIN(tm, n);
     }
-    default:
-      break;
   }
 }
 
-// ============ Implementaciones ============
-void websocket_init(const char* host, uint16_t port, const char* path, bool useSSL) {
-  if (useSSL) webSocket.beginSSL(host, port, path);
-  else        webSocket.begin(host, port, path);
+void websocket_start_task() {
+  if (gNetTaskHandle) return;
+  uplink_queue_init();
+  rate_ctrl_init();
+  latency_init();
+  det_merge_init();
+  uplink_window_init(UPLINK_WINDOW_DEFAULT);
+  task_config_create(TASK_NET, loopTask_net, nullptr, &gNetTaskHandle);
+  telemetry_register_queue("uplink", uplink_queue_handle());
+}
 
-  webSocket.onEvent(webSocketEvent);
-  webSocket.setReconnectInterval(4000);
-  webSocket.enableHeartbeat(15000, 3000, 2);
+void websocket_enqueue_frame(frame_lease_t* lease) {
+  // Sin socket (arranque, reconexión) no se encola: ni copia ni descarte que frene rate_ctrl
+  if (!lease || !gLinkUp) return;
+  uplink_queue_push(lease);     // drop-oldest; con la ventana llena es sustitución, no descarte
+}
 
-  Serial.printf("[WS] init host=%s port=%u path=%s ssl=%d\n",
-                host, port, path, useSSL ? 1 : 0);
+void websocket_hold_uplink(bool hold) {
+  uplink_queue_hold(hold);
 }
 
-void websocket_loop() {
-  webSocket.loop();
+void websocket_get_uplink_stats(ws_uplink_stats_t* out) {
+  if (!out) return;
+  portENTER_CRITICAL(&statsMux);
+  *out = gUplinkStats;
+  portEXIT_CRITICAL(&statsMux);
+
+  uplink_queue_stats_t q;
+  uplink_queue_get_stats(&q);
+  out->dropped += q.dropped;
+  out->replaced = q.replaced;
 }
 
-void websocket_send_frame(const uint8_t* data, size_t len) {
-  if (!data || !len) return;
-  if (!webSocket.isConnected()) return;
-  webSocket.sendBIN(data, len);
+void websocket_get_rx_stats(ws_rx_stats_t* out) {
+  if (!out) return;
+  portENTER_CRITICAL(&statsMux);
+  *out = gRxStats;
+  portEXIT_CRITICAL(&statsMux);
+}
+
+void websocket_get_reconnect_stats(ws_reconnect_stats_t* out) {
+  if (!out) return;
+  portENTER_CRITICAL(&reconnMux);
+  *out = gReconn;
+  portEXIT_CRITICAL(&reconnMux);
 }
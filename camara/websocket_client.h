@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <WebSocketsClient.h>
+#include "frame_pool.h"
 
 // ¡SOLO declaración! (no definas la variable aquí)
 extern WebSocketsClient webSocket;
@@ -11,7 +12,67 @@ struct frame_item_t {
     size_t len;
 };
 
-// Funciones usadas por el resto del proyecto
+// Reconexión: reintentos cada WS_RECONNECT_FAST_INTERVAL_MS durante WS_RECONNECT_FAST_MS
+// tras una caída, luego cada WS_RECONNECT_INTERVAL_MS. Heartbeat: caída detectada en ~9 s.
+#define WS_RECONNECT_FAST_INTERVAL_MS 500
+#define WS_RECONNECT_FAST_MS          10000
+#define WS_RECONNECT_INTERVAL_MS      4000
+#define WS_HEARTBEAT_MS               5000
+#define WS_HEARTBEAT_TIMEOUT_MS       2000
+
+// Funciones usadas por el resto del proyecto.
+// websocket_init guarda el servidor; la tarea de red conecta cuando hay WiFi.
+// useSSL = false (LAN de confianza): TCP plano a la IP resuelta una vez.
 void websocket_init(const char* host, uint16_t port, const char* path, bool useSSL = false);
 void websocket_loop();
+
+// Envío directo: SOLO desde la tarea de red (dueña de webSocket)
 void websocket_send_frame(const uint8_t* data, size_t len);
+
+// Tarea de red: único hilo que toca webSocket (loop + sendBIN)
+void websocket_start_task();
+
+// Encola un frame para enviar (toma su propia referencia). Nunca bloquea:
+// si la cola está llena se descarta el frame más antiguo (uplink_queue.h).
+// Sin socket conectado no hace nada.
+void websocket_enqueue_frame(frame_lease_t* lease);
+
+// Cambio de cámara: suelta el frame en cola y deja de enviar hasta hold false
+// (la cola no espera a que se abra la ventana de confirmaciones)
+void websocket_hold_uplink(bool hold);
+
+struct ws_uplink_stats_t {
+    uint32_t sent;          // frames enviados
+    uint32_t dropped;       // descartados: la red no da abasto o socket desconectado
+    uint32_t replaced;      // sustituidos en cola con la ventana llena (no frenan rate_ctrl)
+    uint32_t failed;        // sendBIN devolvió false
+    uint32_t last_send_us;  // duración del último sendBIN
+    uint32_t max_send_us;
+    uint64_t total_send_us; // para media = total_send_us / sent
+};
+void websocket_get_uplink_stats(ws_uplink_stats_t* out);
+
+// Tiempo de decodificación de detecciones por formato (JSON vs binario det_proto)
+struct ws_rx_stats_t {
+    uint32_t json_msgs;
+    uint32_t bin_msgs;
+    uint64_t json_us;       // media = json_us / json_msgs
+    uint64_t bin_us;
+};
+void websocket_get_rx_stats(ws_rx_stats_t* out);
+
+// Caída -> WStype_CONNECTED de nuevo -> primera confirmación de un frame
+// (la primera conexión va en boot_profile). Si se vuelve a caer antes de la
+// confirmación, ack_* cuenta desde la primera caída.
+struct ws_reconnect_stats_t {
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t max_ms;
+    uint64_t total_ms;      // media = total_ms / count
+    uint32_t dns_ms;        // última resolución (solo TCP plano)
+    uint32_t acked;         // reconexiones con confirmación
+    uint32_t ack_last_ms;   // caída -> primer ack
+    uint32_t ack_max_ms;
+    uint64_t ack_total_ms;  // media = ack_total_ms / acked
+};
+void websocket_get_reconnect_stats(ws_reconnect_stats_t* out);
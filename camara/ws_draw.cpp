@@ -1,39 +1,113 @@
 #include "ws_draw.h"
 #include "websocket_client.h"
 #include "display.h"        // Tu driver TFT (tft.pushImage / drawRect / etc.)
+#include "overlay.h"
+#include "box_tracker.h"
+#include "det_handoff.h"
+#include "frame_views.h"
+#include "pixel_kernels.h"
+#include "latency_stats.h"
+#include "boot_profile.h"
+#include "app_log.h"
 #include <Arduino.h>
 #include <freertos/queue.h>
+#include <esp_heap_caps.h>
+
+// ============ Configuración de display ============
+#define FRAME_W WS_DRAW_W
+#define FRAME_H WS_DRAW_H
+#define BAND_ROWS 20                      // 240x20x2 = 9600 bytes por banda (SRAM interna)
+#define BAND_BYTES (FRAME_W * BAND_ROWS * 2)
+#define TIMING_REPORT_MS 10000            // informe periódico DMA vs bloqueante
+#define TIMING_AB 0                       // 1: alterna ruta DMA/bloqueante frame a frame
+#define IDLE_WAIT_MS 100                  // sin frame nuevo el loop duerme como mucho esto
 
 // ============ Estado ============
 static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 
-static Deteccion gDet[10];
-static int gDetCount = 0;
+// Detecciones: red (escritor) -> dibujo (lector) por triple buffer, sin lock
+static det_handoff_t gDetHandoff;
+static det_set_t gDetLast = {};           // copia del escritor para ws_draw_get_detecciones
+
+// Tracker: solo lo toca el loop de dibujo
+static box_tracker_t gTracker;
+static uint32_t gTrackerGen = 0;
+static bool gTracking = true;
+
+static frame_lease_t* gLease = nullptr;   // último frame con lease pendiente de dibujar
 
-static uint8_t* gFrame = nullptr;
+// Tarea del loop de dibujo: duerme en su notificación hasta que llega un frame
+static TaskHandle_t gDrawTask = nullptr;
 
 // Esta cola te la dejo por compat (si la usas)
 static QueueHandle_t gDetectionQueue = nullptr;
 
+// Ping-pong de bandas en SRAM interna con capacidad DMA
+static uint16_t* gBand[2] = {nullptr, nullptr};
+static bool gUseDma = false;
+
+static ws_draw_timing_t gTiming[2] = {};  // [0] bloqueante, [1] DMA
+
+// Panel compuesto en PSRAM para la ruta bloqueante cuando el frame no es ya 240x240
+static uint8_t* gScaled = nullptr;
+
+// Origen de los píxeles del panel: la vista dentro del frame, reducida 2^shift
+struct draw_src_t {
+    const uint8_t* base;    // esquina de la vista
+    int stride;             // píxeles por fila del frame
+    uint8_t shift;          // vista -> panel
+};
+static uint32_t gLastReport = 0;
+
 // ============ Helpers de dibujo ============
-static void drawFrame(uint8_t* buf){
-    if(!buf) return;
-    // Ajusta el tamaño si usas otro (tu camera_init usa FRAMESIZE_240X240 RGB565)
-    tft.pushImage(0, 0, 240, 240, (uint16_t*)buf);
+static void add_timing(ws_draw_timing_t &t, uint32_t total, uint32_t wait, uint32_t busBytes){
+    t.frames++;
+    t.total_us += total;
+    t.wait_us += wait;
+    t.bus_bytes += busBytes;
+    if(total > t.max_us) t.max_us = total;
 }
 
+// Copia local del último conjunto publicado (solo el loop de dibujo: único lector)
+static int snapshotDetections(Deteccion* local, uint32_t* gen, uint32_t* detMs){
+    const det_set_t* s = det_handoff_read(&gDetHandoff);
+    int n = s->count;
+    memcpy(local, s->dets, n * sizeof(Deteccion));
+    *gen = s->gen;
+    *detMs = s->ms;
+    return n;
+}
 
-// --- REEMPLAZA SOLO ESTA FUNCIÓN ---
-static void drawDetections(){
-    // Copia local bajo lock muy corto; se dibuja fuera del lock
-    Deteccion local[10];
-    int n = 0;
+static draw_src_t src_panel(const uint8_t* buf){
+    return { buf, FRAME_W, 0 };
+}
 
-    portENTER_CRITICAL(&mux);
-    n = gDetCount;
-    for(int i = 0; i < n; i++) local[i] = gDet[i];
-    portEXIT_CRITICAL(&mux);
+// Frame de cámara de cualquier resolución >= panel (frame_views.h)
+static bool src_of(const camera_fb_t* fb, draw_src_t &s){
+    if(fb->format != PIXFORMAT_RGB565) return false;   // JPEG del sensor: solo uplink
+    frame_view_t v;
+    frame_view_of(fb->width, fb->height, &v);
+    if(v.side < FRAME_W) return false;      // menor que el panel: no se pinta
+    s.base = fb->buf + ((size_t)v.y * fb->width + v.x) * 2;
+    s.stride = fb->width;
+    s.shift = v.display_shift;
+    return true;
+}
 
+// Filas [y, y + rows) del panel en dst (FRAME_W x rows contiguo)
+static void fill_rows(const draw_src_t &s, int y, int rows, uint16_t* dst){
+    const uint8_t* row = s.base + (size_t)(y << s.shift) * s.stride * 2;
+    if(s.shift){
+        px_downscale(row, s.stride, FRAME_W, rows, 1 << s.shift, (uint8_t*)dst);
+    } else if(s.stride == FRAME_W){
+        memcpy(dst, row, rows * FRAME_W * 2);
+    } else {
+        for(int r = 0; r < rows; r++) memcpy(dst + r * FRAME_W, row + (size_t)r * s.stride * 2, FRAME_W * 2);
+    }
+}
+
+// --- REEMPLAZA SOLO ESTA FUNCIÓN ---
+static void drawDetections(const Deteccion* local, int n){
     if(n <= 0) return;
 
     for(int i = 0; i < n; i++){
@@ -52,10 +126,139 @@ static void drawDetections(){
     }
 }
 
+// Ruta original: un único pushImage leyendo directo de PSRAM (CPU ocupada todo el SPI)
+// y después cajas/etiquetas encima (esos píxeles se envían dos veces y parpadean)
+static void drawFrameBlocking(const draw_src_t &src, const Deteccion* dets, int n){
+    uint32_t t0 = micros();
+    const uint8_t* buf = src.base;
+    if(src.shift || src.stride != FRAME_W){
+        if(!gScaled) gScaled = (uint8_t*)heap_caps_malloc(FRAME_W * FRAME_H * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if(!gScaled) return;
+        fill_rows(src, 0, FRAME_H, (uint16_t*)gScaled);
+        buf = gScaled;
+    }
+    tft.pushImage(0, 0, FRAME_W, FRAME_H, (uint16_t*)buf);
+    drawDetections(dets, n);
+    uint32_t dt = micros() - t0;
+    uint32_t bus = FRAME_W * FRAME_H * 2 + overlay_legacy_pixels(dets, n, FRAME_W, FRAME_H) * 2;
+    add_timing(gTiming[0], dt, dt, bus);
+}
+
+// Ruta DMA: copia (o reduce) banda PSRAM -> SRAM, compone cajas/etiquetas en la banda y la
+// lanza por DMA mientras se prepara la siguiente en el otro buffer. Cada píxel se
+// envía una sola vez; la CPU solo espera si la copia va más rápida que el SPI.
+static void drawFrameDma(const draw_src_t &src, const Deteccion* dets, int n){
+    uint32_t t0 = micros();
+    uint32_t wait = 0;
+
+    tft.startWrite();
+    for(int y = 0, b = 0; y < FRAME_H; y += BAND_ROWS, b ^= 1){
+        int rows = (FRAME_H - y) < BAND_ROWS ? (FRAME_H - y) : BAND_ROWS;
+        uint16_t* band = gBand[b];
+
+        // Esta banda se envió hace dos vueltas; con 2 buffers basta con que acabe la anterior
+        fill_rows(src, y, rows, band);
+        overlay_draw_band(band, FRAME_W, FRAME_H, y, rows, dets, n, TFT_RED);
+
+        uint32_t w0 = micros();
+        tft.dmaWait();
+        wait += micros() - w0;
+
+        tft.pushImageDMA(0, y, FRAME_W, rows, band);
+    }
+    uint32_t w0 = micros();
+    tft.dmaWait();
+    wait += micros() - w0;
+    tft.endWrite();
+
+    add_timing(gTiming[1], micros() - t0, wait, FRAME_W * FRAME_H * 2);
+}
+
+// Con tracker: corrige con la respuesta nueva (si la hay) y pinta la predicción para ahora
+static int trackDetections(Deteccion* local, int n, uint32_t gen, uint32_t detMs){
+    if(!gTracking) return n;
+    if(gen != gTrackerGen){
+        gTrackerGen = gen;
+        box_tracker_correct(&gTracker, local, n, detMs);
+    }
+    return box_tracker_predict(&gTracker, millis(), local, WS_DRAW_MAX_DET);
+}
+
+// Frame + overlays de detección
+static void drawFrame(const draw_src_t &buf){
+    if(!buf.base) return;
+    Deteccion local[WS_DRAW_MAX_DET];
+    uint32_t gen = 0, detMs = 0;
+    int n = snapshotDetections(local, &gen, &detMs);
+    n = trackDetections(local, n, gen, detMs);
+#if TIMING_AB
+    static bool flip = false;
+    flip = !flip;
+    if(gUseDma && flip) drawFrameDma(buf, local, n); else drawFrameBlocking(buf, local, n);
+#else
+    if(gUseDma) drawFrameDma(buf, local, n); else drawFrameBlocking(buf, local, n);
+#endif
+    latency_on_overlay_drawn();   // cierra captura -> overlay si llegaron detecciones nuevas
+}
+
+static void report_timing(){
+#if APP_LOG_LEVEL >= APP_LOG_INFO
+    uint32_t now = millis();
+    if(now - gLastReport < TIMING_REPORT_MS) return;
+    gLastReport = now;
+
+    static const char* names[2] = {"bloqueante", "DMA"};
+    for(int i = 0; i < 2; i++){
+        const ws_draw_timing_t &t = gTiming[i];
+        if(!t.frames) continue;
+        LOG_I("DRAW", "%s: %u fr, %u us (espera %u us), max %u us, %u B/fr",
+              names[i], (unsigned)t.frames,
+              (unsigned)(t.total_us / t.frames),
+              (unsigned)(t.wait_us / t.frames),
+              (unsigned)t.max_us,
+              (unsigned)(t.bus_bytes / t.frames));
+    }
+#endif
+}
+
+
+
+// Despierta al loop de dibujo (la notificación se acumula si aún no duerme)
+static void wake_draw(){
+    if(gDrawTask) xTaskNotifyGive(gDrawTask);
+}
 
 // ============ API ============
+void deteccion_set_label(Deteccion &d, const char* label){
+    if(!label) label = "";
+    strncpy(d.label, label, DET_LABEL_LEN - 1);
+    d.label[DET_LABEL_LEN - 1] = '\0';
+}
+
 void ws_draw_init(){
-    Serial.println("ws_draw_init: inicializado");
+    gDrawTask = xTaskGetCurrentTaskHandle();   // setup() y loop() comparten la loop task
+
+    // Bandas en SRAM interna: el DMA del SPI no lee bien de PSRAM a esta velocidad
+    gBand[0] = (uint16_t*)heap_caps_malloc(BAND_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    gBand[1] = (uint16_t*)heap_caps_malloc(BAND_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if(gBand[0] && gBand[1] && tft.initDMA()){
+        gUseDma = true;
+    } else {
+        LOG_W("DRAW", "sin DMA, uso pushImage bloqueante");
+        if(gBand[0]) heap_caps_free(gBand[0]);
+        if(gBand[1]) heap_caps_free(gBand[1]);
+        gBand[0] = gBand[1] = nullptr;
+    }
+    LOG_I("DRAW", "inicializado (dma=%d)", gUseDma ? 1 : 0);
+}
+
+void ws_draw_set_dma(bool enabled){
+    gUseDma = enabled && gBand[0] && gBand[1];
+}
+
+void ws_draw_get_timing(ws_draw_timing_t* blocking, ws_draw_timing_t* dma){
+    if(blocking) *blocking = gTiming[0];
+    if(dma)      *dma = gTiming[1];
 }
 
 void start_ws_task(QueueHandle_t queue){
@@ -63,52 +266,75 @@ void start_ws_task(QueueHandle_t queue){
     gDetectionQueue = queue;
 }
 
-void ws_draw_set_frame(uint8_t* newFrame){
-    if(!newFrame) return;
-    portENTER_CRITICAL(&mux);
-    if(gFrame) free(gFrame);
-    gFrame = newFrame;          // Propiedad pasa a ws_draw
-    portEXIT_CRITICAL(&mux);
-    Serial.println("ws_draw_set_frame: frame actualizado");
-}
-
 // OPTIMIZADO: Dibuja directamente sin hacer copia (ahorra ~115KB de RAM)
 void ws_draw_set_frame_direct(const uint8_t* cameraBuf, size_t len){
     if(!cameraBuf || len == 0) return;
     // Dibuja inmediatamente sin hacer copia
-    drawFrame((uint8_t*)cameraBuf);
-    drawDetections();
+    drawFrame(src_panel(cameraBuf));
 }
 
-// --- REEMPLAZA SOLO ESTA FUNCIÓN ---
-void ws_draw_update_detecciones(Deteccion* arr, int count){
-    // Protege el estado compartido (gDet/gDetCount)
+void ws_draw_set_frame_lease(frame_lease_t* lease){
+    if(!lease || !lease->fb) return;
+    frame_lease_retain(lease);
+
+    frame_lease_t* stale = nullptr;
     portENTER_CRITICAL(&mux);
-    if(!arr || count <= 0){
-        gDetCount = 0;              // limpiar overlays
-        portEXIT_CRITICAL(&mux);
-        return;
-    }
-    if(count > 10) count = 10;
-    for(int i = 0; i < count; i++) gDet[i] = arr[i];
-    gDetCount = count;
+    stale = gLease;             // aún sin dibujar: se descarta por el más nuevo
+    gLease = lease;
     portEXIT_CRITICAL(&mux);
+
+    if(stale) frame_lease_release(stale);
+    wake_draw();
 }
 
+// --- REEMPLAZA SOLO ESTA FUNCIÓN ---
+void ws_draw_update_detecciones(Deteccion* arr, int count){
+    ws_draw_update_detecciones_at(arr, count, 0);
+}
+
+void ws_draw_update_detecciones_at(Deteccion* arr, int count, int64_t capture_us){
+    // Único escritor (tarea de red): rellena el buffer trasero y lo publica sin lock
+    det_set_t* s = det_handoff_back(&gDetHandoff);
+    s->ms = capture_us ? (uint32_t)(capture_us / 1000) : millis();
+    if(!arr || count <= 0) count = 0;   // limpiar overlays
+    if(count > WS_DRAW_MAX_DET) count = WS_DRAW_MAX_DET;
+    if(count) memcpy(s->dets, arr, count * sizeof(Deteccion));
+    s->count = count;
+    gDetLast.count = count;
+    if(count) memcpy(gDetLast.dets, s->dets, count * sizeof(Deteccion));
+    det_handoff_publish(&gDetHandoff);
+}
+
+void ws_draw_set_tracking(bool enabled){
+    gTracking = enabled;
+}
+
+
+int ws_draw_get_detecciones(Deteccion* out){
+    if(!out) return 0;
+    memcpy(out, gDetLast.dets, gDetLast.count * sizeof(Deteccion));
+    return gDetLast.count;
+}
 
 void ws_draw_loop(){
-    // Mantener WS vivo
-    websocket_loop();
+    // Sin trabajo no se gira: espera a un frame con lease. Las
+    // detecciones solas no despiertan; se pintan con el siguiente frame.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_WAIT_MS));
 
     // Intercambio atómico del frame
-    uint8_t* local = nullptr;
+    frame_lease_t* lease = nullptr;
     portENTER_CRITICAL(&mux);
-    if(gFrame){ local = gFrame; gFrame = nullptr; }
+    if(gLease){ lease = gLease; gLease = nullptr; }
     portEXIT_CRITICAL(&mux);
 
-    if(local){
-        drawFrame(local);
-        drawDetections();
-        free(local);
+    if(lease){
+        draw_src_t src;
+        if(src_of(lease->fb, src)){
+            drawFrame(src);
+            boot_mark(BOOT_FIRST_FRAME);
+        }
+        frame_lease_release(lease);   // el driver puede reutilizar el buffer
     }
+
+    report_timing();
 }
@@ -1,29 +1,70 @@
 #pragma once
 #include <Arduino.h>
+#include "frame_pool.h"
+#include <type_traits>
 
-// Estructura de detección recibida del servidor
+#define WS_DRAW_W       240     // panel (espacio de coordenadas de Deteccion)
+#define WS_DRAW_H       240
+#define WS_DRAW_MAX_DET 10      // overlays simultáneos
+#define DET_LABEL_LEN   16      // etiqueta incluida '\0' (se trunca)
+
+// Estructura de detección recibida del servidor. Trivialmente copiable: se copia
+// dentro de secciones críticas sin tocar el heap.
 struct Deteccion {
-    String label;
+    char label[DET_LABEL_LEN];
     int x;
     int y;
     int w;
     int h;
 };
+static_assert(std::is_trivially_copyable<Deteccion>::value, "Deteccion debe copiarse sin heap");
+
+// Copia la etiqueta truncando a DET_LABEL_LEN - 1 caracteres
+void deteccion_set_label(Deteccion &d, const char* label);
+
+// Tiempos de volcado de frame por ruta (bloqueante vs DMA por bandas)
+struct ws_draw_timing_t {
+    uint32_t frames;
+    uint64_t total_us;      // tiempo total de drawFrame
+    uint64_t wait_us;       // tiempo con la CPU parada esperando al SPI
+    uint32_t max_us;
+    uint64_t bus_bytes;     // bytes de píxel enviados al panel (frame + overlays)
+};
 
-// Inicialización de la capa de dibujo
+// Inicialización de la capa de dibujo (tras tft.begin(); reserva bandas DMA)
 void ws_draw_init();
 
-// Loop principal (llámalo en loop())
+// Elegir ruta de volcado: DMA por bandas (por defecto si hay SRAM) o pushImage bloqueante
+void ws_draw_set_dma(bool enabled);
+void ws_draw_get_timing(ws_draw_timing_t* blocking, ws_draw_timing_t* dma);
+
+// Loop principal (llámalo en loop()). El WebSocket lo atiende la tarea de red.
+// Bloquea hasta que llega un frame nuevo (o ~100 ms) en vez de girar en vacío.
 void ws_draw_loop();
 
-// Actualizar detecciones (ws_draw copia internamente)
+// Actualizar detecciones (ws_draw copia internamente). Un único escritor: la tarea
+// de red; el loop de dibujo las lee sin lock (det_handoff.h).
 void ws_draw_update_detecciones(Deteccion* detecciones, int count);
 
-// Entregar un frame a ws_draw (ws_draw toma propiedad y lo libera tras dibujar)
-void ws_draw_set_frame(uint8_t* cameraBuf);
+// Igual, indicando la captura (esp_timer, us) del frame al que se refieren;
+// 0 = desconocida (se toma la llegada). Alimenta el tracker de cajas.
+void ws_draw_update_detecciones_at(Deteccion* detecciones, int count, int64_t capture_us);
+
+// Cajas predichas por el tracker en cada frame (por defecto) o las últimas recibidas tal cual
+void ws_draw_set_tracking(bool enabled);
+
+// Copia las últimas detecciones publicadas (out con WS_DRAW_MAX_DET huecos).
+// Devuelve cuántas. Solo desde la tarea que publica (red).
+int ws_draw_get_detecciones(Deteccion* out);
 
 // OPTIMIZADO: Usar frame directamente sin copia (más eficiente, usa el buffer de la cámara)
 void ws_draw_set_frame_direct(const uint8_t* cameraBuf, size_t len);
 
+// Entregar un frame con lease: ws_draw retiene una referencia y la suelta tras
+// dibujarlo en ws_draw_loop(). Si llega otro antes, el pendiente se descarta.
+// Es la única entrega de frames: pinta desde el fb del driver, sin copia ni
+// reserva por frame (frame_pool.h).
+void ws_draw_set_frame_lease(frame_lease_t* lease);
+
 // Compat: tu setup() llama a esto; la dejo como stub (guarda la cola si la necesitas)
 void start_ws_task(QueueHandle_t queue);
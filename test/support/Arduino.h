@@ -0,0 +1,45 @@
+#pragma once
+// Sustituto de Arduino.h para compilar los módulos del sketch en el PC (test/, bench/).
+// Solo lo que usan los módulos sin hardware: tiempo, Serial, ESP y los tipos de FreeRTOS.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <math.h>
+#include <new>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+typedef bool boolean;
+#define PROGMEM
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// Serial escribe en stdout
+struct HardwareSerial {
+    void begin(unsigned long) {}
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s);
+    size_t println(const char* s = "");
+    size_t write(const uint8_t* p, size_t n);
+    int availableForWrite() { return 1024; }
+    void flush();
+};
+extern HardwareSerial Serial;
+
+// Ciclos de CPU: en el PC, nanosegundos del reloj monótono
+struct EspClass {
+    uint32_t getCycleCount();
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getPsramSize() { return 0; }
+    void restart() { abort(); }
+};
+extern EspClass ESP;
@@ -0,0 +1,60 @@
+#pragma once
+// Preferences (NVS) en memoria del proceso: espacio -> clave -> bytes.
+// host_nvs_clear() vacía todo (primer arranque).
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> host_nvs_t;
+
+inline host_nvs_t& host_nvs() {
+    static host_nvs_t nvs;
+    return nvs;
+}
+
+inline void host_nvs_clear() { host_nvs().clear(); }
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        ns_ = name;
+        ro_ = readOnly;
+        return true;
+    }
+    void end() { ns_.clear(); }
+
+    size_t getBytesLength(const char* key) {
+        const std::vector<uint8_t>* v = find(key);
+        return v ? v->size() : 0;
+    }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        const std::vector<uint8_t>* v = find(key);
+        if (!v || v->size() > len) return 0;
+        memcpy(buf, v->data(), v->size());
+        return v->size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (ro_ || ns_.empty()) return 0;
+        host_nvs()[ns_][key].assign((const uint8_t*)buf, (const uint8_t*)buf + len);
+        return len;
+    }
+    bool clear() {
+        if (ro_ || ns_.empty()) return false;
+        host_nvs()[ns_].clear();
+        return true;
+    }
+
+private:
+    const std::vector<uint8_t>* find(const char* key) {
+        auto ns = host_nvs().find(ns_);
+        if (ns == host_nvs().end()) return nullptr;
+        auto it = ns->second.find(key);
+        return it == ns->second.end() ? nullptr : &it->second;
+    }
+
+    std::string ns_;
+    bool ro_ = false;
+};
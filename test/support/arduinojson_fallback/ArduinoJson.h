@@ -0,0 +1,651 @@
+#pragma once
+// SOLO PRUEBAS, SIN RED: sustituto mínimo de ArduinoJson 6 para compilar las
+// pruebas de test/ cuando no hay ArduinoJson real (ni ARDUINOJSON_DIR ni
+// descarga; ver CMakeLists.txt). No es el parser de la placa: bench_det_parse se
+// niega a compilarse contra él (CAMARA_ARDUINOJSON_FALLBACK) y sus tiempos o
+// reservas no dicen nada de la biblioteca real.
+//
+// Subconjunto que usan det_parse.cpp y app_config.cpp: StaticJsonDocument,
+// deserializeJson/serializeJson, variantes, objetos y arrays de solo lectura,
+// `|` con valor por defecto, createNestedArray/add y JSON_ARRAY_SIZE/JSON_OBJECT_SIZE.
+// Memoria fija dentro del documento, cadenas copiadas al pool con deduplicación,
+// límite de anidamiento 10 y NoMemory al llenarse, con huecos de 16 bytes (los
+// del ESP32) para que un documento dimensionado con las macros se llene igual.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits>
+
+#define CAMARA_ARDUINOJSON_FALLBACK       1
+#define ARDUINOJSON_HOST_SLOT_SIZE        16
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+
+// Como la biblioteca: un hueco por elemento o miembro
+#define JSON_ARRAY_SIZE(n)  ((n) * ARDUINOJSON_HOST_SLOT_SIZE)
+#define JSON_OBJECT_SIZE(n) ((n) * ARDUINOJSON_HOST_SLOT_SIZE)
+
+class JsonDocument;
+class JsonVariantConst;
+class JsonObjectConst;
+class JsonArrayConst;
+class JsonObject;
+class JsonArray;
+
+namespace host_json {
+
+enum type_t : uint8_t { T_NULL, T_BOOL, T_INT, T_FLOAT, T_STRING, T_ARRAY, T_OBJECT };
+
+struct slot_t {
+    const char* key;        // nombre del miembro (solo dentro de objetos)
+    slot_t* next;           // siguiente hermano
+    union {
+        bool b;
+        int64_t i;
+        double f;
+        const char* s;
+        slot_t* child;      // primer elemento / miembro
+    } v;
+    type_t type;
+};
+
+// Pool de un documento: huecos por delante, cadenas por detrás, presupuesto común
+struct pool_t {
+    slot_t* slots;
+    char* strings;
+    size_t capacity;        // bytes "de placa" (N del StaticJsonDocument)
+    size_t used;            // huecos * ARDUINOJSON_HOST_SLOT_SIZE + cadenas
+    size_t nslots;
+    size_t nstr;            // bytes de cadenas usados
+    bool overflowed;
+
+    slot_t* alloc_slot() {
+        if (used + ARDUINOJSON_HOST_SLOT_SIZE > capacity) { overflowed = true; return nullptr; }
+        used += ARDUINOJSON_HOST_SLOT_SIZE;
+        slot_t* s = &slots[nslots++];
+        memset(s, 0, sizeof(*s));
+        return s;
+    }
+
+    const char* save_string(const char* p, size_t len) {
+        for (size_t at = 0; at < nstr;) {               // deduplicación
+            size_t l = strlen(strings + at);
+            if (l == len && memcmp(strings + at, p, len) == 0) return strings + at;
+            at += l + 1;
+        }
+        if (used + len + 1 > capacity) { overflowed = true; return nullptr; }
+        char* dst = strings + nstr;
+        memcpy(dst, p, len);
+        dst[len] = '\0';
+        nstr += len + 1;
+        used += len + 1;
+        return dst;
+    }
+
+    void clear() { used = 0; nslots = 0; nstr = 0; overflowed = false; }
+};
+
+static inline const slot_t* member(const slot_t* obj, const char* key) {
+    if (!obj || obj->type != T_OBJECT || !key) return nullptr;
+    for (const slot_t* m = obj->v.child; m; m = m->next) {
+        if (strcmp(m->key, key) == 0) return m;
+    }
+    return nullptr;
+}
+
+static inline const slot_t* element(const slot_t* arr, size_t index) {
+    if (!arr || arr->type != T_ARRAY) return nullptr;
+    const slot_t* e = arr->v.child;
+    while (e && index--) e = e->next;
+    return e;
+}
+
+static inline size_t count(const slot_t* s) {
+    if (!s || (s->type != T_ARRAY && s->type != T_OBJECT)) return 0;
+    size_t n = 0;
+    for (const slot_t* e = s->v.child; e; e = e->next) n++;
+    return n;
+}
+
+// Conversiones (is<T> / as<T>) por tipo
+template <class T> struct conv;
+
+template <class T> struct conv_int {
+    static bool is(const slot_t* s) {
+        if (!s || s->type != T_INT) return false;
+        if (std::numeric_limits<T>::is_signed) {
+            return s->v.i >= (int64_t)std::numeric_limits<T>::min() && s->v.i <= (int64_t)std::numeric_limits<T>::max();
+        }
+        return s->v.i >= 0 && (uint64_t)s->v.i <= (uint64_t)std::numeric_limits<T>::max();
+    }
+    static T as(const slot_t* s) {
+        if (!s) return T(0);
+        if (s->type == T_INT) return (T)s->v.i;
+        if (s->type == T_FLOAT) return (T)s->v.f;
+        if (s->type == T_BOOL) return (T)s->v.b;
+        return T(0);
+    }
+};
+template <> struct conv<int> : conv_int<int> {};
+template <> struct conv<long> : conv_int<long> {};
+template <> struct conv<long long> : conv_int<long long> {};
+template <> struct conv<unsigned> : conv_int<unsigned> {};
+template <> struct conv<unsigned long> : conv_int<unsigned long> {};
+template <> struct conv<unsigned long long> : conv_int<unsigned long long> {};
+template <> struct conv<short> : conv_int<short> {};
+template <> struct conv<unsigned short> : conv_int<unsigned short> {};
+template <> struct conv<signed char> : conv_int<signed char> {};
+template <> struct conv<unsigned char> : conv_int<unsigned char> {};
+
+template <class T> struct conv_float {
+    static bool is(const slot_t* s) { return s && (s->type == T_INT || s->type == T_FLOAT); }
+    static T as(const slot_t* s) {
+        if (!s) return T(0);
+        if (s->type == T_FLOAT) return (T)s->v.f;
+        if (s->type == T_INT) return (T)s->v.i;
+        return T(0);
+    }
+};
+template <> struct conv<float> : conv_float<float> {};
+template <> struct conv<double> : conv_float<double> {};
+
+template <> struct conv<bool> {
+    static bool is(const slot_t* s) { return s && s->type == T_BOOL; }
+    static bool as(const slot_t* s) {
+        if (!s) return false;
+        if (s->type == T_BOOL) return s->v.b;
+        if (s->type == T_INT) return s->v.i != 0;
+        if (s->type == T_FLOAT) return s->v.f != 0;
+        return false;
+    }
+};
+
+template <> struct conv<const char*> {
+    static bool is(const slot_t* s) { return s && s->type == T_STRING; }
+    static const char* as(const slot_t* s) { return is(s) ? s->v.s : nullptr; }
+};
+
+}  // namespace host_json
+
+// ============ Vistas de solo lectura ============
+class JsonVariantConst {
+public:
+    JsonVariantConst(const host_json::slot_t* s = nullptr) : _s(s) {}
+
+    bool isNull() const { return !_s || _s->type == host_json::T_NULL; }
+    template <class T> bool is() const;
+    template <class T> T as() const;
+    template <class T> operator T() const { return as<T>(); }
+
+    JsonVariantConst operator[](const char* key) const { return JsonVariantConst(host_json::member(_s, key)); }
+    JsonVariantConst operator[](int index) const { return JsonVariantConst(index < 0 ? nullptr : host_json::element(_s, (size_t)index)); }
+    JsonVariantConst operator[](size_t index) const { return JsonVariantConst(host_json::element(_s, index)); }
+    bool containsKey(const char* key) const { return host_json::member(_s, key) != nullptr; }
+    size_t size() const { return host_json::count(_s); }
+
+    // Valor por defecto si falta o es de otro tipo
+    template <class T> T operator|(T def) const { return is<T>() ? as<T>() : def; }
+    const char* operator|(const char* def) const { return is<const char*>() ? as<const char*>() : def; }
+
+    const host_json::slot_t* slot() const { return _s; }
+
+private:
+    const host_json::slot_t* _s;
+};
+
+class JsonObjectConst {
+public:
+    JsonObjectConst(const host_json::slot_t* s = nullptr)
+        : _s(s && s->type == host_json::T_OBJECT ? s : nullptr) {}
+
+    bool isNull() const { return !_s; }
+    JsonVariantConst operator[](const char* key) const { return JsonVariantConst(host_json::member(_s, key)); }
+    bool containsKey(const char* key) const { return host_json::member(_s, key) != nullptr; }
+    size_t size() const { return host_json::count(_s); }
+    const host_json::slot_t* slot() const { return _s; }
+
+protected:
+    const host_json::slot_t* _s;
+};
+
+class JsonArrayConst {
+public:
+    JsonArrayConst(const host_json::slot_t* s = nullptr)
+        : _s(s && s->type == host_json::T_ARRAY ? s : nullptr) {}
+
+    class iterator {
+    public:
+        explicit iterator(const host_json::slot_t* e) : _e(e) {}
+        JsonVariantConst operator*() const { return JsonVariantConst(_e); }
+        iterator& operator++() { _e = _e->next; return *this; }
+        bool operator!=(const iterator& o) const { return _e != o._e; }
+    private:
+        const host_json::slot_t* _e;
+    };
+
+    bool isNull() const { return !_s; }
+    size_t size() const { return host_json::count(_s); }
+    JsonVariantConst operator[](size_t index) const { return JsonVariantConst(host_json::element(_s, index)); }
+    iterator begin() const { return iterator(_s ? _s->v.child : nullptr); }
+    iterator end() const { return iterator(nullptr); }
+    const host_json::slot_t* slot() const { return _s; }
+
+protected:
+    const host_json::slot_t* _s;
+};
+
+// Escritura: solo lo que usa el sketch (objeto raíz leído y array con add)
+class JsonObject : public JsonObjectConst {
+public:
+    JsonObject(const host_json::slot_t* s = nullptr) : JsonObjectConst(s) {}
+};
+
+class JsonArray : public JsonArrayConst {
+public:
+    JsonArray(const host_json::slot_t* s = nullptr, host_json::pool_t* pool = nullptr)
+        : JsonArrayConst(s), _pool(pool) {}
+
+    // Copia profunda al pool del documento de este array
+    bool add(JsonVariantConst v);
+    bool add(JsonObjectConst o) { return add(JsonVariantConst(o.slot())); }
+    bool add(JsonArrayConst a) { return add(JsonVariantConst(a.slot())); }
+
+private:
+    host_json::pool_t* _pool;
+};
+
+namespace host_json {
+
+template <class T> struct conv_view {
+    static bool is(const slot_t* s) { return !T(s).isNull(); }
+    static T as(const slot_t* s) { return T(s); }
+};
+template <> struct conv<JsonObjectConst> : conv_view<JsonObjectConst> {};
+template <> struct conv<JsonObject> : conv_view<JsonObject> {};
+template <> struct conv<JsonArrayConst> : conv_view<JsonArrayConst> {};
+template <> struct conv<JsonArray> : conv_view<JsonArray> {};
+template <> struct conv<JsonVariantConst> {
+    static bool is(const slot_t*) { return true; }
+    static JsonVariantConst as(const slot_t* s) { return JsonVariantConst(s); }
+};
+
+static inline slot_t* copy(pool_t* pool, const slot_t* src) {
+    slot_t* dst = pool->alloc_slot();
+    if (!dst) return nullptr;
+    dst->type = src->type;
+    dst->v = src->v;
+    if (src->type == T_STRING && !(dst->v.s = pool->save_string(src->v.s, strlen(src->v.s)))) return nullptr;
+    if (src->type == T_ARRAY || src->type == T_OBJECT) {
+        slot_t** tail = &dst->v.child;
+        *tail = nullptr;
+        for (const slot_t* e = src->v.child; e; e = e->next) {
+            slot_t* c = copy(pool, e);
+            if (!c) return nullptr;
+            if (e->key && !(c->key = pool->save_string(e->key, strlen(e->key)))) return nullptr;
+            *tail = c;
+            tail = &c->next;
+        }
+    }
+    return dst;
+}
+
+}  // namespace host_json
+
+template <class T> bool JsonVariantConst::is() const { return host_json::conv<T>::is(_s); }
+template <class T> T JsonVariantConst::as() const { return host_json::conv<T>::as(_s); }
+
+inline bool JsonArray::add(JsonVariantConst v) {
+    if (!_s || !_pool) return false;
+    host_json::slot_t* e = v.slot() ? host_json::copy(_pool, v.slot()) : _pool->alloc_slot();
+    if (!e) return false;
+    e->key = nullptr;
+    e->next = nullptr;
+    host_json::slot_t** tail = &const_cast<host_json::slot_t*>(_s)->v.child;
+    while (*tail) tail = &(*tail)->next;
+    *tail = e;
+    return true;
+}
+
+// ============ Documento ============
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code c = Ok) : _code(c) {}
+    explicit operator bool() const { return _code != Ok; }
+    bool operator==(Code c) const { return _code == c; }
+    bool operator!=(Code c) const { return _code != c; }
+    Code code() const { return _code; }
+    const char* c_str() const {
+        static const char* names[] = { "Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep" };
+        return names[_code];
+    }
+
+private:
+    Code _code;
+};
+
+class JsonDocument {
+public:
+    void clear() {
+        _pool.clear();
+        memset(&_root, 0, sizeof(_root));
+    }
+
+    template <class T> bool is() const { return host_json::conv<T>::is(&_root); }
+    template <class T> T as() const { return host_json::conv<T>::as(&_root); }
+    JsonVariantConst operator[](const char* key) const { return JsonVariantConst(&_root)[key]; }
+    bool containsKey(const char* key) const { return host_json::member(&_root, key) != nullptr; }
+    size_t size() const { return host_json::count(&_root); }
+    bool isNull() const { return _root.type == host_json::T_NULL; }
+
+    // Raíz como array vacío (el documento se vacía antes)
+    JsonArray createNestedArray() {
+        clear();
+        _root.type = host_json::T_ARRAY;
+        return JsonArray(&_root, &_pool);
+    }
+
+    size_t memoryUsage() const { return _pool.used; }
+    size_t capacity() const { return _pool.capacity; }
+    bool overflowed() const { return _pool.overflowed; }
+
+    host_json::slot_t* root() { return &_root; }
+    const host_json::slot_t* root() const { return &_root; }
+    host_json::pool_t* pool() { return &_pool; }
+
+protected:
+    JsonDocument(host_json::slot_t* slots, char* strings, size_t capacity) {
+        _pool.slots = slots;
+        _pool.strings = strings;
+        _pool.capacity = capacity;
+        clear();
+    }
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+private:
+    host_json::pool_t _pool;
+    host_json::slot_t _root;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(_slots, _strings, N) {}
+
+private:
+    host_json::slot_t _slots[N / ARDUINOJSON_HOST_SLOT_SIZE + 1];
+    char _strings[N + 1];
+};
+
+// ============ Lectura ============
+namespace host_json {
+
+class parser_t {
+public:
+    parser_t(pool_t* pool, const char* p, size_t len) : _pool(pool), _p(p), _end(p + len) {}
+
+    DeserializationError::Code parse_root(slot_t* root) {
+        skip_ws();
+        if (_p == _end) return DeserializationError::EmptyInput;
+        return parse_value(root, ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+    }
+
+private:
+    typedef DeserializationError E;
+
+    pool_t* _pool;
+    const char* _p;
+    const char* _end;
+    char _buf[256];         // cadena en curso antes de copiarla al pool
+
+    void skip_ws() {
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) _p++;
+    }
+
+    bool literal(const char* word) {
+        size_t n = strlen(word);
+        if ((size_t)(_end - _p) < n) { _p = _end; return false; }
+        if (memcmp(_p, word, n) != 0) return false;
+        _p += n;
+        return true;
+    }
+
+    E::Code parse_value(slot_t* s, int depth) {
+        skip_ws();
+        if (_p == _end) return E::IncompleteInput;
+        switch (*_p) {
+        case '{': return depth ? parse_object(s, depth - 1) : E::TooDeep;
+        case '[': return depth ? parse_array(s, depth - 1) : E::TooDeep;
+        case '"':
+        case '\'': {
+            const char* str;
+            E::Code c = parse_string(&str);
+            if (c != E::Ok) return c;
+            s->type = T_STRING;
+            s->v.s = str;
+            return E::Ok;
+        }
+        case 't':
+            if (!literal("true")) return _p == _end ? E::IncompleteInput : E::InvalidInput;
+            s->type = T_BOOL; s->v.b = true;
+            return E::Ok;
+        case 'f':
+            if (!literal("false")) return _p == _end ? E::IncompleteInput : E::InvalidInput;
+            s->type = T_BOOL; s->v.b = false;
+            return E::Ok;
+        case 'n':
+            if (!literal("null")) return _p == _end ? E::IncompleteInput : E::InvalidInput;
+            s->type = T_NULL;
+            return E::Ok;
+        default:
+            return parse_number(s);
+        }
+    }
+
+    E::Code parse_number(slot_t* s) {
+        const char* start = _p;
+        bool isFloat = false;
+        if (_p < _end && (*_p == '-' || *_p == '+')) _p++;
+        while (_p < _end && ((*_p >= '0' && *_p <= '9') || *_p == '.' || *_p == 'e' || *_p == 'E' ||
+                             ((*_p == '-' || *_p == '+') && (_p[-1] == 'e' || _p[-1] == 'E')))) {
+            if (*_p == '.' || *_p == 'e' || *_p == 'E') isFloat = true;
+            _p++;
+        }
+        size_t n = _p - start;
+        if (!n || n >= 64) return n ? E::InvalidInput : E::InvalidInput;
+        if (_p == _end && n == 0) return E::IncompleteInput;
+        char tmp[64];
+        memcpy(tmp, start, n);
+        tmp[n] = '\0';
+        char* endp;
+        if (!isFloat) {
+            long long v = strtoll(tmp, &endp, 10);
+            if (*endp == '\0') { s->type = T_INT; s->v.i = v; return E::Ok; }
+        }
+        double d = strtod(tmp, &endp);
+        if (*endp != '\0') return E::InvalidInput;
+        s->type = T_FLOAT;
+        s->v.f = d;
+        return E::Ok;
+    }
+
+    static void put_utf8(char* dst, size_t &n, uint32_t cp) {
+        if (cp < 0x80) dst[n++] = (char)cp;
+        else if (cp < 0x800) { dst[n++] = (char)(0xC0 | cp >> 6); dst[n++] = (char)(0x80 | (cp & 0x3F)); }
+        else { dst[n++] = (char)(0xE0 | cp >> 12); dst[n++] = (char)(0x80 | ((cp >> 6) & 0x3F)); dst[n++] = (char)(0x80 | (cp & 0x3F)); }
+    }
+
+    E::Code parse_string(const char** out) {
+        char quote = *_p++;
+        size_t n = 0;
+        while (true) {
+            if (_p == _end) return E::IncompleteInput;
+            char c = *_p++;
+            if (c == quote) break;
+            if (c == '\\') {
+                if (_p == _end) return E::IncompleteInput;
+                c = *_p++;
+                switch (c) {
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u': {
+                    if (_end - _p < 4) { _p = _end; return E::IncompleteInput; }
+                    char hex[5] = { _p[0], _p[1], _p[2], _p[3], 0 };
+                    char* endp;
+                    uint32_t cp = (uint32_t)strtoul(hex, &endp, 16);
+                    if (*endp) return E::InvalidInput;
+                    _p += 4;
+                    if (n + 3 >= sizeof(_buf)) return E::NoMemory;
+                    put_utf8(_buf, n, cp);
+                    continue;
+                }
+                default: break;         // \" \\ \/ y el resto tal cual
+                }
+            }
+            if (n + 1 >= sizeof(_buf)) return E::NoMemory;
+            _buf[n++] = c;
+        }
+        *out = _pool->save_string(_buf, n);
+        return *out ? E::Ok : E::NoMemory;
+    }
+
+    E::Code parse_array(slot_t* s, int depth) {
+        _p++;
+        s->type = T_ARRAY;
+        s->v.child = nullptr;
+        slot_t** tail = &s->v.child;
+        skip_ws();
+        if (_p == _end) return E::IncompleteInput;
+        if (*_p == ']') { _p++; return E::Ok; }
+        while (true) {
+            slot_t* e = _pool->alloc_slot();
+            if (!e) return E::NoMemory;
+            *tail = e;
+            tail = &e->next;
+            E::Code c = parse_value(e, depth);
+            if (c != E::Ok) return c;
+            skip_ws();
+            if (_p == _end) return E::IncompleteInput;
+            if (*_p == ',') { _p++; continue; }
+            if (*_p == ']') { _p++; return E::Ok; }
+            return E::InvalidInput;
+        }
+    }
+
+    E::Code parse_object(slot_t* s, int depth) {
+        _p++;
+        s->type = T_OBJECT;
+        s->v.child = nullptr;
+        slot_t** tail = &s->v.child;
+        skip_ws();
+        if (_p == _end) return E::IncompleteInput;
+        if (*_p == '}') { _p++; return E::Ok; }
+        while (true) {
+            skip_ws();
+            if (_p == _end) return E::IncompleteInput;
+            if (*_p != '"' && *_p != '\'') return E::InvalidInput;
+            const char* key;
+            E::Code c = parse_string(&key);
+            if (c != E::Ok) return c;
+            skip_ws();
+            if (_p == _end) return E::IncompleteInput;
+            if (*_p++ != ':') return E::InvalidInput;
+            slot_t* m = _pool->alloc_slot();
+            if (!m) return E::NoMemory;
+            m->key = key;
+            *tail = m;
+            tail = &m->next;
+            c = parse_value(m, depth);
+            if (c != E::Ok) return c;
+            skip_ws();
+            if (_p == _end) return E::IncompleteInput;
+            if (*_p == ',') { _p++; continue; }
+            if (*_p == '}') { _p++; return E::Ok; }
+            return E::InvalidInput;
+        }
+    }
+};
+
+}  // namespace host_json
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t len) {
+    doc.clear();
+    if (!input) return DeserializationError::EmptyInput;
+    host_json::parser_t parser(doc.pool(), input, len);
+    return DeserializationError(parser.parse_root(doc.root()));
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const uint8_t* input, size_t len) {
+    return deserializeJson(doc, (const char*)input, len);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+    return deserializeJson(doc, input, input ? strlen(input) : 0);
+}
+
+// ============ Escritura ============
+namespace host_json {
+
+struct writer_t {
+    char* out;
+    size_t cap;
+    size_t n;
+
+    void put(char c) {
+        if (n + 1 < cap) out[n] = c;
+        n++;
+    }
+    void put(const char* s) { while (*s) put(*s++); }
+
+    void string(const char* s) {
+        put('"');
+        for (; *s; s++) {
+            if (*s == '"' || *s == '\\') put('\\');
+            put(*s);
+        }
+        put('"');
+    }
+
+    void value(const slot_t* s) {
+        char tmp[32];
+        switch (s ? s->type : T_NULL) {
+        case T_BOOL:   put(s->v.b ? "true" : "false"); break;
+        case T_INT:    snprintf(tmp, sizeof(tmp), "%lld", (long long)s->v.i); put(tmp); break;
+        case T_FLOAT:  snprintf(tmp, sizeof(tmp), "%.9g", s->v.f); put(tmp); break;
+        case T_STRING: string(s->v.s); break;
+        case T_ARRAY:
+        case T_OBJECT: {
+            bool obj = s->type == T_OBJECT;
+            put(obj ? '{' : '[');
+            for (const slot_t* e = s->v.child; e; e = e->next) {
+                if (e != s->v.child) put(',');
+                if (obj) { string(e->key); put(':'); }
+                value(e);
+            }
+            put(obj ? '}' : ']');
+            break;
+        }
+        default:       put("null"); break;
+        }
+    }
+};
+
+}  // namespace host_json
+
+// Devuelve los bytes escritos (sin el '\0'); trunca si no cabe
+inline size_t serializeJson(JsonVariantConst v, char* out, size_t cap) {
+    host_json::writer_t w = { out, cap, 0 };
+    w.value(v.slot());
+    if (cap) out[w.n < cap ? w.n : cap - 1] = '\0';
+    return w.n < cap ? w.n : (cap ? cap - 1 : 0);
+}
+
+inline size_t serializeJson(const JsonDocument& doc, char* out, size_t cap) {
+    return serializeJson(JsonVariantConst(doc.root()), out, cap);
+}
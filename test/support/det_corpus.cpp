@@ -0,0 +1,32 @@
+#include "det_corpus.h"
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+std::vector<det_message_t> det_corpus_load(const char* dir) {
+    std::vector<det_message_t> out;
+    DIR* d = opendir(dir);
+    if (!d) return out;
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        size_t us = name.find('_'), dot = name.rfind('.');
+        if (us == std::string::npos || dot == std::string::npos) continue;
+        std::string ext = name.substr(dot);
+        if (ext != ".json" && ext != ".bin") continue;
+        FILE* f = fopen((std::string(dir) + "/" + name).c_str(), "rb");
+        if (!f) continue;
+        det_message_t m;
+        m.name = name.substr(0, dot);
+        m.binary = ext == ".bin";
+        m.boxes = atoi(name.c_str() + us + 1);
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) m.data.insert(m.data.end(), buf, buf + n);
+        fclose(f);
+        out.push_back(m);
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end(), [](const det_message_t &a, const det_message_t &b) { return a.name < b.name; });
+    return out;
+}
@@ -0,0 +1,16 @@
+#pragma once
+// Corpus de mensajes de detecciones del servidor (bench/corpus): <formato>_<cajas>.json
+// o .bin (det_proto). Lo comparten test_det_parse y bench_det_parse.
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct det_message_t {
+    std::string name;           // sin extensión
+    std::vector<uint8_t> data;
+    bool binary;
+    int boxes;                  // cajas en el mensaje (del nombre)
+};
+
+// Mensajes del directorio ordenados por nombre (vacío si no existe)
+std::vector<det_message_t> det_corpus_load(const char* dir);
@@ -0,0 +1,53 @@
+#pragma once
+// Tipos de esp32-camera que usan los módulos del sketch. Sin driver: esp_camera_fb_get()
+// devuelve nullptr; las pruebas inyectan su origen con frame_pool_init().
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_YUV420,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+    PIXFORMAT_RGB888,
+} pixformat_t;
+
+typedef enum {
+    FRAMESIZE_96X96,
+    FRAMESIZE_QQVGA,
+    FRAMESIZE_QCIF,
+    FRAMESIZE_HQVGA,
+    FRAMESIZE_240X240,
+    FRAMESIZE_QVGA,
+    FRAMESIZE_CIF,
+    FRAMESIZE_HVGA,
+    FRAMESIZE_VGA,
+    FRAMESIZE_SVGA,
+    FRAMESIZE_XGA,
+    FRAMESIZE_INVALID
+} framesize_t;
+
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval timestamp;
+} camera_fb_t;
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    int aspect_ratio;
+} resolution_info_t;
+extern const resolution_info_t resolution[];
+
+camera_fb_t* esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t* fb);
@@ -0,0 +1,14 @@
+#pragma once
+// heap_caps_* sobre malloc: en el PC no hay PSRAM ni SRAM interna separadas
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+static inline void heap_caps_free(void* p) { free(p); }
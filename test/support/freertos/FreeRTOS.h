@@ -0,0 +1,41 @@
+#pragma once
+// Sustituto mínimo de FreeRTOS sobre hilos del sistema: 1 tick = 1 ms.
+#include <stdint.h>
+#include <atomic>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7fffffff
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+
+// Sección crítica = spinlock (como portMUX entre los dos núcleos; no recursivo)
+struct portMUX_TYPE {
+    std::atomic<bool> locked;
+};
+#define portMUX_INITIALIZER_UNLOCKED { false }
+
+static inline void host_mux_enter(portMUX_TYPE* m) {
+    while (m->locked.exchange(true, std::memory_order_acquire)) {
+        while (m->locked.load(std::memory_order_relaxed)) {}
+    }
+}
+static inline void host_mux_exit(portMUX_TYPE* m) {
+    m->locked.store(false, std::memory_order_release);
+}
+#define portENTER_CRITICAL(m) host_mux_enter(m)
+#define portEXIT_CRITICAL(m)  host_mux_exit(m)
+
+struct host_task_t;
+typedef host_task_t* TaskHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
@@ -0,0 +1,8 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Cola de elementos de tamaño fijo copiados (como FreeRTOS); espera en ticks (ms)
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
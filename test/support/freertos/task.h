@@ -0,0 +1,9 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Cada hilo es una "tarea" con su contador de notificación (xTaskNotifyGive / ulTaskNotifyTake)
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
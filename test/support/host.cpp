@@ -0,0 +1,182 @@
+#include "host.h"
+#include <Arduino.h>
+#include "esp_camera.h"
+#include "freertos/queue.h"
+#include "app_log.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+
+// ============ Tiempo ============
+static const std::chrono::steady_clock::time_point gStart = std::chrono::steady_clock::now();
+
+static int64_t elapsed_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - gStart).count();
+}
+
+unsigned long millis() { return (unsigned long)(elapsed_us() / 1000); }
+unsigned long micros() { return (unsigned long)elapsed_us(); }
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+int64_t esp_timer_get_time() { return elapsed_us(); }
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - gStart).count();
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+
+int HardwareSerial::printf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+size_t HardwareSerial::print(const char* s) { return fputs(s, stdout) < 0 ? 0 : strlen(s); }
+size_t HardwareSerial::println(const char* s) { return print(s) + print("\n"); }
+size_t HardwareSerial::write(const uint8_t* p, size_t n) { return fwrite(p, 1, n, stdout); }
+void HardwareSerial::flush() { fflush(stdout); }
+
+// ============ Tareas ============
+struct host_task_t {
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t count = 0;
+};
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    static thread_local host_task_t self;
+    return &self;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return;
+    std::lock_guard<std::mutex> lock(task->m);
+    task->count++;
+    task->cv.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    host_task_t* t = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(t->m);
+    if (ticks == portMAX_DELAY) t->cv.wait(lock, [t] { return t->count > 0; });
+    else t->cv.wait_for(lock, std::chrono::milliseconds(ticks), [t] { return t->count > 0; });
+    uint32_t n = t->count;
+    if (n) t->count = clear ? 0 : n - 1;
+    return n;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+// ============ Colas ============
+struct host_queue_t {
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t>> items;
+    size_t len, itemSize;
+};
+
+// Espera a que pred() se cumpla (ticks = ms; portMAX_DELAY = sin límite)
+template <class Pred>
+static bool wait_for(host_queue_t* q, std::unique_lock<std::mutex> &lock, TickType_t ticks, Pred pred) {
+    if (ticks == portMAX_DELAY) { q->cv.wait(lock, pred); return true; }
+    return q->cv.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t itemSize) {
+    host_queue_t* q = new host_queue_t;
+    q->len = len;
+    q->itemSize = itemSize;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t h, const void* item, TickType_t ticks) {
+    host_queue_t* q = (host_queue_t*)h;
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!wait_for(q, lock, ticks, [q] { return q->items.size() < q->len; })) return pdFALSE;
+    const uint8_t* p = (const uint8_t*)item;
+    q->items.emplace_back(p, p + q->itemSize);
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t h, void* item, TickType_t ticks) {
+    host_queue_t* q = (host_queue_t*)h;
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!wait_for(q, lock, ticks, [q] { return !q->items.empty(); })) return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t h) {
+    host_queue_t* q = (host_queue_t*)h;
+    std::lock_guard<std::mutex> lock(q->m);
+    return (UBaseType_t)q->items.size();
+}
+
+// ============ Cámara ============
+// Sin driver: las pruebas usan su propio frame_source_t
+camera_fb_t* esp_camera_fb_get() { return nullptr; }
+void esp_camera_fb_return(camera_fb_t*) {}
+
+const resolution_info_t resolution[] = {
+    {   96,   96, 0 }, {  160,  120, 0 }, {  176,  144, 0 }, {  240,  176, 0 },
+    {  240,  240, 0 }, {  320,  240, 0 }, {  400,  296, 0 }, {  480,  320, 0 },
+    {  640,  480, 0 }, {  800,  600, 0 }, { 1024,  768, 0 },
+};
+
+// ============ Log ============
+// Sustituye a app_log.cpp (sin tarea de vaciado): cuenta y, con CAMARA_LOG=1, imprime
+static std::atomic<uint32_t> gLogCount[APP_LOG_VERBOSE + 1];
+
+void app_log_write(uint8_t level, const char* tag, const char* fmt, ...) {
+    if (level <= APP_LOG_VERBOSE) gLogCount[level]++;
+    static const bool print = getenv("CAMARA_LOG") && atoi(getenv("CAMARA_LOG"));
+    if (!print) return;
+    char text[APP_LOG_MSG_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    static const char lv[] = "-EWIDV";
+    fprintf(stderr, "%c %s: %s\n", lv[level <= APP_LOG_VERBOSE ? level : 0], tag, text);
+}
+
+void app_log_init() {}
+uint32_t app_log_dropped() { return 0; }
+
+uint32_t host_log_count(uint8_t level) {
+    return level <= APP_LOG_VERBOSE ? gLogCount[level].load() : 0;
+}
+
+// ============ Pruebas ============
+double host_env_seconds(const char* name, double def) {
+    const char* v = getenv(name);
+    return v && *v ? atof(v) : def;
+}
+
+static std::atomic<int> gFailures{0};
+
+bool host_check(bool ok, const char* what, const char* file, int line) {
+    if (!ok) {
+        fprintf(stderr, "%s:%d: FALLO: %s\n", file, line, what);
+        gFailures++;
+    }
+    return ok;
+}
+
+int host_test_result() {
+    int n = gFailures.load();
+    if (n) fprintf(stderr, "%d comprobaciones fallidas\n", n);
+    return n ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+// Utilidades de las pruebas en el PC sobre los sustitutos de test/support
+#include <stdint.h>
+#include <stddef.h>
+
+// Mensajes LOG_x emitidos por nivel (APP_LOG_ERROR..APP_LOG_VERBOSE). Con la
+// variable de entorno CAMARA_LOG=1 además se imprimen por stderr.
+uint32_t host_log_count(uint8_t level);
+
+// Reservas de memoria del proceso (operator new + malloc) desde el arranque.
+// Solo cuentan los ejecutables que enlazan host_alloc.cpp.
+struct host_alloc_stats_t {
+    uint64_t count;
+    uint64_t bytes;
+};
+void host_alloc_get(host_alloc_stats_t* out);
+
+// Duración de las pruebas largas: variable de entorno `name` en segundos o `def`
+double host_env_seconds(const char* name, double def);
+
+// Fallo de una comprobación: imprime y cuenta; host_test_result() da el código de salida
+#define CHECK(cond) host_check((cond), #cond, __FILE__, __LINE__)
+bool host_check(bool ok, const char* what, const char* file, int line);
+int host_test_result();
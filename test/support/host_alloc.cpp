@@ -0,0 +1,42 @@
+#include "host.h"
+#include <atomic>
+#include <stdlib.h>
+
+// Cuenta las reservas del proceso envolviendo malloc de glibc (operator new
+// de libstdc++ también pasa por aquí). No enlazar en los ejecutables con TSan/ASan,
+// que ya interceptan malloc.
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+}
+
+static std::atomic<uint64_t> gCount{0};
+static std::atomic<uint64_t> gBytes{0};
+
+extern "C" void* malloc(size_t n) {
+    gCount.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    return __libc_malloc(n);
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+    gCount.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n * size, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* p, size_t n) {
+    gCount.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    return __libc_realloc(p, n);
+}
+
+extern "C" void free(void* p) { __libc_free(p); }
+
+void host_alloc_get(host_alloc_stats_t* out) {
+    if (!out) return;
+    out->count = gCount.load(std::memory_order_relaxed);
+    out->bytes = gBytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,122 @@
+#include "img_converters.h"
+#include <stdio.h>
+#include <setjmp.h>
+#include <string.h>
+#include <jpeglib.h>
+#include <jerror.h>
+
+// fmt2jpg_cb de esp32-camera sobre libjpeg: misma entrada (RGB565 big-endian como
+// lo entrega el sensor, o escala de grises), croma 2x1 (H2V1, como jpge en to_jpg.cpp)
+// y salida por bloques al callback. El tamaño y el tiempo son los de libjpeg en
+// el PC, no los del ESP32: sirven para comparar calidades y escenas entre sí.
+
+#define OUT_CHUNK 1024
+
+struct cb_dest_t {
+    jpeg_destination_mgr pub;
+    jpg_out_cb cb;
+    void* arg;
+    size_t index;
+    bool failed;
+    JOCTET buf[OUT_CHUNK];
+};
+
+struct err_t {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+static void on_error(j_common_ptr cinfo) {
+    longjmp(((err_t*)cinfo->err)->jump, 1);
+}
+
+static bool emit(cb_dest_t* d, size_t len) {
+    if (!len) return true;
+    if (d->cb(d->arg, d->index, d->buf, len) != len) {
+        d->failed = true;
+        return false;
+    }
+    d->index += len;
+    return true;
+}
+
+static void init_destination(j_compress_ptr cinfo) {
+    cb_dest_t* d = (cb_dest_t*)cinfo->dest;
+    d->pub.next_output_byte = d->buf;
+    d->pub.free_in_buffer = OUT_CHUNK;
+}
+
+static boolean empty_output_buffer(j_compress_ptr cinfo) {
+    cb_dest_t* d = (cb_dest_t*)cinfo->dest;
+    if (!emit(d, OUT_CHUNK)) ERREXIT(cinfo, JERR_FILE_WRITE);
+    d->pub.next_output_byte = d->buf;
+    d->pub.free_in_buffer = OUT_CHUNK;
+    return TRUE;
+}
+
+static void term_destination(j_compress_ptr cinfo) {
+    cb_dest_t* d = (cb_dest_t*)cinfo->dest;
+    if (!emit(d, OUT_CHUNK - d->pub.free_in_buffer)) ERREXIT(cinfo, JERR_FILE_WRITE);
+}
+
+bool fmt2jpg_cb(uint8_t* src, size_t src_len, uint16_t width, uint16_t height,
+                pixformat_t format, uint8_t quality, jpg_out_cb cb, void* arg) {
+    int bpp = format == PIXFORMAT_RGB565 ? 2 : (format == PIXFORMAT_GRAYSCALE ? 1 : 0);
+    if (!src || !cb || !bpp || src_len < (size_t)width * height * bpp) return false;
+
+    jpeg_compress_struct cinfo;
+    err_t err;
+    cb_dest_t dest;
+    // Fila RGB888 de trabajo (el codificador lee por franjas, nunca el frame convertido)
+    JSAMPLE* row = new JSAMPLE[(size_t)width * 3];
+
+    cinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = on_error;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        delete[] row;
+        return false;
+    }
+    jpeg_create_compress(&cinfo);
+
+    memset(&dest, 0, sizeof(dest));
+    dest.pub.init_destination = init_destination;
+    dest.pub.empty_output_buffer = empty_output_buffer;
+    dest.pub.term_destination = term_destination;
+    dest.cb = cb;
+    dest.arg = arg;
+    cinfo.dest = &dest.pub;
+
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = bpp == 2 ? 3 : 1;
+    cinfo.in_color_space = bpp == 2 ? JCS_RGB : JCS_GRAYSCALE;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    if (bpp == 2) {
+        cinfo.comp_info[0].h_samp_factor = 2;
+        cinfo.comp_info[0].v_samp_factor = 1;
+    }
+    jpeg_start_compress(&cinfo, TRUE);
+
+    while (cinfo.next_scanline < cinfo.image_height) {
+        const uint8_t* s = src + (size_t)cinfo.next_scanline * width * bpp;
+        if (bpp == 2) {
+            for (int x = 0; x < width; x++) {
+                uint16_t p = (uint16_t)(s[2 * x] << 8 | s[2 * x + 1]);
+                uint8_t r = (p >> 11) & 0x1F, g = (p >> 5) & 0x3F, b = p & 0x1F;
+                row[3 * x]     = (JSAMPLE)(r << 3 | r >> 2);
+                row[3 * x + 1] = (JSAMPLE)(g << 2 | g >> 4);
+                row[3 * x + 2] = (JSAMPLE)(b << 3 | b >> 2);
+            }
+        } else {
+            memcpy(row, s, width);
+        }
+        JSAMPROW rows[1] = { row };
+        jpeg_write_scanlines(&cinfo, rows, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    delete[] row;
+    return !dest.failed;
+}
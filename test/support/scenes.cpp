@@ -0,0 +1,95 @@
+#include "scenes.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+static const char* kNames[SCENE_COUNT] = { "cara", "escritorio", "liso", "ruido" };
+
+const char* scene_name(int kind) {
+    return kind >= 0 && kind < SCENE_COUNT ? kNames[kind] : "?";
+}
+
+// xorshift32: determinista y sin estado global
+static uint32_t rnd(uint32_t &s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+static int clamp255(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+
+static void put(uint8_t* p, int r, int g, int b) {
+    uint16_t v = (uint16_t)((clamp255(r) >> 3) << 11 | (clamp255(g) >> 2) << 5 | (clamp255(b) >> 3));
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+void scene_render(uint8_t* rgb565, int w, int h, int kind, uint32_t frame, uint32_t seed) {
+    uint32_t s = seed * 2654435761u + frame * 40503u + 1;
+    // Cara: centro que recorre el frame en horizontal, tamaño proporcional al lado
+    float cx = w * (0.3f + 0.4f * (float)((frame * 7) % 100) / 100.0f);
+    float cy = h * 0.45f;
+    float rx = w * 0.16f, ry = h * 0.22f;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint8_t* p = rgb565 + ((size_t)y * w + x) * 2;
+            int n = (int)(rnd(s) % 7) - 3;      // ruido de sensor +-3
+            switch (kind) {
+            case SCENE_FACE: {
+                int r = 60 + 100 * y / h, g = 80 + 60 * x / w, b = 140 - 60 * y / h;
+                float dx = (x - cx) / rx, dy = (y - cy) / ry;
+                if (dx * dx + dy * dy < 1.0f) {
+                    r = 220; g = 170; b = 140;
+                    float ex = fabsf(dx) - 0.4f, ey = dy + 0.25f;
+                    if (ex * ex + ey * ey < 0.02f) { r = 30; g = 30; b = 40; }
+                }
+                put(p, r + n, g + n, b + n);
+                break;
+            }
+            case SCENE_DESK: {
+                bool stripe = ((x / 6) & 1) ^ ((y / 40) & 1);
+                bool text = (y % 24) < 10 && (x % 9) < 6 && ((x * 31 + y * 17 + (x / 9) * 5) % 7) < 4;
+                int v = stripe ? 200 : 70;
+                if (text) v = 20;
+                put(p, v + n, v + 10 + n, v - 10 + n);
+                break;
+            }
+            case SCENE_FLAT:
+                put(p, 120 + n, 130 + n, 110 + n);
+                break;
+            default: {
+                uint32_t r = rnd(s);
+                p[0] = r & 0xFF;
+                p[1] = (r >> 8) & 0xFF;
+                break;
+            }
+            }
+        }
+    }
+}
+
+std::vector<scene_file_t> scene_load_recorded() {
+    std::vector<scene_file_t> out;
+    const char* dir = getenv("CAMARA_FRAMES");
+    if (!dir || !*dir) return out;
+    DIR* d = opendir(dir);
+    if (!d) return out;
+    while (dirent* e = readdir(d)) {
+        int w = 0, h = 0;
+        const char* us = strrchr(e->d_name, '_');
+        if (!us || sscanf(us, "_%dx%d.rgb565", &w, &h) != 2 || w <= 0 || h <= 0) continue;
+        std::string path = std::string(dir) + "/" + e->d_name;
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) continue;
+        scene_file_t s = { e->d_name, w, h, std::vector<uint8_t>((size_t)w * h * 2) };
+        bool ok = fread(s.data.data(), 1, s.data.size(), f) == s.data.size();
+        fclose(f);
+        if (ok) out.push_back(std::move(s));
+    }
+    closedir(d);
+    return out;
+}
@@ -0,0 +1,30 @@
+#pragma once
+// Frames sintéticos RGB565 big-endian (orden de la cámara) para las pruebas y, si
+// se indica, frames grabados del ESP32.
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+enum scene_kind_t {
+    SCENE_FACE,     // fondo degradado, cara (elipse) que se desplaza con `frame`, ruido de sensor
+    SCENE_DESK,     // bordes, rayas y bloques de "texto": mucho detalle
+    SCENE_FLAT,     // color liso con ruido de sensor (lo más comprimible)
+    SCENE_NOISE,    // ruido puro (peor caso del codificador)
+    SCENE_COUNT
+};
+
+const char* scene_name(int kind);
+
+// Rellena w x h píxeles. Mismo (kind, frame, seed) -> mismos bytes.
+void scene_render(uint8_t* rgb565, int w, int h, int kind, uint32_t frame, uint32_t seed = 1);
+
+// Frame grabado: volcado crudo del fb (RGB565) con nombre <algo>_<W>x<H>.rgb565
+struct scene_file_t {
+    std::string name;
+    int w, h;
+    std::vector<uint8_t> data;
+};
+
+// Lee los .rgb565 del directorio de la variable de entorno CAMARA_FRAMES (si existe)
+std::vector<scene_file_t> scene_load_recorded();
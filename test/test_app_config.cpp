@@ -0,0 +1,141 @@
+// app_config: con cambio de cámara, "save" espera a que el driver arranque; si
+// falla se vuelve a la configuración en marcha sin tocar la NVS, y un cambio
+// posterior en cola no se pisa. Sin cámara, se guarda al momento.
+#include "app_config.h"
+#include "app_log.h"
+#include "camera.h"
+#include "frame_pool.h"
+#include "host.h"
+#include <Preferences.h>
+
+// Módulos de uplink/captura: app_config_apply_runtime solo los configura
+void rate_ctrl_set_max_fps(uint32_t) {}
+void rate_ctrl_set_uplink_shift(uint8_t) {}
+void jpeg_encoder_set_enabled(bool) {}
+void jpeg_encoder_set_quality(int) {}
+void roi_uplink_set_enabled(bool) {}
+void motion_gate_set_enabled(bool) {}
+void uplink_window_set_size(uint8_t) {}
+
+static char gReply[APP_CFG_REPLY_LEN];
+
+// Comando del servidor; deja la respuesta en gReply
+static void command(const char* json) {
+    StaticJsonDocument<JSON_OBJECT_SIZE(16) + 512> doc;
+    CHECK(!deserializeJson(doc, json));
+    CHECK(app_config_command(doc.as<JsonObjectConst>()));
+    gReply[0] = '\0';
+    CHECK(app_config_take_reply(gReply, sizeof(gReply)));
+}
+
+static bool reply_has(const char* s) { return strstr(gReply, s) != nullptr; }
+
+// Configuración guardada en NVS (false si no hay)
+static bool stored(app_config_t* out) {
+    Preferences prefs;
+    prefs.begin("camara", true);
+    bool ok = prefs.getBytes("cfg", out, sizeof(*out)) == sizeof(*out);
+    prefs.end();
+    return ok;
+}
+
+static void boot() {
+    host_nvs_clear();
+    app_config_load();
+}
+
+// El driver no arranca con la nueva: ni NVS ni gCfg se quedan con ella
+static void test_camera_fails() {
+    boot();
+    app_config_t running, c, nvs;
+    app_config_get(&running);
+
+    command("{\"cmd\":\"config\",\"framesize\":\"SVGA\",\"fps\":12,\"save\":true}");
+    CHECK(reply_has("\"camera\":\"pendiente\"") && reply_has("\"saved\":\"pendiente\""));
+    CHECK(!stored(&nvs));
+    CHECK(app_config_take_camera_change(&c) && c.framesize == FRAMESIZE_SVGA);
+
+    uint32_t warns = host_log_count(APP_LOG_WARN);
+    CHECK(!app_config_camera_applied(running, false));
+    CHECK(host_log_count(APP_LOG_WARN) - warns == 1);
+    CHECK(!stored(&nvs));
+    app_config_get(&c);
+    CHECK(c.framesize == running.framesize);
+    CHECK(c.max_fps == 12);         // lo que no es de cámara sí se quedó aplicado
+}
+
+// Arranca: se guarda entonces, con la cámara nueva
+static void test_camera_ok() {
+    boot();
+    app_config_t c, nvs;
+    command("{\"cmd\":\"config\",\"framesize\":\"SVGA\",\"fb_count\":2,\"save\":true}");
+    CHECK(!stored(&nvs));
+    CHECK(app_config_take_camera_change(&c));
+    CHECK(app_config_camera_applied(c, true));
+    CHECK(stored(&nvs) && nvs.framesize == FRAMESIZE_SVGA && nvs.fb_count == 2);
+
+    app_config_load();              // siguiente arranque
+    app_config_get(&c);
+    CHECK(c.framesize == FRAMESIZE_SVGA && c.fb_count == 2);
+
+    // Sin "save": arranca pero no se guarda
+    command("{\"cmd\":\"config\",\"framesize\":\"VGA\"}");
+    CHECK(app_config_take_camera_change(&c));
+    CHECK(!app_config_camera_applied(c, true));
+    CHECK(stored(&nvs) && nvs.framesize == FRAMESIZE_SVGA);
+}
+
+// Otro cambio llegó mientras se aplicaba el primero: el fallo no lo deshace
+static void test_newer_pending() {
+    boot();
+    app_config_t running, first, c, nvs;
+    app_config_get(&running);
+    command("{\"cmd\":\"config\",\"framesize\":\"SVGA\",\"save\":true}");
+    CHECK(app_config_take_camera_change(&first));
+    command("{\"cmd\":\"config\",\"framesize\":\"HVGA\",\"save\":true}");
+
+    CHECK(!app_config_camera_applied(running, false));
+    app_config_get(&c);
+    CHECK(c.framesize == FRAMESIZE_HVGA);
+    CHECK(app_config_take_camera_change(&c) && c.framesize == FRAMESIZE_HVGA);
+    CHECK(app_config_camera_applied(c, true));
+    CHECK(stored(&nvs) && nvs.framesize == FRAMESIZE_HVGA);
+}
+
+// Sin cambio de cámara: se guarda con el comando
+static void test_save_now() {
+    boot();
+    app_config_t c, nvs;
+    command("{\"cmd\":\"config\",\"fps\":8,\"save\":true}");
+    CHECK(reply_has("\"camera\":false") && reply_has("\"saved\":true"));
+    CHECK(!app_config_take_camera_change(&c));
+    CHECK(stored(&nvs) && nvs.max_fps == 8);
+}
+
+// Arranque con una guardada que no funciona: camera_init usa los campos compilados
+static void test_defaults() {
+    boot();
+    app_config_t c, d;
+    command("{\"cmd\":\"config\",\"framesize\":\"SVGA\",\"pixformat\":\"jpeg\",\"fb_count\":1,"
+            "\"xclk\":10000000,\"fps\":5}");
+    app_config_get(&c);
+    d = c;
+    app_config_camera_defaults(&d);
+    CHECK(d.framesize == CAMERA_FRAMESIZE && d.pixformat == PIXFORMAT_RGB565);
+    CHECK(d.fb_count == FRAME_POOL_SLOTS && d.xclk_hz == APP_CFG_XCLK_HZ);
+    CHECK(d.max_fps == 5);          // solo los campos de cámara
+
+    app_config_take_camera_change(nullptr);
+    app_config_camera_applied(d, false);
+    app_config_get(&c);
+    CHECK(c.framesize == CAMERA_FRAMESIZE && c.fb_count == FRAME_POOL_SLOTS);
+}
+
+int main() {
+    test_camera_fails();
+    test_camera_ok();
+    test_newer_pending();
+    test_save_now();
+    test_defaults();
+    return host_test_result();
+}
@@ -0,0 +1,222 @@
+// box_tracker sobre secuencias sintéticas: objetos con movimiento conocido,
+// respuestas del servidor con retardo y ruido, y error de la caja pintada en
+// cada frame del panel frente a pintar la última respuesta tal cual.
+#include "box_tracker.h"
+#include "host.h"
+#include <math.h>
+#include <vector>
+
+void deteccion_set_label(Deteccion &d, const char* label) {
+    if (!label) label = "";
+    strncpy(d.label, label, DET_LABEL_LEN - 1);
+    d.label[DET_LABEL_LEN - 1] = '\0';
+}
+
+// Ruido determinista (LCG) en [-amp, amp]
+static uint32_t gSeed = 1;
+static float noise(float amp) {
+    gSeed = gSeed * 1664525u + 1013904223u;
+    return ((gSeed >> 8) / 16777216.0f * 2.0f - 1.0f) * amp;
+}
+
+struct object_t {
+    const char* label;
+    float x0, y0, vx, vy;   // px y px/ms
+    float w, h;
+    float ax;               // aceleración horizontal (px/ms^2)
+    uint32_t from_ms, to_ms; // visible en [from, to)
+
+    bool visible(uint32_t t) const { return t >= from_ms && t < to_ms; }
+    float cx(uint32_t t) const { float s = (float)(t - from_ms); return x0 + vx * s + 0.5f * ax * s * s; }
+    float cy(uint32_t t) const { return y0 + vy * (float)(t - from_ms); }
+};
+
+struct scenario_t {
+    const char* name;
+    std::vector<object_t> objects;
+    uint32_t capture_ms;    // periodo de frames enviados al servidor
+    uint32_t rtt_ms;        // captura -> respuesta
+    float jitter_px;        // ruido de la caja del servidor
+};
+
+struct result_t {
+    double tracked_px;      // error medio del centro pintado (px)
+    double held_px;         // igual, pintando la última respuesta
+    uint32_t samples;
+    uint32_t missing;       // frames con el objeto visible sin caja de su etiqueta
+};
+
+static bool center_of(const Deteccion* d, int n, const char* label, float &cx, float &cy) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(d[i].label, label) != 0) continue;
+        cx = d[i].x + d[i].w * 0.5f;
+        cy = d[i].y + d[i].h * 0.5f;
+        return true;
+    }
+    return false;
+}
+
+// Pasos de 1 ms: captura cada capture_ms, respuesta rtt_ms después, pintado a 30 fps.
+// Se mide desde warm_ms hasta el final.
+static result_t run(const scenario_t &s, uint32_t total_ms, uint32_t warm_ms) {
+    box_tracker_t tracker;
+    box_tracker_reset(&tracker);
+    gSeed = 1;
+
+    struct reply_t { uint32_t at, capture; Deteccion dets[TRACK_MAX]; int n; };
+    std::vector<reply_t> pending;
+    Deteccion held[TRACK_MAX];
+    int heldN = 0;
+    result_t r = {};
+    double errT = 0, errH = 0;
+
+    for (uint32_t t = 0; t < total_ms; t++) {
+        if (t % s.capture_ms == 0) {
+            reply_t rep = { t + s.rtt_ms, t, {}, 0 };
+            for (const object_t &o : s.objects) {
+                if (!o.visible(t) || rep.n == TRACK_MAX) continue;
+                Deteccion &d = rep.dets[rep.n++];
+                deteccion_set_label(d, o.label);
+                d.w = (int)lroundf(o.w + noise(s.jitter_px));
+                d.h = (int)lroundf(o.h + noise(s.jitter_px));
+                d.x = (int)lroundf(o.cx(t) + noise(s.jitter_px) - d.w * 0.5f);
+                d.y = (int)lroundf(o.cy(t) + noise(s.jitter_px) - d.h * 0.5f);
+            }
+            pending.push_back(rep);
+        }
+        while (!pending.empty() && pending.front().at <= t) {
+            const reply_t &rep = pending.front();
+            box_tracker_correct(&tracker, rep.dets, rep.n, rep.capture);
+            memcpy(held, rep.dets, sizeof(held));
+            heldN = rep.n;
+            pending.erase(pending.begin());
+        }
+        if (t % 33 || t < warm_ms) continue;
+
+        Deteccion drawn[TRACK_MAX];
+        int n = box_tracker_predict(&tracker, t, drawn, TRACK_MAX);
+        for (const object_t &o : s.objects) {
+            // solo objetos visibles desde antes de una ida y vuelta (si no, nadie puede verlos)
+            if (!o.visible(t) || t < o.from_ms + s.rtt_ms + s.capture_ms) continue;
+            float tx, ty, hx, hy;
+            if (!center_of(drawn, n, o.label, tx, ty) || !center_of(held, heldN, o.label, hx, hy)) {
+                r.missing++;
+                continue;
+            }
+            float ox = fminf(fmaxf(o.cx(t), 0), WS_DRAW_W), oy = fminf(fmaxf(o.cy(t), 0), WS_DRAW_H);
+            errT += hypotf(tx - ox, ty - oy);
+            errH += hypotf(hx - ox, hy - oy);
+            r.samples++;
+        }
+    }
+    if (r.samples) {
+        r.tracked_px = errT / r.samples;
+        r.held_px = errH / r.samples;
+    }
+    printf("%-26s %4u muestras: error tracker %5.1f px, última respuesta %5.1f px, sin caja %u\n",
+           s.name, (unsigned)r.samples, r.tracked_px, r.held_px, (unsigned)r.missing);
+    return r;
+}
+
+// Velocidad constante: el tracker compensa el RTT
+static void test_constant_velocity() {
+    scenario_t s = { "velocidad constante", {
+        { "face",   30, 120,  0.060f,  0.000f, 50, 60, 0, 0, 4000 },
+        { "person", 200, 40, -0.030f,  0.025f, 40, 80, 0, 0, 4000 },
+    }, 200, 300, 1.5f };
+    result_t r = run(s, 3000, 1000);
+    CHECK(r.samples > 50);
+    CHECK(r.missing == 0);
+    CHECK(r.tracked_px < r.held_px * 0.4);
+    CHECK(r.tracked_px < 6);
+}
+
+// Objeto quieto con ruido: la predicción no debe derivar
+static void test_static() {
+    scenario_t s = { "quieto con ruido", {
+        { "cup", 120, 120, 0, 0, 40, 40, 0, 0, 6000 },
+    }, 200, 300, 3.0f };
+    result_t r = run(s, 5000, 1000);
+    CHECK(r.missing == 0);
+    CHECK(r.tracked_px < 4);
+    CHECK(r.tracked_px <= r.held_px + 1.0);
+}
+
+// Aceleración constante: el modelo de velocidad constante sigue por delante de la última respuesta
+static void test_maneuver() {
+    scenario_t s = { "acelerando", {
+        { "face", 20, 100, 0.01f, 0.0f, 40, 40, 0.00004f, 0, 4000 },
+    }, 150, 250, 1.0f };
+    result_t r = run(s, 2500, 800);
+    CHECK(r.missing == 0);
+    CHECK(r.tracked_px < r.held_px * 0.6);
+}
+
+// Un objeto desaparece: deja de pintarse y se borra tras TRACK_MAX_MISSES respuestas
+static void test_disappear() {
+    box_tracker_t t;
+    box_tracker_reset(&t);
+    Deteccion d = {};
+    deteccion_set_label(d, "face");
+    d.x = 100; d.y = 100; d.w = 30; d.h = 30;
+    box_tracker_correct(&t, &d, 1, 0);
+    box_tracker_correct(&t, &d, 1, 200);
+    Deteccion out[TRACK_MAX];
+    CHECK(box_tracker_predict(&t, 250, out, TRACK_MAX) == 1);
+
+    box_tracker_correct(&t, nullptr, 0, 400);
+    CHECK(box_tracker_predict(&t, 450, out, TRACK_MAX) == 0);   // perdida: no se pinta
+    box_tracker_correct(&t, &d, 1, 600);                          // vuelve: misma pista
+    CHECK(t.created == 1 && box_tracker_predict(&t, 650, out, TRACK_MAX) == 1);
+
+    for (int i = 0; i <= TRACK_MAX_MISSES; i++) box_tracker_correct(&t, nullptr, 0, 800 + i * 200);
+    CHECK(t.dropped == 1);
+    box_tracker_correct(&t, &d, 1, 2000);
+    CHECK(t.created == 2);
+}
+
+// Una asociación mala (salto enorme con solape mínimo) no lanza la caja fuera
+static void test_speed_limit() {
+    box_tracker_t t;
+    box_tracker_reset(&t);
+    Deteccion d = {};
+    deteccion_set_label(d, "face");
+    d.x = 0; d.y = 0; d.w = 200; d.h = 200;
+    box_tracker_correct(&t, &d, 1, 0);
+    d.x = 30; d.y = 30;
+    box_tracker_correct(&t, &d, 1, 1);            // 30 px en 1 ms
+    CHECK(fabsf(t.tracks[0].vx) <= TRACK_MAX_SPEED && fabsf(t.tracks[0].vy) <= TRACK_MAX_SPEED);
+    Deteccion out[TRACK_MAX];
+    CHECK(box_tracker_predict(&t, 10000, out, TRACK_MAX) == 1);
+    CHECK(out[0].x >= 0 && out[0].x + out[0].w <= WS_DRAW_W && out[0].y + out[0].h <= WS_DRAW_H);
+}
+
+// Coste por respuesta con TRACK_MAX cajas (asociación voraz, O(n^3) pares)
+static void bench() {
+    box_tracker_t t;
+    box_tracker_reset(&t);
+    Deteccion d[TRACK_MAX];
+    for (int i = 0; i < TRACK_MAX; i++) {
+        deteccion_set_label(d[i], i & 1 ? "face" : "person");
+        d[i].x = 10 + i * 20; d[i].y = 10 + i * 15; d[i].w = 18; d[i].h = 24;
+    }
+    Deteccion out[TRACK_MAX];
+    const int reps = 100000;
+    uint32_t t0 = micros();
+    for (int i = 0; i < reps; i++) {
+        for (int k = 0; k < TRACK_MAX; k++) d[k].x = 10 + k * 20 + (i & 7);
+        box_tracker_correct(&t, d, TRACK_MAX, i * 200);
+        box_tracker_predict(&t, i * 200 + 100, out, TRACK_MAX);
+    }
+    printf("\ncorrect + predict con %d cajas (PC): %.0f ns\n", TRACK_MAX, (micros() - t0) * 1000.0 / reps);
+}
+
+int main() {
+    test_constant_velocity();
+    test_static();
+    test_maneuver();
+    test_disappear();
+    test_speed_limit();
+    bench();
+    return host_test_result();
+}
@@ -0,0 +1,204 @@
+// tribuf.h y det_handoff con un escritor y un lector en hilos (compilado con
+// -fsanitize=thread): el lector nunca ve un conjunto o hueco a medias, las
+// generaciones no retroceden, y coste por operación frente a copiar bajo portMUX.
+#include "det_handoff.h"
+#include "host.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// ============ Conjuntos verificables ============
+// Todo el contenido se deriva de gen: cualquier mezcla de dos publicaciones se detecta
+static void fill_set(det_set_t* s, uint32_t gen) {
+    s->count = gen % (WS_DRAW_MAX_DET + 1);
+    s->ms = gen * 7;
+    for (int i = 0; i < s->count; i++) {
+        Deteccion &d = s->dets[i];
+        snprintf(d.label, sizeof(d.label), "g%u", (unsigned)gen);
+        d.x = (int)gen;
+        d.y = i;
+        d.w = (int)(gen ^ (uint32_t)i);
+        d.h = (int)(gen + (uint32_t)i);
+    }
+}
+
+static bool set_ok(const det_set_t* s) {
+    if (s->count != (int)(s->gen % (WS_DRAW_MAX_DET + 1)) || s->ms != s->gen * 7) return false;
+    char label[DET_LABEL_LEN];
+    snprintf(label, sizeof(label), "g%u", (unsigned)s->gen);
+    for (int i = 0; i < s->count; i++) {
+        const Deteccion &d = s->dets[i];
+        if (d.x != (int)s->gen || d.y != i || d.w != (int)(s->gen ^ (uint32_t)i) ||
+            d.h != (int)(s->gen + (uint32_t)i) || strcmp(d.label, label) != 0) return false;
+    }
+    return true;
+}
+
+// ============ det_handoff ============
+static det_handoff_t gHandoff;      // estático: huecos a cero (gen 0 es un conjunto válido vacío)
+
+static void test_det_handoff(double seconds) {
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            det_set_t* s = det_handoff_back(&gHandoff);
+            fill_set(s, gHandoff.gen + 1);      // publish asigna ese mismo gen
+            det_handoff_publish(&gHandoff);
+        }
+    });
+
+    uint32_t reads = 0, torn = 0, backwards = 0, fresh = 0, last = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        const det_set_t* s = det_handoff_read(&gHandoff);
+        reads++;
+        if (!set_ok(s)) torn++;
+        if (s->gen < last) backwards++;
+        if (s->gen != last) fresh++;
+        last = s->gen;
+    }
+    stop = true;
+    writer.join();
+
+    printf("det_handoff: %u lecturas, %u conjuntos distintos de %u publicados, %u a medias\n",
+           (unsigned)reads, (unsigned)fresh, (unsigned)gHandoff.gen, (unsigned)torn);
+    CHECK(reads > 0 && fresh > 1);
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+
+    // Sin escritor: la última publicación
+    CHECK(det_handoff_read(&gHandoff)->gen == gHandoff.gen);
+}
+
+// ============ tribuf con huecos grandes ============
+// Huecos mayores que un conjunto: el lector recorre todo el hueco mientras se escribe otro
+#define SLOT_WORDS 1024
+
+static void test_tribuf_slots(double seconds) {
+    static uint32_t slots[3][SLOT_WORDS];
+    static tribuf_t idx;
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        uint32_t gen = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            gen++;
+            uint32_t* s = slots[idx.back];
+            for (int i = 0; i < SLOT_WORDS; i++) s[i] = gen + (uint32_t)i;
+            tribuf_publish(&idx);
+        }
+    });
+
+    uint32_t reads = 0, torn = 0, last = 0, backwards = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        bool fresh = false;
+        const uint32_t* s = slots[tribuf_acquire(&idx, &fresh)];
+        if (!fresh) continue;
+        reads++;
+        const uint32_t gen = s[0];
+        for (int i = 1; i < SLOT_WORDS; i++) {
+            if (s[i] != gen + (uint32_t)i) { torn++; break; }
+        }
+        if (gen <= last) backwards++;
+        last = gen;
+    }
+    stop = true;
+    writer.join();
+
+    printf("tribuf: %u huecos nuevos leídos (%u B), %u a medias\n", (unsigned)reads,
+           (unsigned)sizeof(slots[0]), (unsigned)torn);
+    CHECK(reads > 1);
+    CHECK(torn == 0);
+    CHECK(backwards == 0);      // fresh => publicación posterior a la anterior
+}
+
+// ============ Medida: triple buffer frente a portMUX ============
+// La versión anterior de ws_draw: un único conjunto copiado dentro de la sección crítica
+struct mux_handoff_t {
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    det_set_t set = {};
+    uint32_t gen = 0;
+};
+
+struct op_time_t {
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint32_t ops = 0;
+
+    void add(uint64_t ns) { total_ns += ns; max_ns = std::max(max_ns, ns); ops++; }
+};
+
+static uint64_t now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Escritor y lector a la vez, `ops` operaciones cada uno; publish/read cronometrados
+template <typename Write, typename Read>
+static void measure(const char* name, uint32_t ops, Write write, Read read) {
+    op_time_t w, r;
+    std::thread writer([&] {
+        for (uint32_t i = 0; i < ops; i++) {
+            uint64_t t0 = now_ns();
+            write();
+            w.add(now_ns() - t0);
+        }
+    });
+    Deteccion local[WS_DRAW_MAX_DET];
+    for (uint32_t i = 0; i < ops; i++) {
+        uint64_t t0 = now_ns();
+        read(local);
+        r.add(now_ns() - t0);
+    }
+    writer.join();
+    printf("%-10s publicar %6.0f ns (max %7.0f)   leer %6.0f ns (max %7.0f)\n", name,
+           (double)w.total_ns / w.ops, (double)w.max_ns, (double)r.total_ns / r.ops, (double)r.max_ns);
+}
+
+static void bench() {
+    printf("\npublicar y leer 10 cajas con los dos hilos a la vez (PC bajo TSan: "
+           "los valores se inflan, compárense entre sí)\n");
+    const uint32_t ops = 200000;
+    Deteccion src[WS_DRAW_MAX_DET];
+    for (int i = 0; i < WS_DRAW_MAX_DET; i++) {
+        snprintf(src[i].label, sizeof(src[i].label), "face");
+        src[i].x = i; src[i].y = i; src[i].w = 20; src[i].h = 20;
+    }
+
+    static det_handoff_t tri;
+    measure("tribuf", ops,
+        [&] {
+            det_set_t* s = det_handoff_back(&tri);
+            memcpy(s->dets, src, sizeof(src));
+            s->count = WS_DRAW_MAX_DET;
+            det_handoff_publish(&tri);
+        },
+        [&](Deteccion* out) {
+            const det_set_t* s = det_handoff_read(&tri);
+            memcpy(out, s->dets, s->count * sizeof(Deteccion));
+        });
+
+    static mux_handoff_t mux;
+    measure("portMUX", ops,
+        [&] {
+            portENTER_CRITICAL(&mux.mux);
+            memcpy(mux.set.dets, src, sizeof(src));
+            mux.set.count = WS_DRAW_MAX_DET;
+            mux.set.gen = ++mux.gen;
+            portEXIT_CRITICAL(&mux.mux);
+        },
+        [&](Deteccion* out) {
+            portENTER_CRITICAL(&mux.mux);
+            memcpy(out, mux.set.dets, mux.set.count * sizeof(Deteccion));
+            portEXIT_CRITICAL(&mux.mux);
+        });
+}
+
+int main() {
+    double seconds = host_env_seconds("CAMARA_SOAK_S", 0.5);
+    test_det_handoff(seconds);
+    test_tribuf_slots(seconds);
+    bench();
+    return host_test_result();
+}
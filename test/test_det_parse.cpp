@@ -0,0 +1,155 @@
+// det_parse con la ArduinoJson configurada (la real o, sin red, el sustituto de
+// pruebas): todo el corpus de bench/corpus se acepta y publica min(cajas, 10)
+// dentro del panel; lo que no es una respuesta (JSON inválido, formato no
+// reconocido, binario de otra versión) devuelve false y no confirma nada. Un
+// frame ROI en dos partes publica una vez la unión de sus cajas y se confirma una vez.
+// Tiempos y reservas: bench/bench_det_parse (solo con la biblioteca real).
+#include "det_parse.h"
+#include "det_proto.h"
+#include "det_merge.h"
+#include "ws_draw.h"
+#include "frame_views.h"
+#include "latency_stats.h"
+#include "uplink_window.h"
+#include "app_config.h"
+#include "host.h"
+#include "det_corpus.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+
+// ============ Sustitutos de ws_draw / app_config ============
+static Deteccion gDets[WS_DRAW_MAX_DET];
+static int gCount = -1;         // -1: no se publicó nada
+
+void ws_draw_update_detecciones_at(Deteccion* detecciones, int count, int64_t) {
+    gCount = count;
+    if (count > 0) memcpy(gDets, detecciones, sizeof(Deteccion) * count);
+}
+
+void deteccion_set_label(Deteccion &d, const char* label) {
+    if (!label) label = "";
+    strncpy(d.label, label, DET_LABEL_LEN - 1);
+    d.label[DET_LABEL_LEN - 1] = '\0';
+}
+
+bool app_config_command(JsonObjectConst root) { return root.containsKey("cmd"); }
+
+static bool parse_text(const char* s) {
+    return det_parse_json((const uint8_t*)s, strlen(s));
+}
+
+static uint32_t acks() {
+    uplink_window_stats_t w;
+    uplink_window_get_stats(&w);
+    return w.acks;
+}
+
+// ============ Corpus ============
+static void test_corpus() {
+    std::vector<det_message_t> corpus = det_corpus_load(DET_CORPUS_DIR);
+    CHECK(!corpus.empty());
+    for (const det_message_t &m : corpus) {
+        gCount = -1;
+        bool ok = m.binary ? det_parse_binary(m.data.data(), m.data.size())
+                           : det_parse_json(m.data.data(), m.data.size());
+        CHECK(ok);
+        CHECK(gCount == std::min(m.boxes, (int)WS_DRAW_MAX_DET));
+        for (int i = 0; i < gCount; i++) {
+            const Deteccion &d = gDets[i];
+            CHECK(d.x >= 0 && d.y >= 0 && d.w >= 1 && d.h >= 1 && d.x + d.w <= WS_DRAW_W && d.y + d.h <= WS_DRAW_H);
+        }
+        if (!ok || gCount != std::min(m.boxes, (int)WS_DRAW_MAX_DET)) printf("falla %s\n", m.name.c_str());
+    }
+    printf("corpus: %u mensajes\n", (unsigned)corpus.size());
+}
+
+// ============ Lo que no es una respuesta ============
+static void test_rejected() {
+    // frame_id enviado y sin confirmar: nada de esto debe confirmarlo
+    uplink_window_on_send(7, millis());
+    uint32_t a0 = acks();
+
+    gCount = -1;
+    CHECK(!parse_text("{\"frame_id\":7,\"detections\":[{\"x\":1,"));     // JSON inválido
+    CHECK(gCount == -1);
+
+    CHECK(!parse_text("42"));                                           // ni objeto ni array
+    CHECK(gCount == 0);                                                 // limpia overlays
+
+    uint8_t bin[DET_PROTO_HEADER_LEN] = { DET_PROTO_MAGIC0, DET_PROTO_MAGIC1, DET_PROTO_VERSION + 1, 0, 7 };
+    CHECK(!det_parse_binary(bin, sizeof(bin)));                         // otra versión
+    CHECK(acks() == a0);
+
+    CHECK(parse_text("{\"frame_id\":7,\"faces\":[]}"));                 // respuesta vacía: sí confirma
+    CHECK(acks() == a0 + 1 && gCount == 0);
+}
+
+// ============ Frame ROI en varias partes ============
+static uint32_t replies_measured() {
+    latency_hist_t h;
+    latency_get(LAT_SEND_TO_DETECTION, &h);
+    return h.count;
+}
+
+static bool has_box(const char* label, int x, int y, int w, int h) {
+    for (int i = 0; i < gCount; i++) {
+        const Deteccion &d = gDets[i];
+        if (!strcmp(d.label, label) && d.x == x && d.y == y && d.w == w && d.h == h) return true;
+    }
+    return false;
+}
+
+static void send_frame(uint32_t seq, uint8_t parts) {
+    det_merge_on_send(seq, parts, 480);     // vista 480 (modo normal a shift 0: la misma)
+    uplink_window_on_send(seq, millis());
+    latency_on_send(seq, 0);
+}
+
+static void test_crop_merge() {
+    // Dos recortes del mismo frame (vista 480 -> panel /2); "b" la ven los dos
+    send_frame(20, 2);
+    uint32_t a0 = acks(), m0 = replies_measured();
+    gCount = -1;
+    CHECK(!parse_text("{\"frame_id\":20,\"detections\":[{\"x\":0,\"y\":0,\"w\":96,\"h\":96,\"class\":\"a\"},"
+                      "{\"x\":240,\"y\":240,\"w\":96,\"h\":96,\"class\":\"b\"}]}"));
+    CHECK(gCount == -1 && acks() == a0 && replies_measured() == m0);      // espera a la otra parte
+
+    CHECK(parse_text("{\"frame_id\":20,\"detections\":[{\"x\":240,\"y\":240,\"w\":96,\"h\":96,\"class\":\"b\"},"
+                     "{\"x\":400,\"y\":0,\"w\":64,\"h\":64,\"class\":\"c\"}]}"));
+    CHECK(gCount == 3);
+    CHECK(has_box("a", 0, 0, 48, 48) && has_box("b", 120, 120, 48, 48) && has_box("c", 200, 0, 32, 32));
+    CHECK(acks() == a0 + 1 && replies_measured() == m0 + 1);
+
+    // Respuesta de más para el frame ya publicado: ni publica ni confirma
+    gCount = -1;
+    CHECK(!parse_text("{\"frame_id\":20,\"detections\":[]}"));
+    CHECK(gCount == -1 && acks() == a0 + 1);
+
+    // Frame a medias seguido de otro completo: solo se publica el completo
+    send_frame(21, 2);
+    send_frame(22, 2);
+    CHECK(!parse_text("{\"frame_id\":21,\"detections\":[{\"x\":0,\"y\":0,\"w\":96,\"h\":96,\"class\":\"a\"}]}"));
+    CHECK(!parse_text("{\"frame_id\":22,\"detections\":[]}"));
+    uint8_t bin[DET_PROTO_HEADER_LEN + DET_PROTO_BOX_LEN] = {
+        DET_PROTO_MAGIC0, DET_PROTO_MAGIC1, DET_PROTO_VERSION, 1, 22, 0, 0, 0, 0xE0, 0x01, 0xE0, 0x01,
+        100, 0, 100, 0, 40, 0, 40, 0, 0, 200 };                         // binario: src 480x480
+    CHECK(det_parse_binary(bin, sizeof(bin)));
+    CHECK(gCount == 1 && has_box(det_proto_class_name(0), 50, 50, 20, 20));
+    CHECK(acks() == a0 + 2);
+
+    // Un solo mensaje: se publica al momento
+    send_frame(23, 1);
+    CHECK(parse_text("{\"frame_id\":23,\"detections\":[]}"));
+    CHECK(gCount == 0 && acks() == a0 + 3);
+}
+
+int main() {
+    latency_init();
+    det_merge_init();
+    uplink_window_init(UPLINK_WINDOW_DEFAULT);
+    frame_views_set_capture(480, 480);      // uplink de 480: espacio de px_*
+    test_corpus();
+    test_rejected();
+    test_crop_merge();
+    return host_test_result();
+}
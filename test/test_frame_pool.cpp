@@ -0,0 +1,265 @@
+// frame_pool con un origen simulado (frame_source_t): conteo de referencias,
+// falta de slots sin bloquear al driver (también con fb_count < FRAME_POOL_SLOTS)
+// y reparto a dos consumidores en hilos sin ninguna reserva del heap (la ruta
+// de frames del firmware: captura -> dibujo/uplink por lease, sin malloc por frame).
+#include "frame_pool.h"
+#include "host.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============ Driver simulado ============
+// fb_count buffers como esp_camera: get() sin buffer libre espera su timeout y
+// devuelve nullptr (eso es lo que el pool debe evitar reservando antes el slot).
+#define MOCK_FB_MAX        8
+#define MOCK_FB_BYTES      64
+#define MOCK_GET_TIMEOUT_MS 20
+
+static std::mutex mockMux;
+static camera_fb_t mockFb[MOCK_FB_MAX];
+static uint8_t mockBuf[MOCK_FB_MAX][MOCK_FB_BYTES];
+static bool mockInUse[MOCK_FB_MAX];
+static int mockCount = 0;
+static uint32_t mockGets = 0;
+static std::atomic<uint32_t> mockBlocked{0};
+static std::atomic<uint32_t> mockBadReturns{0};
+
+static void mock_reset(int fbCount) {
+    std::lock_guard<std::mutex> lock(mockMux);
+    mockCount = fbCount;
+    mockGets = 0;
+    mockBlocked = 0;
+    mockBadReturns = 0;
+    for (int i = 0; i < MOCK_FB_MAX; i++) {
+        mockInUse[i] = false;
+        mockFb[i] = {};
+        mockFb[i].buf = mockBuf[i];
+        mockFb[i].len = MOCK_FB_BYTES;
+        mockFb[i].width = 8;
+        mockFb[i].height = 4;
+        mockFb[i].format = PIXFORMAT_RGB565;
+    }
+}
+
+static camera_fb_t* mock_get(void) {
+    {
+        std::lock_guard<std::mutex> lock(mockMux);
+        for (int i = 0; i < mockCount; i++) {
+            if (!mockInUse[i]) {
+                mockInUse[i] = true;
+                uint32_t tag = ++mockGets;
+                memcpy(mockBuf[i], &tag, sizeof(tag));
+                return &mockFb[i];
+            }
+        }
+    }
+    mockBlocked++;
+    delay(MOCK_GET_TIMEOUT_MS);
+    return nullptr;
+}
+
+static void mock_ret(camera_fb_t* fb) {
+    std::lock_guard<std::mutex> lock(mockMux);
+    int i = (int)(fb - mockFb);
+    if (i < 0 || i >= mockCount || !mockInUse[i]) { mockBadReturns++; return; }
+    mockInUse[i] = false;
+}
+
+static int mock_in_use() {
+    std::lock_guard<std::mutex> lock(mockMux);
+    int n = 0;
+    for (int i = 0; i < mockCount; i++) n += mockInUse[i];
+    return n;
+}
+
+static const frame_source_t mockSource = { mock_get, mock_ret };
+
+static uint32_t fb_tag(const camera_fb_t* fb) {
+    uint32_t tag;
+    memcpy(&tag, fb->buf, sizeof(tag));
+    return tag;
+}
+
+// ============ Casos ============
+static void test_refcount() {
+    mock_reset(FRAME_POOL_SLOTS);
+    frame_pool_init(&mockSource);
+
+    frame_lease_t* a = frame_pool_acquire();
+    CHECK(a && a->fb && a->seq == 1);
+    frame_lease_retain(a);          // dos consumidores
+    frame_lease_release(a);         // productor
+    CHECK(mock_in_use() == 1);
+    frame_lease_release(a);
+    frame_lease_release(a);         // de más: no debe devolverse dos veces
+    CHECK(mock_in_use() == 0);
+
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    CHECK(st.acquired == 1 && st.returned == 1 && st.outstanding == 0);
+    CHECK(mockBadReturns == 0);
+}
+
+// Todas las leases prestadas: acquire() falla al momento, sin llamar al driver
+static void test_starved() {
+    mock_reset(FRAME_POOL_SLOTS);
+    frame_pool_init(&mockSource);
+
+    frame_lease_t* held[FRAME_POOL_SLOTS];
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) held[i] = frame_pool_acquire();
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) CHECK(held[i] != nullptr);
+
+    uint32_t t0 = millis();
+    CHECK(frame_pool_acquire() == nullptr);
+    CHECK(millis() - t0 < MOCK_GET_TIMEOUT_MS);
+    CHECK(mockBlocked == 0);
+
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    CHECK(st.starved == 1 && st.outstanding == FRAME_POOL_SLOTS);
+
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) frame_lease_release(held[i]);
+    frame_pool_get_stats(&st);
+    CHECK(st.outstanding == 0 && mock_in_use() == 0);
+}
+
+// Driver con menos buffers que slots (fb_count < FRAME_POOL_SLOTS): con la capacidad
+// al fb_count en marcha, acquire() falla al momento en vez de esperar al driver
+static void test_capacity() {
+    for (int fbCount = 1; fbCount < FRAME_POOL_SLOTS; fbCount++) {
+        mock_reset(fbCount);
+        frame_pool_init(&mockSource);
+
+        // Capacidad de FRAME_POOL_SLOTS: el slot libre de más llega al driver, que espera su timeout
+        frame_pool_set_capacity(FRAME_POOL_SLOTS);
+        frame_lease_t* held[FRAME_POOL_SLOTS];
+        for (int i = 0; i < fbCount; i++) held[i] = frame_pool_acquire();
+        CHECK(frame_pool_acquire() == nullptr);
+        CHECK(mockBlocked == 1);
+        for (int i = 0; i < fbCount; i++) frame_lease_release(held[i]);
+
+        frame_pool_set_capacity(fbCount);
+        for (int i = 0; i < fbCount; i++) CHECK((held[i] = frame_pool_acquire()) != nullptr);
+        uint32_t t0 = millis();
+        CHECK(frame_pool_acquire() == nullptr);
+        CHECK(millis() - t0 < MOCK_GET_TIMEOUT_MS);
+        CHECK(mockBlocked == 1);
+        for (int i = 0; i < fbCount; i++) frame_lease_release(held[i]);
+
+        frame_pool_stats_t st;
+        frame_pool_get_stats(&st);
+        CHECK(st.starved == 1 && st.outstanding == 0 && mock_in_use() == 0);
+    }
+
+    // Fuera de rango: se recorta a 1..FRAME_POOL_SLOTS
+    mock_reset(FRAME_POOL_SLOTS);
+    frame_pool_init(&mockSource);
+    frame_pool_set_capacity(0);
+    frame_lease_t* a = frame_pool_acquire();
+    CHECK(a && frame_pool_acquire() == nullptr);
+    frame_lease_release(a);
+    frame_pool_set_capacity(FRAME_POOL_SLOTS + 5);
+    frame_lease_t* held[FRAME_POOL_SLOTS];
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) CHECK((held[i] = frame_pool_acquire()) != nullptr);
+    CHECK(frame_pool_acquire() == nullptr && mockBlocked == 0);
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) frame_lease_release(held[i]);
+    frame_pool_set_capacity(FRAME_POOL_SLOTS);
+}
+
+// Driver sin frame (timeout): el slot reservado vuelve a quedar libre
+static camera_fb_t* null_get(void) { return nullptr; }
+static void null_ret(camera_fb_t*) {}
+
+static void test_source_timeout() {
+    static const frame_source_t nullSource = { null_get, null_ret };
+    frame_pool_init(&nullSource);
+    for (int i = 0; i < FRAME_POOL_SLOTS * 2; i++) CHECK(frame_pool_acquire() == nullptr);
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    CHECK(st.acquired == 0 && st.starved == 0 && st.outstanding == 0);
+}
+
+// ============ Reparto en hilos ============
+// Como camera_ui: el productor entrega cada frame a dos buzones de un hueco
+// (dibujo y uplink); el más nuevo sustituye al pendiente, que se suelta.
+struct mailbox_t {
+    std::atomic<frame_lease_t*> lease{nullptr};
+};
+
+static void deliver(mailbox_t &box, frame_lease_t* lease) {
+    frame_lease_retain(lease);
+    frame_lease_t* stale = box.lease.exchange(lease);
+    if (stale) frame_lease_release(stale);
+}
+
+static std::atomic<uint32_t> gTorn{0};
+
+static void consumer(mailbox_t* box, std::atomic<bool>* stop, int workUs, uint32_t* done) {
+    while (!stop->load()) {
+        frame_lease_t* lease = box->lease.exchange(nullptr);
+        if (!lease) { std::this_thread::yield(); continue; }
+        uint32_t tag = fb_tag(lease->fb);
+        uint32_t t0 = micros();
+        while ((int)(micros() - t0) < workUs) {}
+        if (fb_tag(lease->fb) != tag) gTorn++;      // el driver lo reutilizó en uso
+        frame_lease_release(lease);
+        (*done)++;
+    }
+}
+
+static void test_threads() {
+    mock_reset(FRAME_POOL_SLOTS);
+    frame_pool_init(&mockSource);
+
+    double seconds = host_env_seconds("CAMARA_SOAK_S", 0.5);
+    mailbox_t draw, uplink;
+    std::atomic<bool> stop{false};
+    uint32_t drawn = 0, sent = 0;
+    std::thread tDraw(consumer, &draw, &stop, 300, &drawn);
+    std::thread tUplink(consumer, &uplink, &stop, 900, &sent);
+
+    host_alloc_stats_t a0, a1;
+    host_alloc_get(&a0);
+    uint32_t produced = 0, t0 = millis();
+    while (millis() - t0 < seconds * 1000) {
+        frame_lease_t* lease = frame_pool_acquire();
+        if (!lease) { std::this_thread::yield(); continue; }
+        deliver(draw, lease);
+        deliver(uplink, lease);
+        frame_lease_release(lease);
+        produced++;
+    }
+    host_alloc_get(&a1);
+    stop = true;
+    tDraw.join();
+    tUplink.join();
+    for (mailbox_t* box : { &draw, &uplink }) {
+        frame_lease_t* left = box->lease.exchange(nullptr);
+        if (left) frame_lease_release(left);
+    }
+
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    CHECK(st.outstanding == 0);
+    CHECK(st.acquired == produced && st.returned == produced);
+    CHECK(mock_in_use() == 0);
+    CHECK(mockBlocked == 0);
+    CHECK(mockBadReturns == 0);
+    CHECK(gTorn == 0);
+    CHECK(drawn > 0 && sent > 0);
+    CHECK(a1.count == a0.count);                    // ni una reserva durante el reparto
+
+    printf("reparto %.1f s: %u frames (%.0f/s), dibujados %u, enviados %u, sin slot %u, %llu reservas\n",
+           seconds, (unsigned)produced, produced / seconds, (unsigned)drawn, (unsigned)sent,
+           (unsigned)st.starved, (unsigned long long)(a1.count - a0.count));
+}
+
+int main() {
+    test_refcount();
+    test_starved();
+    test_source_timeout();
+    test_capacity();
+    test_threads();
+    return host_test_result();
+}
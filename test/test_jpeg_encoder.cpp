@@ -0,0 +1,135 @@
+// jpeg_encoder: cabecera de uplink delante del JPEG, ajuste de calidad hacia el
+// objetivo de bytes, desbordamiento de JPEG_OUT_MAX y medida de tiempo/ratio por
+// escena y calidad (fmt2jpg_cb sobre libjpeg: support/img_converters.cpp).
+#include "jpeg_encoder.h"
+#include "host.h"
+#include "scenes.h"
+#include <vector>
+
+static camera_fb_t make_fb(std::vector<uint8_t> &buf, int w, int h) {
+    camera_fb_t fb = {};
+    fb.buf = buf.data();
+    fb.len = buf.size();
+    fb.width = w;
+    fb.height = h;
+    fb.format = PIXFORMAT_RGB565;
+    return fb;
+}
+
+static void test_headroom() {
+    std::vector<uint8_t> px(240 * 240 * 2);
+    scene_render(px.data(), 240, 240, SCENE_FACE, 0);
+    camera_fb_t fb = make_fb(px, 240, 240);
+
+    jpeg_encoder_set_quality(JPEG_QUALITY_DEFAULT);
+    uint8_t* out = nullptr;
+    size_t len = 0;
+    CHECK(jpeg_encoder_encode(&fb, 16, &out, &len));
+    CHECK(out && len > 16 + 4);
+    CHECK(out[16] == 0xFF && out[17] == 0xD8);              // SOI tras la cabecera
+    CHECK(out[len - 2] == 0xFF && out[len - 1] == 0xD9);    // EOI
+    CHECK(!jpeg_encoder_encode(&fb, JPEG_HEADROOM_MAX + 1, &out, &len));
+}
+
+// La calidad converge hacia el objetivo sin oscilar entre los extremos
+static void test_adapt() {
+    std::vector<uint8_t> px(240 * 240 * 2);
+    camera_fb_t fb = make_fb(px, 240, 240);
+    const uint32_t targets[] = { 4 * 1024, 8 * 1024, 16 * 1024 };
+
+    for (uint32_t target : targets) {
+        jpeg_encoder_set_quality(JPEG_QUALITY_DEFAULT);
+        jpeg_encoder_set_target_bytes(target);
+        uint32_t bytes = 0;
+        int qMin = 100, qMax = 0;
+        for (int i = 0; i < 60; i++) {
+            scene_render(px.data(), 240, 240, SCENE_FACE, i);
+            uint8_t* out;
+            size_t len;
+            CHECK(jpeg_encoder_encode(&fb, 0, &out, &len));
+            jpeg_encoder_stats_t st;
+            jpeg_encoder_get_stats(&st);
+            bytes = st.last_bytes;
+            if (i >= 40) {          // régimen estable
+                qMin = std::min(qMin, st.quality);
+                qMax = std::max(qMax, st.quality);
+            }
+        }
+        jpeg_encoder_stats_t st;
+        jpeg_encoder_get_stats(&st);
+        bool atLimit = st.quality == JPEG_QUALITY_MIN || st.quality == JPEG_QUALITY_MAX;
+        CHECK(atLimit || (bytes > target * 3 / 4 && bytes < target * 5 / 4));
+        CHECK(qMax - qMin <= 4);
+        printf("objetivo %5u B: %5u B con calidad %d (estable %d..%d)\n",
+               (unsigned)target, (unsigned)bytes, st.quality, qMin, qMax);
+    }
+    jpeg_encoder_set_target_bytes(JPEG_TARGET_BYTES_DEFAULT);
+}
+
+// VGA de ruido a calidad máxima no cabe: se descarta y la siguiente baja calidad
+static void test_overflow() {
+    std::vector<uint8_t> px(640 * 480 * 2);
+    scene_render(px.data(), 640, 480, SCENE_NOISE, 0);
+    camera_fb_t fb = make_fb(px, 640, 480);
+
+    jpeg_encoder_stats_t before, after;
+    jpeg_encoder_get_stats(&before);
+    jpeg_encoder_set_quality(JPEG_QUALITY_MAX);
+    uint8_t* out;
+    size_t len;
+    CHECK(!jpeg_encoder_encode(&fb, 0, &out, &len));
+    jpeg_encoder_get_stats(&after);
+    CHECK(after.overflow == before.overflow + 1);
+    CHECK(after.quality < JPEG_QUALITY_MAX);
+}
+
+// ============ Medida ============
+static void measure(const char* name, std::vector<uint8_t> &px, int w, int h) {
+    camera_fb_t fb = make_fb(px, w, h);
+    const int qualities[] = { 30, 60, 90 };
+    const int reps = 20;
+    for (int q : qualities) {
+        uint64_t us = 0, bytes = 0;
+        int ok = 0;
+        for (int i = 0; i < reps; i++) {
+            jpeg_encoder_set_quality(q);
+            uint8_t* out;
+            size_t len;
+            uint32_t t0 = micros();
+            if (jpeg_encoder_encode(&fb, 0, &out, &len)) { ok++; bytes += len; }
+            us += micros() - t0;
+        }
+        if (!ok) {
+            printf("%-12s %4dx%-4d q%-2d  no cabe en %u B\n", name, w, h, q, (unsigned)JPEG_OUT_MAX);
+            continue;
+        }
+        printf("%-12s %4dx%-4d q%-2d %7.0f us %7u B  ratio %5.1f:1\n", name, w, h, q,
+               (double)us / reps, (unsigned)(bytes / ok), (double)fb.len * ok / bytes);
+    }
+}
+
+static void bench() {
+    printf("\ntiempo (PC) y ratio por escena y calidad (%s)\n",
+           getenv("CAMARA_FRAMES") ? "frames grabados + sintéticos" : "frames sintéticos");
+    for (const scene_file_t &s : scene_load_recorded()) {
+        std::vector<uint8_t> px = s.data;
+        measure(s.name.c_str(), px, s.w, s.h);
+    }
+    const int sizes[][2] = { { 240, 240 }, { 480, 480 } };
+    for (const auto &sz : sizes) {
+        std::vector<uint8_t> px((size_t)sz[0] * sz[1] * 2);
+        for (int k = 0; k < SCENE_COUNT; k++) {
+            scene_render(px.data(), sz[0], sz[1], k, 3);
+            measure(scene_name(k), px, sz[0], sz[1]);
+        }
+    }
+}
+
+int main() {
+    CHECK(jpeg_encoder_init());
+    test_headroom();
+    test_adapt();
+    test_overflow();
+    bench();
+    return host_test_result();
+}
@@ -0,0 +1,138 @@
+// motion_gate: miniatura rápida bit a bit igual a la referencia escalar en todos
+// los tamaños de captura, bloque escalado con el frame (sin desactivarse en
+// frames grandes), decisión estático/movimiento/keep-alive y coste por píxel.
+#include "motion_gate.h"
+#include "app_log.h"
+#include "host.h"
+#include "scenes.h"
+#include <vector>
+
+static camera_fb_t make_fb(std::vector<uint8_t> &buf, int w, int h, pixformat_t format = PIXFORMAT_RGB565) {
+    camera_fb_t fb = {};
+    fb.buf = buf.data();
+    fb.len = buf.size();
+    fb.width = w;
+    fb.height = h;
+    fb.format = format;
+    return fb;
+}
+
+static const int kSizes[][2] = {
+    { 96, 96 }, { 240, 240 }, { 320, 240 }, { 480, 480 }, { 640, 480 },
+    { 800, 600 }, { 1024, 768 }, { 1280, 720 }, { 1600, 1200 }, { 2048, 1536 }, { 2560, 1920 },
+};
+
+static void test_block_for() {
+    CHECK(motion_block_for(640, 480) == MOTION_BLOCK);
+    CHECK(motion_block_for(800, 600) == 2 * MOTION_BLOCK);
+    CHECK(motion_block_for(1600, 1200) == 4 * MOTION_BLOCK);
+    CHECK(motion_block_for(2560, 1920) == 4 * MOTION_BLOCK);
+    for (const auto &sz : kSizes) {
+        int block = motion_block_for(sz[0], sz[1]);
+        CHECK(block >= MOTION_BLOCK && block <= MOTION_BLOCK_MAX);
+        CHECK(sz[0] / block <= MOTION_THUMB_W_MAX && (sz[0] / block) * (sz[1] / block) <= MOTION_THUMB_MAX);
+    }
+}
+
+// motion_thumb == motion_thumb_ref en cada tamaño, escena y bloque, alineado o no
+static void test_bit_exact() {
+    for (const auto &sz : kSizes) {
+        const int w = sz[0], h = sz[1];
+        std::vector<uint8_t> px((size_t)w * h * 2 + 4);
+        std::vector<uint8_t> ref(w * h), fast(w * h);
+        for (int k = 0; k < SCENE_COUNT; k++) {
+            scene_render(px.data(), w, h, k, 5);
+            for (int block = MOTION_BLOCK; block <= MOTION_BLOCK_MAX; block <<= 1) {
+                if (w / block > MOTION_THUMB_W_MAX) continue;
+                const int cells = (w / block) * (h / block);
+                motion_thumb_ref(px.data(), w, h, block, ref.data());
+                motion_thumb(px.data(), w, h, block, fast.data());
+                CHECK(memcmp(ref.data(), fast.data(), cells) == 0);
+            }
+        }
+    }
+    // Extremos de canal (blanco/negro/colores puros) y buffer desalineado (cae en la referencia)
+    const int w = 64, h = 64;
+    std::vector<uint8_t> px(w * h * 2 + 2);
+    const uint16_t colors[] = { 0xFFFF, 0x0000, 0xF800, 0x07E0, 0x001F, 0x8410 };
+    for (int i = 0; i < w * h; i++) {
+        uint16_t c = colors[(i / 7) % 6];
+        px[2 + 2 * i] = c >> 8;
+        px[3 + 2 * i] = c & 0xFF;
+    }
+    uint8_t ref[64], fast[64];
+    motion_thumb_ref(px.data() + 2, w, h, MOTION_BLOCK, ref);
+    motion_thumb(px.data() + 2, w, h, MOTION_BLOCK, fast);
+    CHECK(memcmp(ref, fast, sizeof(ref)) == 0);
+}
+
+// Estático -> no se envía; movimiento -> se envía; keep-alive tras el plazo
+static void test_decisions(int w, int h) {
+    std::vector<uint8_t> px((size_t)w * h * 2);
+    camera_fb_t fb = make_fb(px, w, h);
+    motion_gate_set_enabled(true);
+    motion_gate_set_params(MOTION_CELL_DELTA, MOTION_AREA_PERMILLE, 100);
+
+    motion_gate_stats_t before, st;
+    motion_gate_get_stats(&before);
+    scene_render(px.data(), w, h, SCENE_FACE, 0);
+    CHECK(motion_gate_should_send(&fb));            // primera referencia a este tamaño
+    CHECK(!motion_gate_should_send(&fb));           // mismo frame: estático
+    scene_render(px.data(), w, h, SCENE_FACE, 8);   // la cara se ha desplazado
+    CHECK(motion_gate_should_send(&fb));
+    CHECK(!motion_gate_should_send(&fb));
+    delay(110);
+    CHECK(motion_gate_should_send(&fb));            // keep-alive
+
+    motion_gate_get_stats(&st);
+    CHECK(st.frames - before.frames == 5);
+    CHECK(st.skipped - before.skipped == 2);
+    CHECK(st.keepalives - before.keepalives == 1);
+    CHECK(st.passthrough == before.passthrough);
+    CHECK(st.block == motion_block_for(w, h));
+    motion_gate_set_params(MOTION_CELL_DELTA, MOTION_AREA_PERMILLE, MOTION_KEEPALIVE_MS);
+}
+
+// Sin miniatura posible (JPEG del sensor): se envía, se cuenta y se avisa una sola vez
+static void test_passthrough() {
+    std::vector<uint8_t> px(1024);
+    camera_fb_t fb = make_fb(px, 640, 480, PIXFORMAT_JPEG);
+    motion_gate_stats_t before, st;
+    motion_gate_get_stats(&before);
+    uint32_t warns = host_log_count(APP_LOG_WARN);
+    CHECK(motion_gate_should_send(&fb));
+    CHECK(motion_gate_should_send(&fb));
+    motion_gate_get_stats(&st);
+    CHECK(st.passthrough - before.passthrough == 2);
+    CHECK(host_log_count(APP_LOG_WARN) - warns == 1);
+}
+
+// ============ Medida ============
+static void bench() {
+    printf("\nminiatura (PC): ns por píxel, referencia vs rápida\n");
+    for (const auto &sz : kSizes) {
+        const int w = sz[0], h = sz[1], block = motion_block_for(w, h);
+        std::vector<uint8_t> px((size_t)w * h * 2);
+        uint8_t thumb[MOTION_THUMB_MAX];
+        scene_render(px.data(), w, h, SCENE_DESK, 1);
+        const int reps = 4000000 / (w * h) + 1;
+        uint32_t t0 = micros();
+        for (int i = 0; i < reps; i++) motion_thumb_ref(px.data(), w, h, block, thumb);
+        uint32_t t1 = micros();
+        for (int i = 0; i < reps; i++) motion_thumb(px.data(), w, h, block, thumb);
+        uint32_t t2 = micros();
+        double npx = (double)w * h * reps;
+        printf("%4dx%-4d bloque %2d (%2dx%-2d) %6.2f -> %6.2f ns/px\n", w, h, block, w / block, h / block,
+               (t1 - t0) * 1000.0 / npx, (t2 - t1) * 1000.0 / npx);
+    }
+}
+
+int main() {
+    test_block_for();
+    test_bit_exact();
+    test_decisions(640, 480);
+    test_decisions(1600, 1200);     // antes se desactivaba: más de MOTION_THUMB_MAX celdas
+    test_passthrough();
+    bench();
+    return host_test_result();
+}
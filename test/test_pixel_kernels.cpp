@@ -0,0 +1,165 @@
+// pixel_kernels: cada versión rápida bit a bit igual a su referencia escalar,
+// con los 65536 valores de píxel, longitudes impares, buffers desalineados,
+// regiones con stride y en su sitio; más ns/píxel de ambas versiones.
+#include "pixel_kernels.h"
+#include "host.h"
+#include "scenes.h"
+#include <vector>
+
+static uint32_t gSeed = 0x12345678;
+static void fill_random(uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        gSeed ^= gSeed << 13; gSeed ^= gSeed >> 17; gSeed ^= gSeed << 5;
+        p[i] = (uint8_t)gSeed;
+    }
+}
+
+// Todos los valores RGB565 en orden big-endian
+static std::vector<uint8_t> all_pixels() {
+    std::vector<uint8_t> px(65536 * 2);
+    for (uint32_t v = 0; v < 65536; v++) {
+        px[2 * v] = (uint8_t)(v >> 8);
+        px[2 * v + 1] = (uint8_t)v;
+    }
+    return px;
+}
+
+static void test_swap16() {
+    std::vector<uint8_t> all = all_pixels();
+    std::vector<uint8_t> a(all.size() + 8), b(all.size() + 8);
+    px_swap16_ref(all.data(), a.data(), 65536);
+    px_swap16(all.data(), b.data(), 65536);
+    CHECK(memcmp(a.data(), b.data(), all.size()) == 0);
+    CHECK(a[0] == 0x00 && a[2] == 0x01 && a[3] == 0x00);    // 0x0001 -> bytes 01 00
+
+    // Longitudes cortas/impares y desalineados en origen y destino
+    std::vector<uint8_t> src(64 * 2 + 8);
+    fill_random(src.data(), src.size());
+    for (int so = 0; so < 4; so++) {
+        for (int dof = 0; dof < 4; dof++) {
+            for (size_t n = 0; n <= 33; n++) {
+                memset(a.data(), 0xAA, 80);
+                memset(b.data(), 0xAA, 80);
+                px_swap16_ref(src.data() + so, a.data() + dof, n);
+                px_swap16(src.data() + so, b.data() + dof, n);
+                CHECK(memcmp(a.data(), b.data(), 80) == 0);     // incluye no escribir de más
+            }
+        }
+    }
+
+    // En su sitio: dos swaps devuelven el original
+    std::vector<uint8_t> in = src;
+    px_swap16(in.data(), in.data(), 64);
+    px_swap16(in.data(), in.data(), 64);
+    CHECK(memcmp(in.data(), src.data(), 128) == 0);
+}
+
+static void test_luma() {
+    px_kernels_init();
+    std::vector<uint8_t> all = all_pixels();
+    std::vector<uint8_t> a(65536 + 8), b(65536 + 8);
+    px_luma_ref(all.data(), a.data(), 65536);
+    px_luma(all.data(), b.data(), 65536);
+    CHECK(memcmp(a.data(), b.data(), 65536) == 0);
+    CHECK(a[0x0000] == 0 && a[0xFFFF] >= 248);         // canales sin replicar bits bajos: 250
+
+    std::vector<uint8_t> src(64 * 2 + 8);
+    fill_random(src.data(), src.size());
+    for (int so = 0; so < 4; so++) {
+        for (size_t n = 0; n <= 33; n++) {
+            memset(a.data(), 0xAA, 40);
+            memset(b.data(), 0xAA, 40);
+            px_luma_ref(src.data() + so, a.data() + 1, n);
+            px_luma(src.data() + so, b.data() + 1, n);
+            CHECK(memcmp(a.data(), b.data(), 40) == 0);
+        }
+    }
+}
+
+// Regiones de un frame con stride (como la vista centrada de frame_views)
+static void test_downscale() {
+    const int fw = 200, fh = 96;
+    std::vector<uint8_t> frame((size_t)fw * fh * 2 + 8);
+    std::vector<uint8_t> a(fw * fh * 2), b(fw * fh * 2);
+    for (int pass = 0; pass < 3; pass++) {
+        if (pass == 0) fill_random(frame.data(), frame.size());
+        if (pass == 1) memset(frame.data(), 0xFF, frame.size());   // canales al máximo (acarreos)
+        if (pass == 2) scene_render(frame.data(), fw, fh, SCENE_DESK, 2);
+        for (int factor = 2; factor <= 4; factor += 2) {
+            for (int x0 = 0; x0 < 4; x0++) {                       // esquina -> alineación
+                for (int outW = 1; outW <= 13; outW++) {
+                    const int outH = 3;
+                    const uint8_t* src = frame.data() + (size_t)(x0 + 2 * fw) * 2;
+                    memset(a.data(), 0xAA, 64);
+                    memset(b.data(), 0xAA, 64);
+                    px_downscale_ref(src, fw, outW, outH, factor, a.data());
+                    px_downscale(src, fw, outW, outH, factor, b.data());
+                    CHECK(memcmp(a.data(), b.data(), outW * outH * 2 + 8) == 0);
+                }
+            }
+            // Frame completo
+            const int outW = fw / factor, outH = fh / factor;
+            px_downscale_ref(frame.data(), fw, outW, outH, factor, a.data());
+            px_downscale(frame.data(), fw, outW, outH, factor, b.data());
+            CHECK(memcmp(a.data(), b.data(), outW * outH * 2) == 0);
+        }
+    }
+}
+
+static void test_selftest() {
+    CHECK(px_kernels_selftest(240, 240));
+}
+
+// ============ Medida ============
+static double ns_per_px(void (*fn)(void*), void* ctx, size_t npix) {
+    int reps = 1;
+    for (;;) {
+        uint32_t t0 = micros();
+        for (int i = 0; i < reps; i++) fn(ctx);
+        uint32_t us = micros() - t0;
+        if (us > 20000) return us * 1000.0 / ((double)npix * reps);
+        reps *= 2;
+    }
+}
+
+struct bench_ctx_t {
+    const uint8_t* src;
+    uint8_t* dst;
+    int w, h;
+};
+
+static void bench() {
+    printf("\nkernels (PC): ns por píxel de entrada, referencia -> rápida\n");
+    const int sizes[][2] = { { 240, 240 }, { 480, 480 }, { 960, 960 } };
+    for (const auto &sz : sizes) {
+        const int w = sz[0], h = sz[1];
+        std::vector<uint8_t> src((size_t)w * h * 2), dst((size_t)w * h * 2);
+        scene_render(src.data(), w, h, SCENE_FACE, 0);
+        bench_ctx_t c = { src.data(), dst.data(), w, h };
+        const size_t npix = (size_t)w * h;
+#define PX_CASE(name, refBody, fastBody)                                                   \
+        {                                                                                  \
+            double r = ns_per_px([](void* p) { bench_ctx_t* c = (bench_ctx_t*)p; refBody; }, &c, npix);  \
+            double f = ns_per_px([](void* p) { bench_ctx_t* c = (bench_ctx_t*)p; fastBody; }, &c, npix); \
+            printf("%4dx%-4d %-7s %5.2f -> %5.2f ns/px (x%.1f)\n", w, h, name, r, f, r / f); \
+        }
+        PX_CASE("swap16", px_swap16_ref(c->src, c->dst, (size_t)c->w * c->h),
+                          px_swap16(c->src, c->dst, (size_t)c->w * c->h));
+        PX_CASE("luma",   px_luma_ref(c->src, c->dst, (size_t)c->w * c->h),
+                          px_luma(c->src, c->dst, (size_t)c->w * c->h));
+        PX_CASE("down2x", px_downscale_ref(c->src, c->w, c->w / 2, c->h / 2, 2, c->dst),
+                          px_downscale(c->src, c->w, c->w / 2, c->h / 2, 2, c->dst));
+        PX_CASE("down4x", px_downscale_ref(c->src, c->w, c->w / 4, c->h / 4, 4, c->dst),
+                          px_downscale(c->src, c->w, c->w / 4, c->h / 4, 4, c->dst));
+#undef PX_CASE
+    }
+}
+
+int main() {
+    test_swap16();
+    test_luma();
+    test_downscale();
+    test_selftest();
+    bench();
+    return host_test_result();
+}
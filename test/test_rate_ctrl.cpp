@@ -0,0 +1,264 @@
+// rate_ctrl_step contra un enlace simulado (pasos de 1 ms): cámara con cola
+// drop-oldest de un hueco, ventana de 2 frames sin confirmar, sendBIN bloqueante
+// al ritmo del enlace, servidor FIFO y medidas agregadas cada RC_UPDATE_MS como
+// rate_ctrl_update(). El tamaño del JPEG sigue al objetivo dentro de lo que
+// permite cada resolución (uplink_shift).
+#include "rate_ctrl.h"
+#include "frame_views.h"
+#include "host.h"
+#include <deque>
+#include <vector>
+
+// Tamaño alcanzable por resolución de uplink (vista 480: 480, 240, 120 de lado)
+static const uint32_t kMinBytes[VIEW_MAX_SHIFT + 1] = { 6000, 1800, 600 };
+static const uint32_t kMaxBytes[VIEW_MAX_SHIFT + 1] = { 33000, 10000, 3000 };
+
+#define SIM_WINDOW 2
+
+// rate_ctrl_init/update publican el objetivo en el codificador; aquí no hace falta
+void jpeg_encoder_set_target_bytes(uint32_t) {}
+
+struct link_t {
+    double bytes_per_ms;    // capacidad del enlace
+    uint32_t owd_ms;        // retardo en un sentido
+    uint32_t server_ms;     // inferencia por frame
+};
+
+struct sim_result_t {
+    uint32_t frames;        // respuestas recibidas en el tramo medido
+    double age_ms;          // captura -> detección (media)
+    uint32_t max_age_ms;
+    uint32_t drops;
+    double fps;
+};
+
+struct sim_t {
+    rate_ctrl_state_t st = {};
+    uint32_t now = 0;
+    // cámara
+    uint32_t nextCapture = 0;
+    bool pending = false;
+    uint32_t pendingCapture = 0;
+    // envío
+    uint32_t sendDoneAt = 0;
+    bool sending = false;
+    uint32_t sendingCapture = 0, sendStart = 0;
+    int inflight = 0;
+    // servidor y vuelta: frames por instante de llegada (al servidor o de la respuesta)
+    struct msg_t { uint32_t at, capture, sent; };
+    std::deque<msg_t> serverQueue;
+    uint32_t serverBusyUntil = 0;
+    std::deque<msg_t> replies;
+    // periodo de control
+    uint64_t sendSum = 0;
+    uint32_t sendCount = 0, detSum = 0, detCount = 0, drops = 0;
+    // resultado
+    sim_result_t res = {};
+    uint64_t ageSum = 0;
+    bool measuring = false;
+
+    sim_t(uint8_t floor) {
+        st.interval_ms = RC_INTERVAL_INIT_MS;
+        st.target_bytes = 12 * 1024;
+        st.shift_floor = floor;
+        st.uplink_shift = floor;
+    }
+
+    uint32_t frame_bytes() const {
+        uint32_t b = st.target_bytes;
+        if (b < kMinBytes[st.uplink_shift]) b = kMinBytes[st.uplink_shift];
+        if (b > kMaxBytes[st.uplink_shift]) b = kMaxBytes[st.uplink_shift];
+        return b;
+    }
+
+    void tick(const link_t &l) {
+        // captura: el más nuevo sustituye al pendiente; solo es descarte si el envío iba ocupado
+        if (now >= nextCapture) {
+            if (pending && sending) drops++, res.drops += measuring;
+            pending = true;
+            pendingCapture = now;
+            nextCapture = now + st.interval_ms;
+        }
+        // fin de sendBIN
+        if (sending && now >= sendDoneAt) {
+            sending = false;
+            sendSum += (uint64_t)(now - sendStart) * 1000;
+            sendCount++;
+            serverQueue.push_back({ now + l.owd_ms, sendingCapture, now });
+        }
+        // tarea de red: saca de la cola si la ventana está abierta
+        if (!sending && pending && inflight < SIM_WINDOW) {
+            pending = false;
+            sending = true;
+            sendingCapture = pendingCapture;
+            sendStart = now;
+            sendDoneAt = now + (uint32_t)(frame_bytes() / l.bytes_per_ms + 0.5);
+            inflight++;
+        }
+        // servidor FIFO
+        if (!serverQueue.empty() && serverQueue.front().at <= now && now >= serverBusyUntil) {
+            msg_t m = serverQueue.front();
+            serverQueue.pop_front();
+            serverBusyUntil = now + l.server_ms;
+            m.at = serverBusyUntil + l.owd_ms;
+            replies.push_back(m);
+        }
+        // respuesta: confirma (ventana) y mide como rate_ctrl_on_detections()
+        while (!replies.empty() && replies.front().at <= now) {
+            msg_t m = replies.front();
+            replies.pop_front();
+            if (inflight) inflight--;
+            detSum += now - m.sent;
+            detCount++;
+            if (measuring) {
+                uint32_t age = now - m.capture;
+                res.frames++;
+                ageSum += age;
+                if (age > res.max_age_ms) res.max_age_ms = age;
+            }
+        }
+        // lazo de control
+        if (now % RC_UPDATE_MS == 0 && now) {
+            rate_ctrl_input_t in;
+            in.send_us = sendCount ? (uint32_t)(sendSum / sendCount) : 0;
+            in.det_ms = detCount ? detSum / detCount : 0;
+            in.inflight = inflight;
+            in.window = SIM_WINDOW;
+            in.drops = drops;
+            sendSum = 0; sendCount = 0; detSum = 0; detCount = 0; drops = 0;
+            rate_ctrl_step(&in, &st);
+        }
+        now++;
+    }
+
+    // Simula `ms`; mide solo si `measure`
+    void run(const link_t &l, uint32_t ms, bool measure) {
+        if (measure && !measuring) { res = {}; ageSum = 0; }
+        measuring = measure;
+        uint32_t start = now;
+        while (now - start < ms) tick(l);
+        if (measure && res.frames) {
+            res.age_ms = (double)ageSum / res.frames;
+            res.fps = res.frames * 1000.0 / ms;
+        }
+    }
+};
+
+static void print(const char* name, const sim_t &s) {
+    printf("%-22s periodo %4u ms, %5u B/fr, shift %u, det %4u ms (base %4u) | %5.1f fps, edad %4.0f ms (max %4u), descartes %u\n",
+           name, (unsigned)s.st.interval_ms, (unsigned)s.st.target_bytes, s.st.uplink_shift,
+           (unsigned)s.st.det_ms, (unsigned)s.st.det_base_ms, s.res.fps, s.res.age_ms,
+           (unsigned)s.res.max_age_ms, (unsigned)s.res.drops);
+}
+
+static const link_t kLan     = { 1000.0, 2, 30 };     // 1 MB/s, servidor rápido
+static const link_t kSlow    = { 20.0, 10, 30 };      // 20 KB/s
+static const link_t kSlowSrv = { 1000.0, 2, 250 };    // enlace sobrado, inferencia 250 ms
+
+// Enlace sobrado: periodo al mínimo, bytes al máximo, resolución completa
+static void test_lan() {
+    sim_t s(0);
+    s.run(kLan, 30000, false);
+    s.run(kLan, 10000, true);
+    print("LAN", s);
+    CHECK(s.st.uplink_shift == 0);
+    CHECK(s.st.interval_ms <= RC_INTERVAL_MIN_MS + 10);
+    CHECK(s.st.target_bytes >= 12 * 1024);
+    CHECK(s.res.age_ms < 120);
+}
+
+// Enlace lento: reduce bytes y después resolución; la edad queda acotada
+static void test_slow_link() {
+    sim_t s(0);
+    s.run(kSlow, 60000, false);
+    s.run(kSlow, 20000, true);
+    print("enlace 20 KB/s", s);
+    CHECK(s.st.uplink_shift >= 1);
+    CHECK(s.res.age_ms < 600);
+    CHECK(s.res.fps > 4);
+}
+
+// Servidor lento: el retardo de las detecciones frena la cámara sin bajar la resolución
+static void test_slow_server() {
+    sim_t s(0);
+    s.run(kSlowSrv, 60000, false);
+    s.run(kSlowSrv, 20000, true);
+    print("servidor 250 ms", s);
+    CHECK(s.st.uplink_shift == 0);
+    CHECK(s.st.queued > 0);
+    CHECK(s.st.interval_ms >= 100);
+    CHECK(s.res.age_ms < 2.5 * kSlowSrv.server_ms);
+    CHECK(s.res.fps > 2.5);
+}
+
+// Escalón: LAN -> 20 KB/s -> LAN. Baja la resolución y luego la recupera
+static void test_step() {
+    sim_t s(0);
+    s.run(kLan, 20000, false);
+    CHECK(s.st.uplink_shift == 0);
+    s.run(kSlow, 40000, true);
+    print("escalón: lento", s);
+    CHECK(s.st.uplink_shift >= 1);
+    s.run(kLan, 90000, false);
+    s.run(kLan, 10000, true);
+    print("escalón: recuperado", s);
+    CHECK(s.st.uplink_shift == 0);
+    CHECK(s.res.age_ms < 120);
+}
+
+// uplink_shift de configuración: el lazo nunca afina por debajo
+static void test_floor() {
+    sim_t s(1);
+    s.run(kLan, 60000, true);
+    print("LAN, suelo 1", s);
+    CHECK(s.st.uplink_shift == 1);
+}
+
+// Sin detecciones (det_ms = 0) la base no cambia ni se detecta cola
+static void test_no_detections() {
+    rate_ctrl_state_t st = {};
+    st.interval_ms = RC_INTERVAL_INIT_MS;
+    st.target_bytes = RC_BYTES_MIN;
+    st.det_base_ms = 80;
+    rate_ctrl_input_t in = { 1000, 0, 0, 0 };
+    rate_ctrl_step(&in, &st);
+    CHECK(st.det_base_ms == 80 && st.queued == 0 && st.probes == 1);
+}
+
+// Ventana llena sin descartes ni cola: frena como backlog; con hueco en la ventana acelera
+static void test_window_full() {
+    for (uint32_t window = 1; window <= 4; window++) {
+        rate_ctrl_state_t st = {};
+        st.interval_ms = RC_INTERVAL_INIT_MS;
+        st.target_bytes = RC_BYTES_MAX;
+        rate_ctrl_input_t in = { 1000, 0, window, window, 0 };
+        rate_ctrl_step(&in, &st);
+        CHECK(st.backoffs == 1 && st.probes == 0 && st.queued == 0);
+        CHECK(st.interval_ms == RC_INTERVAL_INIT_MS + RC_INTERVAL_INIT_MS / 4 + 1);
+        CHECK(st.target_bytes < RC_BYTES_MAX);
+
+        in.inflight = window - 1;
+        uint32_t interval = st.interval_ms;
+        rate_ctrl_step(&in, &st);
+        CHECK(st.backoffs == 1 && st.probes == 1 && st.interval_ms < interval);
+    }
+
+    // Sin ventana (0): inflight solo no frena
+    rate_ctrl_state_t st = {};
+    st.interval_ms = RC_INTERVAL_INIT_MS;
+    st.target_bytes = RC_BYTES_MIN;
+    rate_ctrl_input_t in = { 1000, 0, 5, 0, 0 };
+    rate_ctrl_step(&in, &st);
+    CHECK(st.backoffs == 0 && st.probes == 1);
+}
+
+int main() {
+    test_lan();
+    test_slow_link();
+    test_slow_server();
+    test_step();
+    test_floor();
+    test_no_detections();
+    test_window_full();
+    return host_test_result();
+}
@@ -0,0 +1,193 @@
+// roi_uplink_extract: a shift 0 la vista (o un recorte) apunta a las filas del
+// propio fb, sin pasar por el staging; roi_uplink_pack la compacta igual que la
+// copia de antes; reducida sigue yendo al staging con filas contiguas. Con
+// uplink_shift 1 las respuestas a los recortes (en la vista) y a la imagen
+// normal (en la imagen enviada) se escalan cada una desde su espacio.
+#include "roi_uplink.h"
+#include "ws_draw.h"
+#include "frame_views.h"
+#include "pixel_kernels.h"
+#include "det_parse.h"
+#include "det_merge.h"
+#include "latency_stats.h"
+#include "uplink_window.h"
+#include "app_config.h"
+#include "host.h"
+#include "scenes.h"
+#include <ArduinoJson.h>
+#include <vector>
+
+// ============ Sustitutos de ws_draw / app_config ============
+// Cajas del panel que lee el plan ROI (ninguna: modo normal) y las publicadas
+static Deteccion gPanel[WS_DRAW_MAX_DET];
+static int gPanelCount = 0;
+static Deteccion gPublished[WS_DRAW_MAX_DET];
+static int gPublishedCount = -1;
+
+int ws_draw_get_detecciones(Deteccion* out) {
+    memcpy(out, gPanel, sizeof(Deteccion) * gPanelCount);
+    return gPanelCount;
+}
+
+void ws_draw_update_detecciones_at(Deteccion* detecciones, int count, int64_t) {
+    gPublishedCount = count;
+    if (count > 0) memcpy(gPublished, detecciones, sizeof(Deteccion) * count);
+}
+
+void deteccion_set_label(Deteccion &d, const char* label) {
+    if (!label) label = "";
+    strncpy(d.label, label, DET_LABEL_LEN - 1);
+    d.label[DET_LABEL_LEN - 1] = '\0';
+}
+
+bool app_config_command(JsonObjectConst) { return false; }
+
+static camera_fb_t make_fb(std::vector<uint8_t> &buf, int w, int h) {
+    camera_fb_t fb = {};
+    fb.buf = buf.data();
+    fb.len = buf.size();
+    fb.width = w;
+    fb.height = h;
+    fb.format = PIXFORMAT_RGB565;
+    return fb;
+}
+
+// Recorte de referencia: copia fila a fila de la vista
+static std::vector<uint8_t> crop(const camera_fb_t &fb, int x, int y, int side) {
+    std::vector<uint8_t> out((size_t)side * side * 2);
+    for (int r = 0; r < side; r++) {
+        memcpy(out.data() + (size_t)r * side * 2, fb.buf + ((size_t)(y + r) * fb.width + x) * 2, side * 2);
+    }
+    return out;
+}
+
+static void check_size(int w, int h) {
+    std::vector<uint8_t> px((size_t)w * h * 2);
+    scene_render(px.data(), w, h, SCENE_DESK, 1);
+    camera_fb_t fb = make_fb(px, w, h);
+    frame_views_set_capture(w, h);
+    frame_views_set_uplink_shift(0);
+    CHECK(roi_uplink_init());
+
+    frame_view_t v;
+    frame_views_get(&v);
+    roi_msg_t plan[ROI_MAX_MSGS];
+    CHECK(roi_uplink_plan(&fb, plan, ROI_MAX_MSGS) == 1 && !plan[0].roi && plan[0].shift == 0);
+
+    // shift 0: dentro del fb, sin copia
+    camera_fb_t view;
+    uint16_t stride = 0;
+    CHECK(roi_uplink_extract(&fb, plan[0], &view, &stride));
+    const uint8_t* expect = fb.buf + ((size_t)v.y * w + v.x) * 2;
+    CHECK(view.buf == expect);
+    CHECK(view.width == v.side && view.height == v.side && stride == w);
+    CHECK(view.len == (size_t)v.side * v.side * 2);
+
+    // Compactada: igual que la copia de la vista
+    std::vector<uint8_t> ref = crop(fb, v.x, v.y, v.side);
+    camera_fb_t packed = view;
+    CHECK(roi_uplink_pack(&packed, stride));
+    CHECK(memcmp(packed.buf, ref.data(), ref.size()) == 0);
+    CHECK((packed.buf == view.buf) == (v.side == w));       // contigua: sin copia
+
+    // shift 1: al staging, filas contiguas, igual que px_downscale de la vista
+    frame_views_set_uplink_shift(1);
+    CHECK(roi_uplink_plan(&fb, plan, ROI_MAX_MSGS) == 1 && plan[0].shift == 1);
+    CHECK(roi_uplink_extract(&fb, plan[0], &view, &stride));
+    CHECK(view.buf < fb.buf || view.buf >= fb.buf + fb.len);
+    CHECK(stride == view.width && view.width == v.side / 2);
+    std::vector<uint8_t> down((size_t)(v.side / 2) * (v.side / 2) * 2);
+    px_downscale_ref(expect, w, v.side / 2, v.side / 2, 2, down.data());
+    CHECK(memcmp(view.buf, down.data(), down.size()) == 0);
+    frame_views_set_uplink_shift(0);
+
+    printf("%4dx%-4d vista %3u en (%u,%u): shift 0 %s\n", w, h, v.side, v.x, v.y,
+           v.side == w ? "sin copia" : "sin copia en crudo; JPEG compacta la vista");
+}
+
+// ============ Espacio de las respuestas ============
+static Deteccion panel_box(int x, int y, int w, int h) {
+    Deteccion d = {};
+    deteccion_set_label(d, "obj");
+    d.x = x; d.y = y; d.w = w; d.h = h;
+    return d;
+}
+
+// Respuesta JSON del servidor a un mensaje del frame seq, una caja en píxeles del espacio
+static bool reply(uint32_t seq, int x, int y, int w, int h) {
+    char buf[160];
+    int n = snprintf(buf, sizeof(buf), "{\"frame_id\":%u,\"detections\":[{\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d,\"class\":\"obj\"}]}",
+                     (unsigned)seq, x, y, w, h);
+    return det_parse_json((const uint8_t*)buf, n);
+}
+
+static bool published(int x, int y, int w, int h) {
+    for (int i = 0; i < gPublishedCount; i++) {
+        const Deteccion &d = gPublished[i];
+        if (d.x == x && d.y == y && d.w == w && d.h == h) return true;
+    }
+    return false;
+}
+
+static void check_reply_space() {
+    const int w = 640, h = 480;
+    std::vector<uint8_t> px((size_t)w * h * 2);
+    scene_render(px.data(), w, h, SCENE_DESK, 1);
+    camera_fb_t fb = make_fb(px, w, h);
+    frame_views_set_capture(w, h);
+    frame_views_set_uplink_shift(1);            // imagen normal a 240, vista de 480
+    CHECK(roi_uplink_init());
+    frame_view_t v;
+    frame_views_get(&v);
+    const int scale = v.side / WS_DRAW_W;       // vista -> panel
+
+    // Modo normal: la respuesta viene en píxeles de la imagen enviada (lado / 2)
+    roi_msg_t plan[ROI_MAX_MSGS];
+    int n = roi_uplink_plan(&fb, plan, ROI_MAX_MSGS);
+    CHECK(n == 1 && !plan[0].roi && plan[0].reply_side == v.side / 2);
+    det_merge_on_send(1, n, plan[0].reply_side);
+    CHECK(reply(1, 60, 60, 40, 40));
+    CHECK(gPublishedCount == 1 && published(60 * WS_DRAW_W / (v.side / 2), 60 * WS_DRAW_W / (v.side / 2),
+                                            40 * WS_DRAW_W / (v.side / 2), 40 * WS_DRAW_W / (v.side / 2)));
+
+    // ROI: dos recortes del mismo frame, respondidos en coordenadas de la vista
+    roi_uplink_set_enabled(true);
+    gPanel[0] = panel_box(16, 16, 32, 32);
+    gPanel[1] = panel_box(160, 150, 48, 48);
+    gPanelCount = 2;
+    n = roi_uplink_plan(&fb, plan, ROI_MAX_MSGS);
+    CHECK(n == 2);
+    for (int i = 0; i < n; i++) {
+        CHECK(plan[i].roi && plan[i].reply_side == v.side && plan[i].rect.side == v.side);
+        CHECK(plan[i].rect.part == i && plan[i].rect.parts == n);
+    }
+    det_merge_on_send(2, n, plan[0].reply_side);
+    gPublishedCount = -1;
+    for (int i = 0; i < n; i++) {
+        const uplink_roi_t &r = plan[i].rect;   // caja en el centro del recorte
+        bool last = i == n - 1;
+        CHECK(reply(2, r.x + r.w / 4, r.y + r.h / 4, r.w / 2, r.h / 2) == last);
+        CHECK((gPublishedCount == n) == last);
+    }
+    for (int i = 0; i < n; i++) {
+        const uplink_roi_t &r = plan[i].rect;
+        CHECK(published((r.x + r.w / 4) / scale, (r.y + r.h / 4) / scale, r.w / 2 / scale, r.h / 2 / scale));
+    }
+    printf("vista %u, uplink %u: respuestas ROI escaladas desde la vista\n", v.side, v.side / 2);
+
+    roi_uplink_set_enabled(false);
+    gPanelCount = 0;
+    frame_views_set_uplink_shift(0);
+}
+
+int main() {
+    latency_init();
+    det_merge_init();
+    uplink_window_init(UPLINK_WINDOW_DEFAULT);
+    check_size(240, 240);       // vista = frame
+    check_size(480, 640);       // vista a todo lo ancho: filas contiguas
+    check_size(640, 480);       // VGA: vista 480 centrada
+    check_size(800, 600);
+    check_reply_space();
+    return host_test_result();
+}
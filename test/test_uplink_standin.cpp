@@ -0,0 +1,335 @@
+// uplink_queue + uplink_window contra tools/standin_server (Linux): la cámara
+// encola a 30 fps, la red envía por WebSocket y confirma con el frame_id de las
+// detecciones. Con la ventana llena el frame en cola se sustituye sin contar como
+// descarte ni frenar rate_ctrl; la edad de las confirmaciones no crece (el
+// servidor no acumula cola). Descarte real: la red no saca con la ventana abierta.
+#include "uplink_queue.h"
+#include "uplink_window.h"
+#include "uplink_proto.h"
+#include "host.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// rate_ctrl: solo cuenta lo que le llega como descarte
+static std::atomic<uint32_t> gRcDrops{0};
+void rate_ctrl_on_drop() { gRcDrops++; }
+
+// ============ Driver simulado ============
+#define FB_COUNT 3
+#define FB_SIDE  32                         // vista cuadrada RGB565 pequeña
+static camera_fb_t gFb[FB_COUNT];
+static uint8_t gFbBuf[FB_COUNT][FB_SIDE * FB_SIDE * 2];
+static std::atomic<bool> gFbUsed[FB_COUNT];
+
+static camera_fb_t* fb_get(void) {
+    for (int i = 0; i < FB_COUNT; i++) {
+        bool expected = false;
+        if (gFbUsed[i].compare_exchange_strong(expected, true)) return &gFb[i];
+    }
+    return nullptr;
+}
+static void fb_ret(camera_fb_t* fb) { gFbUsed[fb - gFb] = false; }
+
+static void fb_setup() {
+    static const frame_source_t source = { fb_get, fb_ret };
+    for (int i = 0; i < FB_COUNT; i++) {
+        gFb[i] = {};
+        gFb[i].buf = gFbBuf[i];
+        gFb[i].len = sizeof(gFbBuf[i]);
+        gFb[i].width = gFb[i].height = FB_SIDE;
+        gFb[i].format = PIXFORMAT_RGB565;
+    }
+    frame_pool_init(&source);
+}
+
+// Como loopTask_camera: encola y suelta su referencia
+static void capture_one() {
+    frame_lease_t* lease = frame_pool_acquire();
+    if (!lease) return;
+    uplink_queue_push(lease);
+    frame_lease_release(lease);
+}
+
+// ============ Sin servidor ============
+// Ventana abierta y la red sin sacar: cada frame desplazado es un descarte real
+static void test_real_drop() {
+    fb_setup();
+    uplink_queue_init();
+    uplink_window_init(UPLINK_WINDOW_MAX);
+    uplink_queue_flush(0);
+    uplink_queue_pop(millis(), 0);          // la red ve la ventana abierta
+
+    uplink_queue_stats_t before, st;
+    uplink_queue_get_stats(&before);
+    uint32_t rc = gRcDrops;
+    for (int i = 0; i < 5; i++) capture_one();
+    uplink_queue_get_stats(&st);
+    CHECK(st.dropped - before.dropped == 4);
+    CHECK(st.replaced == before.replaced);
+    CHECK(gRcDrops - rc == 4);
+
+    uplink_queue_flush(0);
+    frame_pool_stats_t ps;
+    frame_pool_get_stats(&ps);
+    CHECK(ps.outstanding == 0);
+}
+
+// Ventana llena: la red no saca; la cámara sustituye el frame en cola
+static void test_window_full() {
+    fb_setup();
+    uplink_window_init(1);
+    uplink_window_on_send(100, millis());
+    CHECK(uplink_queue_pop(millis(), 0) == nullptr);
+
+    uplink_queue_stats_t before, st;
+    uplink_queue_get_stats(&before);
+    uint32_t rc = gRcDrops;
+    for (int i = 0; i < 5; i++) capture_one();
+    uplink_queue_get_stats(&st);
+    CHECK(st.replaced - before.replaced == 4);
+    CHECK(st.dropped == before.dropped);
+    CHECK(gRcDrops == rc);
+
+    // Confirmación: sale el más nuevo
+    uplink_window_on_ack(100, millis());
+    frame_lease_t* lease = uplink_queue_pop(millis(), 0);
+    CHECK(lease && lease->seq == 5);
+    frame_lease_release(lease);
+}
+
+// Cambio de cámara: el frame que espera a la ventana se suelta sin esperar al ack
+static void test_hold() {
+    fb_setup();
+    uplink_window_init(1);
+    uplink_window_on_send(200, millis());
+    CHECK(uplink_queue_pop(millis(), 0) == nullptr);
+    capture_one();
+    frame_pool_stats_t ps;
+    frame_pool_get_stats(&ps);
+    CHECK(ps.outstanding == 1);
+
+    uplink_queue_hold(true);
+    frame_pool_get_stats(&ps);
+    CHECK(ps.outstanding == 0);
+    uplink_window_on_ack(200, millis());
+    capture_one();                          // sin encolar
+    CHECK(uplink_queue_waiting() == 0);
+    CHECK(uplink_queue_pop(millis(), 0) == nullptr);
+    frame_pool_get_stats(&ps);
+    CHECK(ps.outstanding == 0);
+
+    uplink_queue_hold(false);
+    capture_one();
+    frame_lease_t* lease = uplink_queue_pop(millis(), 0);
+    CHECK(lease != nullptr);
+    frame_lease_release(lease);
+}
+
+// ============ Servidor sustituto ============
+static int free_port() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, (sockaddr*)&a, sizeof(a));
+    socklen_t len = sizeof(a);
+    getsockname(fd, (sockaddr*)&a, &len);
+    close(fd);
+    return ntohs(a.sin_port);
+}
+
+static pid_t start_server(int port, int latencyMs) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (!getenv("CAMARA_LOG")) freopen("/dev/null", "w", stdout);
+        char p[16], l[16];
+        snprintf(p, sizeof(p), "%d", port);
+        snprintf(l, sizeof(l), "%d", latencyMs);
+        execl(STANDIN_SERVER, STANDIN_SERVER, "--port", p, "--latency", l, "--mode", "serial",
+              "--format", "detections", "--report", "0", (char*)nullptr);
+        _exit(127);
+    }
+    return pid;
+}
+
+static int connect_server(int port) {
+    for (int i = 0; i < 100; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        a.sin_port = htons((uint16_t)port);
+        if (connect(fd, (sockaddr*)&a, sizeof(a)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        close(fd);
+        delay(30);
+    }
+    return -1;
+}
+
+// ============ Cliente WebSocket mínimo ============
+static bool send_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool ws_connect(int fd) {
+    const char* req = "GET /ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (!send_all(fd, req, strlen(req))) return false;
+    std::string resp;
+    char c;
+    while (resp.find("\r\n\r\n") == std::string::npos) {
+        if (recv(fd, &c, 1, 0) != 1) return false;
+        resp += c;
+    }
+    return resp.find(" 101 ") != std::string::npos;
+}
+
+// Trama binaria del cliente (enmascarada, como arduinoWebSockets)
+static bool ws_send_bin(int fd, const uint8_t* data, size_t len) {
+    std::vector<uint8_t> m;
+    m.push_back(0x82);
+    if (len < 126) m.push_back(0x80 | (uint8_t)len);
+    else { m.push_back(0x80 | 126); m.push_back((uint8_t)(len >> 8)); m.push_back((uint8_t)len); }
+    const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    m.insert(m.end(), mask, mask + 4);
+    for (size_t i = 0; i < len; i++) m.push_back(data[i] ^ mask[i & 3]);
+    return send_all(fd, m.data(), m.size());
+}
+
+// Tramas de texto completas recibidas (el servidor no enmascara ni fragmenta)
+static void ws_poll_text(int fd, std::vector<uint8_t> &rx, std::vector<std::string> &out) {
+    uint8_t buf[4096];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n <= 0) break;
+        rx.insert(rx.end(), buf, buf + n);
+    }
+    for (;;) {
+        if (rx.size() < 2) return;
+        size_t len = rx[1] & 0x7F, pos = 2;
+        if (len == 126) {
+            if (rx.size() < 4) return;
+            len = (size_t)rx[2] << 8 | rx[3];
+            pos = 4;
+        }
+        if (rx.size() < pos + len) return;
+        if ((rx[0] & 0x0F) == 0x1) out.emplace_back(rx.begin() + pos, rx.begin() + pos + len);
+        rx.erase(rx.begin(), rx.begin() + pos + len);
+    }
+}
+
+// Cámara a 30 fps y red con ventana `window` contra un servidor serie de `latencyMs`
+static void test_standin(int window, int latencyMs, double seconds) {
+    int port = free_port();
+    pid_t pid = start_server(port, latencyMs);
+    int fd = connect_server(port);
+    CHECK(fd >= 0);
+    if (fd < 0) { kill(pid, SIGTERM); waitpid(pid, nullptr, 0); return; }
+    CHECK(ws_connect(fd));
+
+    fb_setup();
+    uplink_window_init((uint8_t)window);
+    uplink_queue_flush(0);
+    uplink_queue_stats_t q0, q;
+    uplink_queue_get_stats(&q0);
+    uint32_t rc0 = gRcDrops;
+
+    std::atomic<bool> stop{false};
+    std::thread camera([&] {
+        while (!stop) {
+            capture_one();
+            delay(33);
+        }
+    });
+
+    std::vector<uint8_t> rx, msg(UPLINK_HEADER_LEN + FB_SIDE * FB_SIDE * 2);
+    std::vector<std::string> texts;
+    uint32_t sent = 0, replies = 0, maxInFlight = 0;
+    uint32_t end = millis() + (uint32_t)(seconds * 1000);
+    while ((int32_t)(millis() - end) < 0) {
+        ws_poll_text(fd, rx, texts);
+        for (const std::string &t : texts) {
+            size_t k = t.find("\"frame_id\":");
+            if (k == std::string::npos) continue;
+            uplink_window_on_ack((uint32_t)strtoul(t.c_str() + k + 11, nullptr, 10), millis());
+            replies++;
+        }
+        texts.clear();
+
+        frame_lease_t* lease = uplink_queue_pop(millis(), 5);
+        if (!lease) continue;
+        uplink_header_t hdr = { 0, lease->seq, (uint64_t)esp_timer_get_time() };
+        uplink_header_write(msg.data(), hdr);
+        memcpy(msg.data() + UPLINK_HEADER_LEN, lease->fb->buf, lease->fb->len);
+        frame_lease_release(lease);
+        CHECK(ws_send_bin(fd, msg.data(), msg.size()));
+        uplink_window_on_send(hdr.seq, millis());
+        sent++;
+        uplink_window_stats_t w;
+        uplink_window_get_stats(&w);
+        maxInFlight = std::max<uint32_t>(maxInFlight, w.in_flight);
+    }
+    stop = true;
+    camera.join();
+    close(fd);
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+
+    uplink_queue_flush(0);
+    uplink_queue_get_stats(&q);
+    uplink_window_stats_t w;
+    uplink_window_get_stats(&w);
+    printf("ventana %d, servidor %d ms: %u encolados, %u enviados, %u respuestas, sustituidos %u, "
+           "descartes %u, ack %u ms (max %u)\n", window, latencyMs, (unsigned)(q.queued - q0.queued),
+           (unsigned)sent, (unsigned)replies, (unsigned)(q.replaced - q0.replaced),
+           (unsigned)(q.dropped - q0.dropped), (unsigned)w.last_ack_ms, (unsigned)w.max_ack_ms);
+
+    // Ventana llena casi siempre (30 fps frente a window / latencia): sustitución, no descarte
+    CHECK(sent > 3 && replies + window >= sent);
+    CHECK(maxInFlight <= (uint32_t)window);
+    CHECK(q.replaced - q0.replaced > sent);
+    CHECK(q.dropped == q0.dropped);
+    CHECK(gRcDrops == rc0);
+    // Sin cola en el servidor: cada confirmación tarda como mucho `window` inferencias
+    CHECK(w.max_ack_ms < (uint32_t)(window * latencyMs + 150));
+    CHECK(w.timeouts == 0);
+
+    frame_pool_stats_t ps;
+    frame_pool_get_stats(&ps);
+    CHECK(ps.outstanding == 0);
+}
+
+int main() {
+    signal(SIGPIPE, SIG_IGN);
+    test_real_drop();
+    test_window_full();
+    test_hold();
+    double seconds = host_env_seconds("CAMARA_SOAK_S", 1.5);
+    test_standin(1, 150, seconds);
+    test_standin(2, 150, seconds);
+    return host_test_result();
+}
@@ -0,0 +1,658 @@
+// Servidor de inferencia sustituto para pruebas extremo a extremo sin ngrok.
+// Acepta el uplink del ESP32 (uplink_proto.h) por WebSocket y responde con
+// detecciones sintéticas en cualquiera de los formatos que entiende
+// webSocketEvent (det_parse.cpp / det_proto.h), con latencia, jitter, número
+// de cajas y tamaño de mensaje configurables. Registra tiempos por frame.
+//
+// Un solo fichero, Linux/POSIX, sin dependencias:
+//   g++ -std=c++17 -O2 -o standin_server tools/standin_server.cpp
+//   ./standin_server --port 8080 --latency 150 --jitter 30 --format binary --csv frames.csv
+// En el ESP32: {"cmd":"config","ssl":false,"host":"<IP del PC>","port":8080,"path":"/ws"}
+// (o APP_CFG_HOST/APP_CFG_PORT en app_config.h) y TCP plano.
+//
+// Modelo de inferencia: --mode serial (por defecto) procesa en orden, un frame
+// tras otro, como una GPU ocupada: si llega más rápido de lo que procesa, se
+// acumula cola y la edad de las detecciones crece (así se ve el efecto de la
+// ventana de uplink_window.h). --mode parallel responde cada frame a su latencia.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// ============ Protocolo del ESP32 (copias de uplink_proto.h / det_proto.h) ============
+#define UPLINK_HEADER_LEN   16
+#define UPLINK_ROI_LEN      16          // región, tamaño de salida, parte/partes, lado de la vista
+#define UPLINK_FLAG_JPEG    0x01
+#define UPLINK_FLAG_ROI     0x02
+#define DET_PROTO_HEADER_LEN 12
+#define DET_PROTO_BOX_LEN    10
+
+enum format_t { FMT_FACES, FMT_DETECTIONS, FMT_SINGLE, FMT_ARRAY, FMT_NORM, FMT_BINARY, FMT_CYCLE, FMT_COUNT };
+static const char* const kFormatNames[FMT_COUNT] = {
+    "faces", "detections", "single", "array", "norm", "binary", "cycle",
+};
+
+struct options_t {
+    int port = 8080;
+    format_t format = FMT_DETECTIONS;
+    int latency_ms = 100;
+    int jitter_ms = 0;
+    int boxes = 1;
+    int pad = 0;                // bytes de relleno por respuesta
+    bool serial = true;
+    bool ack = false;           // {"ack":id} al recibir, antes de la "inferencia"
+    bool frame_id = true;       // false: servidor antiguo sin eco de frame_id
+    int drop_pct = 0;           // frames sin respuesta
+    int report_s = 5;
+    int kick_s = 0;             // cierra la conexión cada N s (mide reconexión)
+    const char* csv = nullptr;
+    std::vector<std::string> cmds;   // texto a enviar nada más conectar
+    unsigned seed = 1;
+};
+
+// ============ Tiempo ============
+static double now_ms() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ============ SHA-1 y base64 (handshake RFC 6455) ============
+static uint32_t rol(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+static void sha1(const uint8_t* data, size_t len, uint8_t out[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    std::vector<uint8_t> m(data, data + len);
+    m.push_back(0x80);
+    while (m.size() % 64 != 56) m.push_back(0);
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 7; i >= 0; i--) m.push_back((uint8_t)(bits >> (8 * i)));
+
+    for (size_t off = 0; off < m.size(); off += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &m[off + 4 * i];
+            w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rol(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        out[4 * i]     = (uint8_t)(h[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(h[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(h[i] >> 8);
+        out[4 * i + 3] = (uint8_t)h[i];
+    }
+}
+
+static std::string base64(const uint8_t* p, size_t len) {
+    static const char* kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string s;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)p[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)p[i + 1] << 8;
+        if (i + 2 < len) v |= p[i + 2];
+        s += kAlphabet[(v >> 18) & 63];
+        s += kAlphabet[(v >> 12) & 63];
+        s += i + 1 < len ? kAlphabet[(v >> 6) & 63] : '=';
+        s += i + 2 < len ? kAlphabet[v & 63] : '=';
+    }
+    return s;
+}
+
+static std::string ws_accept(const std::string& key) {
+    std::string in = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    sha1((const uint8_t*)in.data(), in.size(), digest);
+    return base64(digest, sizeof(digest));
+}
+
+// ============ Socket ============
+static bool send_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Trama del servidor: sin máscara, FIN, un solo fragmento
+static bool ws_send(int fd, uint8_t opcode, const void* data, size_t len) {
+    uint8_t hdr[10];
+    size_t n = 0;
+    hdr[n++] = 0x80 | opcode;
+    if (len < 126) {
+        hdr[n++] = (uint8_t)len;
+    } else if (len < 65536) {
+        hdr[n++] = 126;
+        hdr[n++] = (uint8_t)(len >> 8);
+        hdr[n++] = (uint8_t)len;
+    } else {
+        hdr[n++] = 127;
+        for (int i = 7; i >= 0; i--) hdr[n++] = (uint8_t)((uint64_t)len >> (8 * i));
+    }
+    return send_all(fd, hdr, n) && (len == 0 || send_all(fd, data, len));
+}
+
+static bool ws_send_text(int fd, const std::string& s) { return ws_send(fd, 0x1, s.data(), s.size()); }
+
+// Lee la petición HTTP de upgrade y contesta 101. Devuelve false si no es WebSocket.
+static bool ws_handshake(int fd, std::vector<uint8_t>& rx, bool* detProto) {
+    std::string req;
+    char buf[1024];
+    size_t end;
+    while ((end = req.find("\r\n\r\n")) == std::string::npos) {
+        if (req.size() > 16384) return false;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        req.append(buf, (size_t)n);
+    }
+    // Lo que venga tras la cabecera ya son tramas
+    rx.assign(req.begin() + end + 4, req.end());
+    req.resize(end + 2);
+
+    std::string key, lower = req;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    size_t k = lower.find("sec-websocket-key:");
+    if (k == std::string::npos) return false;
+    k += strlen("sec-websocket-key:");
+    size_t e = req.find("\r\n", k);
+    key = req.substr(k, e - k);
+    key.erase(0, key.find_first_not_of(" \t"));
+    key.erase(key.find_last_not_of(" \t") + 1);
+    *detProto = lower.find("x-det-proto: 1") != std::string::npos;
+
+    std::string resp = "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: " + ws_accept(key) + "\r\n\r\n";
+    return send_all(fd, resp.data(), resp.size());
+}
+
+// Extrae una trama completa de rx (las del cliente van enmascaradas).
+// 1 = trama en opcode/payload, 0 = faltan bytes, -1 = trama inválida.
+static int ws_parse(std::vector<uint8_t>& rx, uint8_t* opcode, bool* fin, std::vector<uint8_t>& payload) {
+    if (rx.size() < 2) return 0;
+    *fin = rx[0] & 0x80;
+    *opcode = rx[0] & 0x0F;
+    bool masked = rx[1] & 0x80;
+    uint64_t len = rx[1] & 0x7F;
+    size_t pos = 2;
+    if (len == 126) {
+        if (rx.size() < 4) return 0;
+        len = (uint64_t)rx[2] << 8 | rx[3];
+        pos = 4;
+    } else if (len == 127) {
+        if (rx.size() < 10) return 0;
+        len = 0;
+        for (int i = 0; i < 8; i++) len = len << 8 | rx[2 + i];
+        pos = 10;
+    }
+    if (len > (64u << 20)) return -1;
+    uint8_t mask[4] = { 0, 0, 0, 0 };
+    if (masked) {
+        if (rx.size() < pos + 4) return 0;
+        memcpy(mask, &rx[pos], 4);
+        pos += 4;
+    }
+    if (rx.size() < pos + len) return 0;
+    payload.assign(rx.begin() + pos, rx.begin() + pos + len);
+    for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i & 3];
+    rx.erase(rx.begin(), rx.begin() + pos + len);
+    return 1;
+}
+
+// ============ Frames recibidos ============
+struct frame_t {
+    uint32_t seq = 0;
+    uint8_t flags = 0;
+    size_t bytes = 0;
+    int w = 0, h = 0;           // imagen del payload
+    int roi_x = 0, roi_y = 0, roi_w = 0, roi_h = 0;
+    int view_side = 0;          // espacio de las respuestas a recortes ROI
+    uint64_t capture_us = 0;    // reloj del ESP32
+    double recv_ms = 0;
+    double ready_ms = 0;        // fin de la "inferencia"
+    bool drop = false;
+};
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+
+// Dimensiones de un JPEG (SOF0/SOF2)
+static bool jpeg_size(const uint8_t* p, size_t len, int* w, int* h) {
+    size_t i = 2;
+    while (i + 9 < len) {
+        if (p[i] != 0xFF) { i++; continue; }
+        uint8_t marker = p[i + 1];
+        if (marker == 0xC0 || marker == 0xC2) {
+            *h = p[i + 5] << 8 | p[i + 6];
+            *w = p[i + 7] << 8 | p[i + 8];
+            return true;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { i += 2; continue; }
+        i += 2 + (p[i + 2] << 8 | p[i + 3]);
+    }
+    return false;
+}
+
+static bool parse_frame(const std::vector<uint8_t>& m, frame_t* f) {
+    if (m.size() < UPLINK_HEADER_LEN || m[0] != 'F' || m[1] != 'R') return false;
+    f->flags = m[3];
+    f->seq = (uint32_t)m[4] | (uint32_t)m[5] << 8 | (uint32_t)m[6] << 16 | (uint32_t)m[7] << 24;
+    f->capture_us = 0;
+    for (int i = 7; i >= 0; i--) f->capture_us = f->capture_us << 8 | m[8 + i];
+    f->bytes = m.size();
+
+    size_t off = UPLINK_HEADER_LEN;
+    if (f->flags & UPLINK_FLAG_ROI) {
+        if (m.size() < off + UPLINK_ROI_LEN) return false;
+        const uint8_t* r = &m[off];
+        f->roi_x = rd16(r); f->roi_y = rd16(r + 2); f->roi_w = rd16(r + 4); f->roi_h = rd16(r + 6);
+        f->w = rd16(r + 8); f->h = rd16(r + 10);
+        // r[12], r[13]: parte/partes. Cada mensaje se responde por separado con el mismo
+        // frame_id; el ESP32 junta las respuestas del frame (det_merge.h)
+        f->view_side = rd16(r + 14);
+        off += UPLINK_ROI_LEN;
+    }
+    const uint8_t* img = m.data() + off;
+    size_t imgLen = m.size() - off;
+    if (f->flags & UPLINK_FLAG_JPEG) {
+        jpeg_size(img, imgLen, &f->w, &f->h);
+    } else if (!(f->flags & UPLINK_FLAG_ROI)) {
+        f->w = f->h = (int)std::lround(std::sqrt((double)imgLen / 2));   // vista cuadrada RGB565
+    }
+    return true;
+}
+
+// ============ Respuestas ============
+struct box_t { int x, y, w, h; };
+
+// Cajas que barren la imagen (se ven moverse en el panel y ejercitan el tracker)
+static std::vector<box_t> make_boxes(const frame_t& f, int count, int* srcW, int* srcH) {
+    int sw = f.w > 0 ? f.w : 240, sh = f.h > 0 ? f.h : 240;
+    int ox = 0, oy = 0, rw = sw, rh = sh;
+    if (f.flags & UPLINK_FLAG_ROI) {   // coordenadas de la vista, dentro del recorte
+        ox = f.roi_x; oy = f.roi_y; rw = f.roi_w; rh = f.roi_h;
+        sw = sh = std::max(1, f.view_side);
+    }
+    std::vector<box_t> out;
+    for (int i = 0; i < count; i++) {
+        int bw = std::max(8, rw / 4), bh = std::max(8, rh / 4);
+        int span = std::max(1, rw - bw);
+        int x = (int)((f.seq * 4 + (uint32_t)(i * span / std::max(1, count))) % (uint32_t)span);
+        int y = count > 1 ? i * std::max(0, rh - bh) / (count - 1) : (rh - bh) / 2;
+        out.push_back({ ox + x, oy + y, bw, bh });
+    }
+    *srcW = sw;
+    *srcH = sh;
+    return out;
+}
+
+static std::string pad_field(int pad) {
+    return pad > 0 ? ",\"pad\":\"" + std::string((size_t)pad, 'x') + "\"" : std::string();
+}
+
+static std::string json_box(const box_t& b, const char* labelKey, const char* label) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d,\"%s\":\"%s\",\"score\":0.90}",
+             b.x, b.y, b.w, b.h, labelKey, label);
+    return buf;
+}
+
+static bool send_reply(int fd, const options_t& o, format_t fmt, bool detProto, const frame_t& f, size_t* sentBytes) {
+    int srcW, srcH;
+    std::vector<box_t> boxes = make_boxes(f, o.boxes, &srcW, &srcH);
+    if (fmt == FMT_BINARY && !detProto) fmt = FMT_DETECTIONS;   // cliente sin "X-Det-Proto: 1"
+
+    char id[32] = "";
+    if (o.frame_id) snprintf(id, sizeof(id), "\"frame_id\":%u,", f.seq);
+
+    if (fmt == FMT_BINARY) {
+        int n = std::min<int>((int)boxes.size(), 255);
+        std::vector<uint8_t> m(DET_PROTO_HEADER_LEN + (size_t)n * DET_PROTO_BOX_LEN + (size_t)o.pad, 0);
+        uint32_t fid = o.frame_id ? f.seq : 0;
+        m[0] = 'D'; m[1] = 'T'; m[2] = 1; m[3] = (uint8_t)n;
+        for (int i = 0; i < 4; i++) m[4 + i] = (uint8_t)(fid >> (8 * i));
+        m[8] = (uint8_t)srcW; m[9] = (uint8_t)(srcW >> 8);
+        m[10] = (uint8_t)srcH; m[11] = (uint8_t)(srcH >> 8);
+        for (int i = 0; i < n; i++) {
+            uint8_t* b = &m[DET_PROTO_HEADER_LEN + (size_t)i * DET_PROTO_BOX_LEN];
+            const uint16_t v[4] = { (uint16_t)boxes[i].x, (uint16_t)boxes[i].y, (uint16_t)boxes[i].w, (uint16_t)boxes[i].h };
+            for (int k = 0; k < 4; k++) { b[2 * k] = (uint8_t)v[k]; b[2 * k + 1] = (uint8_t)(v[k] >> 8); }
+            b[8] = (uint8_t)(i % 3);
+            b[9] = 230;
+        }
+        *sentBytes = m.size();
+        return ws_send(fd, 0x2, m.data(), m.size());
+    }
+
+    std::string s;
+    if (fmt == FMT_SINGLE && !boxes.empty()) {
+        std::string b = json_box(boxes[0], "label", "obj");
+        s = "{" + std::string(id) + b.substr(1, b.size() - 2) + pad_field(o.pad) + "}";
+    } else if (fmt == FMT_ARRAY) {
+        s = "[";                         // sin frame_id posible: el ESP32 confirma el más antiguo
+        for (size_t i = 0; i < boxes.size(); i++) s += (i ? "," : "") + json_box(boxes[i], "label", "obj");
+        s += "]";
+    } else if (fmt == FMT_NORM) {
+        s = "{" + std::string(id) + "\"detections\":[";
+        for (size_t i = 0; i < boxes.size(); i++) {
+            char buf[160];
+            snprintf(buf, sizeof(buf), "%s{\"x\":%.4f,\"y\":%.4f,\"w\":%.4f,\"h\":%.4f,\"class\":\"obj\"}",
+                     i ? "," : "", (double)boxes[i].x / srcW, (double)boxes[i].y / srcH,
+                     (double)boxes[i].w / srcW, (double)boxes[i].h / srcH);
+            s += buf;
+        }
+        s += "]" + pad_field(o.pad) + "}";
+    } else {
+        bool faces = fmt == FMT_FACES;
+        s = "{" + std::string(id) + (faces ? "\"faces\":[" : "\"detections\":[");
+        for (size_t i = 0; i < boxes.size(); i++) {
+            s += (i ? "," : "") + json_box(boxes[i], faces ? "label" : "class", faces ? "face" : "obj");
+        }
+        s += "]" + pad_field(o.pad) + "}";
+    }
+    *sentBytes = s.size();
+    return ws_send_text(fd, s);
+}
+
+// ============ Estadísticas ============
+struct stats_t {
+    uint32_t frames = 0, replies = 0, dropped = 0;
+    uint64_t bytes = 0;
+    double server_ms = 0;       // recepción -> respuesta (cola + inferencia)
+    double max_server_ms = 0;
+    size_t max_depth = 0;
+    double t0 = 0;
+};
+
+static void report(stats_t& s, size_t depth) {
+    double dt = (now_ms() - s.t0) / 1000.0;
+    if (dt <= 0) return;
+    printf("[stats] %.1f fps in, %.1f KB/s, %u respuestas, servidor %.0f ms medio / %.0f max, cola %zu (max %zu), sin respuesta %u\n",
+           s.frames / dt, s.bytes / 1024.0 / dt, s.replies,
+           s.replies ? s.server_ms / s.replies : 0.0, s.max_server_ms, depth, s.max_depth, s.dropped);
+    fflush(stdout);
+    s = stats_t();
+    s.t0 = now_ms();
+}
+
+// Texto del ESP32: resúmenes de latencia, perfil de arranque, respuestas de configuración
+static void print_text(const std::vector<uint8_t>& m) {
+    printf("[esp32] %.*s\n", (int)m.size(), (const char*)m.data());
+    fflush(stdout);
+}
+
+// Telemetría binaria (telemetry.h): cabecera y, desde v2, la reconexión
+static void print_telemetry(const std::vector<uint8_t>& m) {
+    if (m.size() < 36) return;
+    auto rd32 = [&](size_t o) { return (uint32_t)m[o] | (uint32_t)m[o + 1] << 8 | (uint32_t)m[o + 2] << 16 | (uint32_t)m[o + 3] << 24; };
+    printf("[telemetria] uptime %u s, heap libre %u (min %u), psram libre %u\n",
+           rd32(6) / 1000, rd32(10), rd32(14), rd32(22));
+    // v2: reconexión (caída -> socket -> primer ack) tras los contadores de frames
+    if (m[2] >= 2 && m.size() >= 66 && rd32(50)) {
+        printf("[telemetria] reconexiones %u: socket %u ms, primer ack %u ms (max %u)\n",
+               rd32(50), rd32(54), rd32(58), rd32(62));
+    }
+    fflush(stdout);
+}
+
+// ============ Sesión ============
+static volatile sig_atomic_t gStop = 0;
+static void on_signal(int) { gStop = 1; }
+
+static void serve(int fd, const options_t& o, std::mt19937& rng, FILE* csv, double* kickedAt) {
+    std::vector<uint8_t> rx;
+    bool detProto = false;
+    if (!ws_handshake(fd, rx, &detProto)) {
+        printf("[ws] handshake inválido\n");
+        return;
+    }
+    double connected = now_ms();
+    if (*kickedAt > 0) {
+        printf("[ws] reconectado en %.0f ms desde el cierre\n", connected - *kickedAt);
+        *kickedAt = 0;
+    }
+    printf("[ws] cliente conectado (det_proto %s, formato %s)\n", detProto ? "sí" : "no", kFormatNames[o.format]);
+    fflush(stdout);
+    for (const std::string& c : o.cmds) ws_send_text(fd, c);
+
+    std::uniform_int_distribution<int> jitter(-o.jitter_ms, o.jitter_ms);
+    std::uniform_int_distribution<int> pct(0, 99);
+    std::deque<frame_t> pending;
+    std::vector<uint8_t> msg, payload;
+    uint8_t msgOpcode = 0;
+    stats_t st;
+    st.t0 = now_ms();
+    double lastReady = 0, lastRecv = 0;
+    int cycle = 0;
+
+    while (!gStop) {
+        double now = now_ms();
+        if (o.kick_s > 0 && now - connected >= o.kick_s * 1000.0) {
+            printf("[ws] cierre forzado (--kick)\n");
+            *kickedAt = now;
+            break;
+        }
+
+        // Respuestas vencidas (en orden de llegada en modo serie)
+        while (!pending.empty()) {
+            auto it = pending.begin();
+            if (!o.serial) it = std::min_element(pending.begin(), pending.end(),
+                                                 [](const frame_t& a, const frame_t& b) { return a.ready_ms < b.ready_ms; });
+            if (it->ready_ms > now) break;
+            frame_t f = *it;
+            pending.erase(it);
+            if (f.drop) { st.dropped++; continue; }
+
+            format_t fmt = o.format == FMT_CYCLE ? (format_t)(cycle++ % FMT_CYCLE) : o.format;
+            size_t sent = 0;
+            if (!send_reply(fd, o, fmt, detProto, f, &sent)) return;
+            double t = now_ms();
+            st.replies++;
+            st.server_ms += t - f.recv_ms;
+            st.max_server_ms = std::max(st.max_server_ms, t - f.recv_ms);
+            if (csv) {
+                fprintf(csv, "%u,%u,%zu,%d,%d,%llu,%.1f,%.1f,%.1f,%s,%zu\n", f.seq, f.flags, f.bytes, f.w, f.h,
+                        (unsigned long long)f.capture_us, f.recv_ms, t, t - f.recv_ms, kFormatNames[fmt], sent);
+            }
+        }
+
+        if (o.report_s > 0 && now - st.t0 >= o.report_s * 1000.0) report(st, pending.size());
+
+        // Espera a datos o a la siguiente respuesta
+        int timeout = 100;
+        if (!pending.empty()) {
+            double next = pending.front().ready_ms;
+            for (const frame_t& f : pending) next = std::min(next, f.ready_ms);
+            timeout = std::max(0, std::min(100, (int)std::ceil(next - now)));
+        }
+        pollfd p = { fd, POLLIN, 0 };
+        int r = poll(&p, 1, timeout);
+        if (r < 0) return;
+        if (r == 0) continue;
+
+        uint8_t buf[65536];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            printf("[ws] cliente desconectado\n");
+            return;
+        }
+        rx.insert(rx.end(), buf, buf + n);
+
+        uint8_t opcode;
+        bool fin;
+        int pr;
+        while ((pr = ws_parse(rx, &opcode, &fin, payload)) == 1) {
+            if (opcode == 0x8) {                                  // close
+                ws_send(fd, 0x8, payload.data(), std::min<size_t>(payload.size(), 2));
+                printf("[ws] cierre del cliente\n");
+                return;
+            }
+            if (opcode == 0x9) { ws_send(fd, 0xA, payload.data(), payload.size()); continue; }   // ping
+            if (opcode == 0xA) continue;                          // pong
+
+            if (opcode != 0x0) { msg.clear(); msgOpcode = opcode; }
+            msg.insert(msg.end(), payload.begin(), payload.end());
+            if (!fin) continue;
+
+            if (msgOpcode == 0x1) { print_text(msg); continue; }
+            if (msg.size() >= 2 && msg[0] == 'T' && msg[1] == 'M') { print_telemetry(msg); continue; }
+
+            frame_t f;
+            if (!parse_frame(msg, &f)) {
+                printf("[ws] binario desconocido (%zu bytes)\n", msg.size());
+                continue;
+            }
+            f.recv_ms = now_ms();
+            double lat = std::max(0, o.latency_ms + (o.jitter_ms ? jitter(rng) : 0));
+            f.ready_ms = o.serial ? std::max(f.recv_ms, lastReady) + lat : f.recv_ms + lat;
+            lastReady = f.ready_ms;
+            f.drop = o.drop_pct > 0 && pct(rng) < o.drop_pct;
+            if (o.ack && o.frame_id) {
+                char a[48];
+                snprintf(a, sizeof(a), "{\"ack\":%u}", f.seq);
+                ws_send_text(fd, a);
+            }
+            st.frames++;
+            st.bytes += f.bytes;
+            if (lastRecv > 0 && f.recv_ms - lastRecv > 2000) {
+                printf("[ws] hueco de %.0f ms sin frames\n", f.recv_ms - lastRecv);
+            }
+            lastRecv = f.recv_ms;
+            pending.push_back(f);
+            st.max_depth = std::max(st.max_depth, pending.size());
+        }
+        if (pr < 0) {
+            printf("[ws] trama inválida\n");
+            return;
+        }
+    }
+}
+
+// ============ main ============
+static void usage(const char* argv0) {
+    printf("uso: %s [opciones]\n"
+           "  --port N          puerto TCP (8080)\n"
+           "  --format F        faces|detections|single|array|norm|binary|cycle (detections)\n"
+           "  --latency MS      tiempo de \"inferencia\" por frame (100)\n"
+           "  --jitter MS       +-MS uniforme sobre la latencia (0)\n"
+           "  --mode M          serial (en orden, una a una) | parallel (serial)\n"
+           "  --boxes N         cajas por respuesta (1; el ESP32 pinta hasta 10)\n"
+           "  --pad BYTES       relleno por respuesta para probar mensajes grandes (0)\n"
+           "  --ack             {\"ack\":id} nada más recibir cada frame\n"
+           "  --no-frame-id     sin eco de frame_id (servidor antiguo)\n"
+           "  --drop PCT        %% de frames sin respuesta (0)\n"
+           "  --cmd JSON        texto a enviar al conectar (repetible), p.ej. '{\"cmd\":\"get\"}'\n"
+           "  --kick S          cierra la conexión cada S segundos (tiempo de reconexión)\n"
+           "  --csv FICHERO     tiempos por frame\n"
+           "  --report S        periodo del resumen (5)\n"
+           "  --seed N          semilla del jitter/drop (1)\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    options_t o;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(argv[0]); exit(2); }
+            return argv[++i];
+        };
+        if (a == "--port") o.port = atoi(next());
+        else if (a == "--format") {
+            const char* f = next();
+            int k = 0;
+            while (k < FMT_COUNT && strcmp(kFormatNames[k], f) != 0) k++;
+            if (k == FMT_COUNT) { usage(argv[0]); return 2; }
+            o.format = (format_t)k;
+        }
+        else if (a == "--latency") o.latency_ms = atoi(next());
+        else if (a == "--jitter") o.jitter_ms = std::abs(atoi(next()));
+        else if (a == "--mode") o.serial = strcmp(next(), "parallel") != 0;
+        else if (a == "--boxes") o.boxes = std::max(0, atoi(next()));
+        else if (a == "--pad") o.pad = std::max(0, atoi(next()));
+        else if (a == "--ack") o.ack = true;
+        else if (a == "--no-frame-id") o.frame_id = false;
+        else if (a == "--drop") o.drop_pct = std::max(0, std::min(100, atoi(next())));
+        else if (a == "--cmd") o.cmds.push_back(next());
+        else if (a == "--kick") o.kick_s = std::max(0, atoi(next()));
+        else if (a == "--csv") o.csv = next();
+        else if (a == "--report") o.report_s = std::max(0, atoi(next()));
+        else if (a == "--seed") o.seed = (unsigned)strtoul(next(), nullptr, 10);
+        else { usage(argv[0]); return a == "--help" || a == "-h" ? 0 : 2; }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int ls = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(ls, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)o.port);
+    if (bind(ls, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(ls, 1) < 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    FILE* csv = nullptr;
+    if (o.csv) {
+        csv = fopen(o.csv, "w");
+        if (!csv) { perror(o.csv); return 1; }
+        fprintf(csv, "seq,flags,bytes,w,h,capture_us,recv_ms,reply_ms,server_ms,format,reply_bytes\n");
+    }
+
+    printf("[standin] escuchando en :%d (latencia %d +-%d ms, %s, %d cajas)\n", o.port, o.latency_ms,
+           o.jitter_ms, o.serial ? "serie" : "paralelo", o.boxes);
+    fflush(stdout);
+
+    std::mt19937 rng(o.seed);
+    double kickedAt = 0;
+    while (!gStop) {
+        pollfd p = { ls, POLLIN, 0 };
+        if (poll(&p, 1, 200) <= 0) continue;
+        sockaddr_in peer = {};
+        socklen_t plen = sizeof(peer);
+        int fd = accept(ls, (sockaddr*)&peer, &plen);
+        if (fd < 0) continue;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        printf("[tcp] conexión de %s\n", inet_ntoa(peer.sin_addr));
+        serve(fd, o, rng, csv, &kickedAt);
+        close(fd);
+        if (csv) fflush(csv);
+    }
+
+    if (csv) fclose(csv);
+    close(ls);
+    return 0;
+}